@@ -0,0 +1,90 @@
+#pragma once
+#ifndef CRC32_H
+#define CRC32_H
+
+#include "Common.h"
+#include <daisy_seed.h>
+
+// CRC-32/MPEG-2 lookup table, built at compile time
+class CRC32Table
+{
+public:
+	static constexpr uint32 POLYNOMIAL = 0x04C11DB7;
+
+public:
+	constexpr CRC32Table(void)
+		: Values()
+	{
+		for (uint16 i = 0; i < 256; ++i)
+		{
+			uint32 value = static_cast<uint32>(i) << 24;
+			for (uint8 j = 0; j < 8; ++j)
+				value = ((value & 0x80000000) != 0 ? (value << 1) ^ POLYNOMIAL : value << 1);
+
+			Values[i] = value;
+		}
+	}
+
+public:
+	uint32 Values[256];
+};
+
+static constexpr CRC32Table CRC32_TABLE;
+
+// CRC-32/MPEG-2 of 32-bit words, most significant byte first, which is what the CRC unit of STM32 computes after reset
+// Runs on the CRC unit when the device header defines it, otherwise on the table, so host builds get the same values
+// The CRC unit is shared, so a calculation must not be interrupted by another one
+class CRC32
+{
+public:
+	static constexpr uint32 INITIAL_VALUE = 0xFFFFFFFF;
+
+public:
+	CRC32(void)
+		: m_Value(INITIAL_VALUE)
+	{
+	}
+
+	static void Initialize(void)
+	{
+#ifdef CRC
+		__HAL_RCC_CRC_CLK_ENABLE();
+
+		CRC->POL = CRC32Table::POLYNOMIAL;
+		CRC->INIT = INITIAL_VALUE;
+#endif
+	}
+
+	void Reset(void)
+	{
+#ifdef CRC
+		CRC->CR = CRC_CR_RESET;
+#else
+		m_Value = INITIAL_VALUE;
+#endif
+	}
+
+	void Add(uint32 Word)
+	{
+#ifdef CRC
+		CRC->DR = Word;
+#else
+		for (int8 shift = 24; shift >= 0; shift -= 8)
+			m_Value = (m_Value << 8) ^ CRC32_TABLE.Values[((m_Value >> 24) ^ (Word >> shift)) & 0xFF];
+#endif
+	}
+
+	uint32 Get(void) const
+	{
+#ifdef CRC
+		return CRC->DR;
+#else
+		return m_Value;
+#endif
+	}
+
+private:
+	uint32 m_Value;
+};
+
+#endif
@@ -107,4 +107,121 @@ public:
 	uint8 Height;
 	const uint16 *const Data;
 	float Scale;
-};
\ No newline at end of file
+};
+
+struct PackedGlyph
+{
+public:
+	// Byte offset of the first row in PackedFont::Bitmap
+	uint16 Offset;
+	uint8 Width;
+	uint8 Height;
+	// Position of the bounding box relative to the pen and the top of the line
+	int8 OffsetX;
+	int8 OffsetY;
+	uint8 Advance;
+};
+
+struct KerningPair
+{
+public:
+	char Left;
+	char Right;
+	int8 Offset;
+};
+
+// Proportional font, every glyph is stored as its bounding box only, with rows packed
+// MSB first and continuous across row boundaries; generated by Tools/BDFToPackedFont.py
+struct PackedFont
+{
+public:
+	uint8 Height;
+	char FirstChar;
+	char LastChar;
+	const PackedGlyph *const Glyphs;
+	const uint8 *const Bitmap;
+	// Sorted by (Left, Right)
+	const KerningPair *const KerningPairs;
+	uint16 KerningPairCount;
+	float Scale;
+};
+
+enum class ImageFormats
+{
+	// Packets of a header byte and R5G6B5 pixels, little endian; the header holds the pixel count minus one in its low 7 bits
+	// and whether the packet is a run of its one pixel in its high bit, otherwise it holds the pixels one by one
+	// Packets continue across row boundaries
+	RLE565 = 0,
+	// The Quite OK Image format, header and end marker included
+	QOI
+};
+
+// Compressed image, decoded while being drawn, so Data can stay in the memory-mapped QSPI flash;
+// generated by Tools/ImageToAsset.py
+struct Image
+{
+public:
+	ImageFormats Format;
+	uint16 Width;
+	uint16 Height;
+	const uint8 *const Data;
+	uint32 Size;
+};
+
+// Image of 1, 2 or 4-bit palette indices, rows start on a byte and are packed MSB first;
+// generated by Tools/ImageToAsset.py
+struct Sprite
+{
+public:
+	static constexpr uint16 NO_TRANSPARENCY = 0xFFFF;
+
+public:
+	uint8 BitsPerPixel;
+	uint16 Width;
+	uint16 Height;
+	// R5G6B5, 1 << BitsPerPixel colors
+	const uint16 *const Palette;
+	// The index which isn't drawn, or NO_TRANSPARENCY
+	uint16 TransparentIndex;
+	const uint8 *const Data;
+};
+
+// What a numeric readout last drew, one per readout on the screen, so LCDCanvas::DrawNumber and DrawFixed
+// only draw the characters which changed
+struct NumericReadout
+{
+public:
+	static constexpr uint8 MAX_LENGTH = 16;
+
+public:
+	NumericReadout(void)
+		: Text(),
+		  Length(0),
+		  X(0),
+		  Y(0),
+		  FontData(nullptr),
+		  FontScale(0),
+		  CellWidth(0),
+		  ForegroundColor(0),
+		  BackgroundColor(0)
+	{
+	}
+
+	// Every character gets drawn on the next draw, i.e. after something else has been drawn over the readout
+	void Invalidate(void)
+	{
+		Length = 0;
+	}
+
+public:
+	char Text[MAX_LENGTH];
+	uint8 Length;
+	int16 X;
+	int16 Y;
+	const uint16 *FontData;
+	float FontScale;
+	uint8 CellWidth;
+	// R5G6B5
+	uint16 ForegroundColor;
+	uint16 BackgroundColor;
+};
@@ -0,0 +1,314 @@
+#pragma once
+#ifndef DMA2D_ACCELERATOR_H
+#define DMA2D_ACCELERATOR_H
+
+#include "Common.h"
+#include "RGB565Kernels.h"
+#include "PixelFormats.h"
+#include <daisy_seed.h>
+
+// Fills, blends and copies of R5G6B5 rectangles, offloaded to the DMA2D (Chrom-ART) unit when they are large enough,
+// the call returns once the unit is started, so the CPU goes on while the pixels are written
+// Only one operation runs at a time, every call waits for the previous one, and so must anything else touching its buffers,
+// by calling Wait
+// Smaller operations, and everything when the device header doesn't define DMA2D, like on host builds, are done by RGB565Kernels,
+// which stay the bit-exact reference; the unit blends with 256 alpha levels, so its blends may differ in the lowest bit of a channel
+// The unit can't read byte swapped pixels, so blends into swapped buffers are always done by the CPU
+class DMA2DAccelerator
+{
+#ifdef DMA2D
+	static constexpr bool IS_AVAILABLE = true;
+
+	static constexpr uint32 MODE_MEMORY_TO_MEMORY = 0;
+	static constexpr uint32 MODE_MEMORY_TO_MEMORY_CONVERTED = DMA2D_CR_MODE_0;
+	static constexpr uint32 MODE_MEMORY_TO_MEMORY_BLENDED = DMA2D_CR_MODE_1;
+	static constexpr uint32 MODE_REGISTER_TO_MEMORY = DMA2D_CR_MODE_0 | DMA2D_CR_MODE_1;
+#ifdef DMA2D_CR_MODE_2
+	static constexpr uint32 MODE_MEMORY_TO_MEMORY_BLENDED_FIXED_FOREGROUND = DMA2D_CR_MODE_2;
+#endif
+
+	static constexpr uint32 COLOR_MODE_RGB565 = 2;
+	static constexpr uint32 COLOR_MODE_A8 = 9;
+
+	static constexpr uint32 ALPHA_MODE_REPLACE = 1;
+	static constexpr uint32 ALPHA_MODE_MULTIPLY = 2;
+#else
+	static constexpr bool IS_AVAILABLE = false;
+#endif
+
+	// Earlier revisions have no blending with a fixed foreground color
+#ifdef DMA2D_CR_MODE_2
+	static constexpr bool CAN_BLEND_FIXED_COLOR = true;
+#else
+	static constexpr bool CAN_BLEND_FIXED_COLOR = false;
+#endif
+
+#ifdef DMA2D_OPFCCR_SB
+	static constexpr bool CAN_SWAP_BYTES = true;
+#else
+	static constexpr bool CAN_SWAP_BYTES = false;
+#endif
+
+public:
+	// In pixels, setting the unit up and waiting for it costs about as much as the CPU spends on that many
+	static constexpr uint32 DEFAULT_HARDWARE_THRESHOLD = 256;
+
+public:
+	DMA2DAccelerator(void)
+		: m_HardwareThreshold(DEFAULT_HARDWARE_THRESHOLD),
+		  m_IsBusy(false),
+		  m_Destination(nullptr),
+		  m_DestinationSize(0),
+		  m_HardwareOperationCount(0),
+		  m_SoftwareOperationCount(0)
+	{
+	}
+
+	void Initialize(void)
+	{
+#ifdef DMA2D
+		__HAL_RCC_DMA2D_CLK_ENABLE();
+#endif
+	}
+
+	void SetHardwareThreshold(uint32 Value)
+	{
+		m_HardwareThreshold = Value;
+	}
+
+	uint32 GetHardwareThreshold(void) const
+	{
+		return m_HardwareThreshold;
+	}
+
+	uint32 GetHardwareOperationCount(void) const
+	{
+		return m_HardwareOperationCount;
+	}
+
+	uint32 GetSoftwareOperationCount(void) const
+	{
+		return m_SoftwareOperationCount;
+	}
+
+	// Value is written as it is, so it must already be in the order of the buffer
+	void Fill(uint16 *Destination, uint16 Stride, uint16 Width, uint16 Height, uint16 Value)
+	{
+		Wait();
+
+		if (IsWorthHardware(Width, Height))
+		{
+			StartFill(Destination, Stride, Width, Height, Value);
+
+			return;
+		}
+
+		++m_SoftwareOperationCount;
+
+		for (uint16 y = 0; y < Height; ++y, Destination += Stride)
+			RGB565Kernels::Fill(Destination, Value, Width);
+	}
+
+	template <bool IsSwapped>
+	void Blend(uint16 *Destination, uint16 Stride, uint16 Width, uint16 Height, uint16 R5G6B5, uint8 Alpha)
+	{
+		if (Alpha == 0)
+			return;
+
+		if (Alpha == 255)
+		{
+			Fill(Destination, Stride, Width, Height, (IsSwapped ? SWAP_ENDIAN_16BIT(R5G6B5) : R5G6B5));
+
+			return;
+		}
+
+		Wait();
+
+		if (!IsSwapped && CAN_BLEND_FIXED_COLOR && IsWorthHardware(Width, Height))
+		{
+			StartBlend(Destination, Stride, Width, Height, R5G6B5, Alpha);
+
+			return;
+		}
+
+		++m_SoftwareOperationCount;
+
+		for (uint16 y = 0; y < Height; ++y, Destination += Stride)
+			RGB565Kernels::Blend<IsSwapped>(Destination, R5G6B5, Alpha, Width);
+	}
+
+	// Alphas holds one alpha per pixel of the rectangle, Alpha scales all of them, like RGB565Kernels::BlendAlphas
+	template <bool IsSwapped>
+	void BlendAlphas(uint16 *Destination, uint16 Stride, const uint8 *Alphas, uint16 AlphaStride, uint16 Width, uint16 Height, uint16 R5G6B5, uint8 Alpha)
+	{
+		Wait();
+
+		if (!IsSwapped && IsWorthHardware(Width, Height))
+		{
+			StartBlendAlphas(Destination, Stride, Alphas, AlphaStride, Width, Height, R5G6B5, Alpha);
+
+			return;
+		}
+
+		++m_SoftwareOperationCount;
+
+		for (uint16 y = 0; y < Height; ++y, Destination += Stride, Alphas += AlphaStride)
+			RGB565Kernels::BlendAlphas<IsSwapped>(Destination, Alphas, R5G6B5, Alpha, Width);
+	}
+
+	// Copies native pixels into a buffer of the given order, like RGB565Kernels::CopyRectangle
+	template <bool IsSwapped>
+	void CopyRectangle(const uint16 *Source, uint16 SourceStride, uint16 *Destination, uint16 DestinationStride, uint16 Width, uint16 Height)
+	{
+		Wait();
+
+		if ((!IsSwapped || CAN_SWAP_BYTES) && IsWorthHardware(Width, Height))
+		{
+			StartCopy(Source, SourceStride, Destination, DestinationStride, Width, Height, IsSwapped);
+
+			return;
+		}
+
+		++m_SoftwareOperationCount;
+
+		RGB565Kernels::CopyRectangle<IsSwapped>(Source, SourceStride, Destination, DestinationStride, Width, Height);
+	}
+
+	// The buffers of the running operation must not be touched before it's done
+	void Wait(void)
+	{
+		if (!m_IsBusy)
+			return;
+
+#ifdef DMA2D
+		while ((DMA2D->CR & DMA2D_CR_START) != 0)
+		{
+		}
+
+		DMA2D->IFCR = DMA2D_IFCR_CTCIF;
+
+		// Lines the core might have fetched while the unit was writing
+		SCB_CleanInvalidateDCache_by_Addr(reinterpret_cast<uint32_t *>(m_Destination), m_DestinationSize);
+#endif
+
+		m_IsBusy = false;
+	}
+
+	bool IsBusy(void) const
+	{
+		return m_IsBusy;
+	}
+
+private:
+	bool IsWorthHardware(uint16 Width, uint16 Height) const
+	{
+		return (IS_AVAILABLE && static_cast<uint32>(Width) * Height >= m_HardwareThreshold);
+	}
+
+	void StartFill(uint16 *Destination, uint16 Stride, uint16 Width, uint16 Height, uint16 Value)
+	{
+#ifdef DMA2D
+		DMA2D->OPFCCR = COLOR_MODE_RGB565;
+		DMA2D->OCOLR = Value;
+
+		Start(MODE_REGISTER_TO_MEMORY, Destination, Stride, Width, Height);
+#endif
+	}
+
+	void StartBlend(uint16 *Destination, uint16 Stride, uint16 Width, uint16 Height, uint16 R5G6B5, uint8 Alpha)
+	{
+#if defined(DMA2D) && defined(DMA2D_CR_MODE_2)
+		DMA2D->FGPFCCR = (static_cast<uint32>(Alpha) << DMA2D_FGPFCCR_ALPHA_Pos) | (ALPHA_MODE_REPLACE << DMA2D_FGPFCCR_AM_Pos) | COLOR_MODE_RGB565;
+		DMA2D->FGCOLR = ToRGB888(R5G6B5);
+
+		SetBackground(Destination, Stride, Width, Height);
+
+		Start(MODE_MEMORY_TO_MEMORY_BLENDED_FIXED_FOREGROUND, Destination, Stride, Width, Height);
+#endif
+	}
+
+	void StartBlendAlphas(uint16 *Destination, uint16 Stride, const uint8 *Alphas, uint16 AlphaStride, uint16 Width, uint16 Height, uint16 R5G6B5, uint8 Alpha)
+	{
+#ifdef DMA2D
+		dsy_dma_clear_cache_for_buffer(const_cast<uint8 *>(Alphas), ((Height - 1) * AlphaStride) + Width);
+
+		DMA2D->FGMAR = reinterpret_cast<uint32>(Alphas);
+		DMA2D->FGOR = AlphaStride - Width;
+		DMA2D->FGPFCCR = (static_cast<uint32>(Alpha) << DMA2D_FGPFCCR_ALPHA_Pos) | (ALPHA_MODE_MULTIPLY << DMA2D_FGPFCCR_AM_Pos) | COLOR_MODE_A8;
+		DMA2D->FGCOLR = ToRGB888(R5G6B5);
+
+		SetBackground(Destination, Stride, Width, Height);
+
+		Start(MODE_MEMORY_TO_MEMORY_BLENDED, Destination, Stride, Width, Height);
+#endif
+	}
+
+	void StartCopy(const uint16 *Source, uint16 SourceStride, uint16 *Destination, uint16 DestinationStride, uint16 Width, uint16 Height, bool IsSwapped)
+	{
+#ifdef DMA2D
+		dsy_dma_clear_cache_for_buffer(reinterpret_cast<uint8 *>(const_cast<uint16 *>(Source)), (((Height - 1) * SourceStride) + Width) * sizeof(uint16));
+
+		DMA2D->FGMAR = reinterpret_cast<uint32>(Source);
+		DMA2D->FGOR = SourceStride - Width;
+		DMA2D->FGPFCCR = COLOR_MODE_RGB565;
+		DMA2D->OPFCCR = COLOR_MODE_RGB565;
+
+		uint32 mode = MODE_MEMORY_TO_MEMORY;
+#ifdef DMA2D_OPFCCR_SB
+		// Swapping takes the pixel format conversion path
+		if (IsSwapped)
+		{
+			DMA2D->OPFCCR = COLOR_MODE_RGB565 | DMA2D_OPFCCR_SB;
+			mode = MODE_MEMORY_TO_MEMORY_CONVERTED;
+		}
+#endif
+
+		Start(mode, Destination, DestinationStride, Width, Height);
+#endif
+	}
+
+#ifdef DMA2D
+	// The destination is read back as the background
+	void SetBackground(uint16 *Destination, uint16 Stride, uint16 Width, uint16 Height)
+	{
+		DMA2D->BGMAR = reinterpret_cast<uint32>(Destination);
+		DMA2D->BGOR = Stride - Width;
+		DMA2D->BGPFCCR = COLOR_MODE_RGB565;
+		DMA2D->OPFCCR = COLOR_MODE_RGB565;
+	}
+
+	void Start(uint32 Mode, uint16 *Destination, uint16 Stride, uint16 Width, uint16 Height)
+	{
+		m_Destination = Destination;
+		m_DestinationSize = (((Height - 1) * Stride) + Width) * sizeof(uint16);
+
+		// Whatever the CPU wrote there has to reach the memory before the unit reads or overwrites it, and no cached line of it
+		// may stay, otherwise the CPU reads the old pixels afterwards, or writes them back over the new ones on eviction
+		SCB_CleanInvalidateDCache_by_Addr(reinterpret_cast<uint32_t *>(m_Destination), m_DestinationSize);
+
+		DMA2D->OMAR = reinterpret_cast<uint32>(Destination);
+		DMA2D->OOR = Stride - Width;
+		DMA2D->NLR = (static_cast<uint32>(Width) << DMA2D_NLR_PL_Pos) | Height;
+		DMA2D->CR = Mode | DMA2D_CR_START;
+
+		m_IsBusy = true;
+		++m_HardwareOperationCount;
+	}
+
+	// Channels are widened by repeating their high bits, as the unit does for R5G6B5 backgrounds
+	static uint32 ToRGB888(uint16 R5G6B5)
+	{
+		return PixelFormatRGB888::FromR5G6B5(R5G6B5);
+	}
+#endif
+
+private:
+	uint32 m_HardwareThreshold;
+	bool m_IsBusy;
+	uint16 *m_Destination;
+	int32 m_DestinationSize;
+	uint32 m_HardwareOperationCount;
+	uint32 m_SoftwareOperationCount;
+};
+
+#endif
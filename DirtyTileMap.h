@@ -0,0 +1,201 @@
+#pragma once
+#ifndef DIRTY_TILE_MAP_H
+#define DIRTY_TILE_MAP_H
+
+#include "Common.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+
+// Tracks modified areas of a Width*Height surface as a bitmap of TileSize*TileSize tiles
+// and hands them out as merged rectangles, so only the changed areas get transmitted
+template <uint32 Width, uint32 Height, uint8 TileSize, uint8 MergeGap = 1>
+class DirtyTileMap
+{
+	static_assert(TileSize != 0, "TileSize must be greater than zero");
+
+	// Orientation may swap the axes, the product stays the same
+	static constexpr uint32 MAX_TILE_COUNT = ((Width + TileSize - 1) / TileSize) * ((Height + TileSize - 1) / TileSize);
+	static constexpr uint32 WORD_COUNT = (MAX_TILE_COUNT + 31) / 32;
+
+public:
+	DirtyTileMap(void)
+		: m_ColumnCount(0),
+		  m_RowCount(0),
+		  m_Bits{},
+		  m_DirtyCount(0)
+	{
+	}
+
+	void Initialize(Point Dimension)
+	{
+		ASSERT(Dimension.X * Dimension.Y == Width * Height, "Dimension doesn't match the surface");
+
+		m_Dimension = Dimension;
+		m_ColumnCount = (Dimension.X + TileSize - 1) / TileSize;
+		m_RowCount = (Dimension.Y + TileSize - 1) / TileSize;
+
+		ClearAll();
+	}
+
+	void Mark(uint16 X, uint16 Y)
+	{
+		SetBit((X / TileSize) + ((Y / TileSize) * m_ColumnCount));
+	}
+
+	// Coordinates are inclusive and must be inside the surface
+	void MarkRect(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1)
+	{
+		const uint16 column0 = X0 / TileSize;
+		const uint16 column1 = X1 / TileSize;
+		const uint16 row1 = Y1 / TileSize;
+
+		for (uint16 row = Y0 / TileSize; row <= row1; ++row)
+			for (uint16 column = column0; column <= column1; ++column)
+				SetBit(column + (row * m_ColumnCount));
+	}
+
+	void MarkAll(void)
+	{
+		for (uint32 i = 0; i < m_ColumnCount * m_RowCount; ++i)
+			SetBit(i);
+	}
+
+	void ClearAll(void)
+	{
+		for (uint32 &word : m_Bits)
+			word = 0;
+
+		m_DirtyCount = 0;
+	}
+
+	bool IsDirty(void) const
+	{
+		return (m_DirtyCount != 0);
+	}
+
+	uint16 GetDirtyTileCount(void) const
+	{
+		return m_DirtyCount;
+	}
+
+	// Calls Predicate(Column, Row) for every dirty tile and keeps the ones it returns true for
+	template <typename TilePredicate>
+	void Filter(TilePredicate Predicate)
+	{
+		for (uint32 word = 0; word < WORD_COUNT; ++word)
+		{
+			uint32 bits = m_Bits[word];
+			while (bits != 0)
+			{
+				const uint32 bit = __builtin_ctz(bits);
+				bits &= bits - 1;
+
+				const uint32 index = (word * 32) + bit;
+				if (!Predicate(static_cast<uint16>(index % m_ColumnCount), static_cast<uint16>(index / m_ColumnCount)))
+					ClearBit(index);
+			}
+		}
+	}
+
+	// Removes the next dirty rectangle from the map
+	// Runs in a tile row are merged over gaps of up to MergeGap clean tiles, since one more
+	// CASET/RASET/RAMWR sequence costs about as much as resending a short gap
+	// The run is then grown downwards while the rows below are dirty across the same columns
+	bool PopRegion(Rect &Region)
+	{
+		if (m_DirtyCount == 0)
+			return false;
+
+		uint16 row = 0;
+		uint16 column0 = 0;
+		if (!FindFirst(row, column0))
+			return false;
+
+		uint16 column1 = column0;
+		for (uint16 column = column0 + 1; column < m_ColumnCount && column - column1 <= MergeGap + 1; ++column)
+			if (GetBit(column + (row * m_ColumnCount)))
+				column1 = column;
+
+		uint16 lastRow = row;
+		while (lastRow + 1 < m_RowCount && IsRunDirty(lastRow + 1, column0, column1))
+			++lastRow;
+
+		for (uint16 r = row; r <= lastRow; ++r)
+			for (uint16 column = column0; column <= column1; ++column)
+				ClearBit(column + (r * m_ColumnCount));
+
+		const uint16 x = column0 * TileSize;
+		const uint16 y = row * TileSize;
+		Region.Position = {x, y};
+		Region.Dimension = {static_cast<uint16>(Math::Min<uint32>((column1 + 1) * TileSize, m_Dimension.X) - x),
+							static_cast<uint16>(Math::Min<uint32>((lastRow + 1) * TileSize, m_Dimension.Y) - y)};
+
+		return true;
+	}
+
+private:
+	bool FindFirst(uint16 &Row, uint16 &Column) const
+	{
+		for (uint32 word = 0; word < WORD_COUNT; ++word)
+		{
+			if (m_Bits[word] == 0)
+				continue;
+
+			uint32 index = (word * 32) + __builtin_ctz(m_Bits[word]);
+
+			Row = index / m_ColumnCount;
+			Column = index % m_ColumnCount;
+
+			return true;
+		}
+
+		return false;
+	}
+
+	bool IsRunDirty(uint16 Row, uint16 Column0, uint16 Column1) const
+	{
+		for (uint16 column = Column0; column <= Column1; ++column)
+			if (!GetBit(column + (Row * m_ColumnCount)))
+				return false;
+
+		return true;
+	}
+
+	bool GetBit(uint32 Index) const
+	{
+		return ((m_Bits[Index / 32] & (1U << (Index % 32))) != 0);
+	}
+
+	void SetBit(uint32 Index)
+	{
+		uint32 mask = 1U << (Index % 32);
+		uint32 &word = m_Bits[Index / 32];
+
+		if ((word & mask) != 0)
+			return;
+
+		word |= mask;
+		++m_DirtyCount;
+	}
+
+	void ClearBit(uint32 Index)
+	{
+		uint32 mask = 1U << (Index % 32);
+		uint32 &word = m_Bits[Index / 32];
+
+		if ((word & mask) == 0)
+			return;
+
+		word &= ~mask;
+		--m_DirtyCount;
+	}
+
+private:
+	Point m_Dimension;
+	uint16 m_ColumnCount;
+	uint16 m_RowCount;
+	uint32 m_Bits[WORD_COUNT];
+	uint16 m_DirtyCount;
+};
+
+#endif
@@ -0,0 +1,198 @@
+#pragma once
+#ifndef DISPLAY_LIST_H
+#define DISPLAY_LIST_H
+
+#include "Common.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+
+// Records the drawing commands of a frame, so they can be replayed band by band
+// into a small strip buffer instead of a full frame buffer
+// Only the commands touching the rows from Top to Bottom get recorded, so a frame which doesn't fit
+// can be recorded again for fewer rows at a time
+class DisplayList
+{
+public:
+	enum class Types
+	{
+		FillRectangle = 0,
+		BlendRow,
+		CopyRow
+	};
+
+	struct Command
+	{
+	public:
+		Types Type;
+		::Color Color;
+		Rect Bounds;
+		uint32 DataOffset;
+	};
+
+public:
+	DisplayList(void)
+		: m_Commands(nullptr),
+		  m_CommandCapacity(0),
+		  m_CommandCount(0),
+		  m_Data(nullptr),
+		  m_DataCapacity(0),
+		  m_DataSize(0),
+		  m_Top(0),
+		  m_Bottom(0),
+		  m_IsCleared(false),
+		  m_HasOverflowed(false)
+	{
+	}
+
+	void Initialize(uint16 CommandCapacity, uint32 DataCapacity)
+	{
+		ASSERT(CommandCapacity != 0, "CommandCapacity must be greater than zero");
+
+		m_Commands = Memory::Allocate<Command>(CommandCapacity, false);
+		m_CommandCapacity = CommandCapacity;
+
+		m_Data = Memory::Allocate<uint8>(DataCapacity, false);
+		m_DataCapacity = DataCapacity;
+
+		Reset(0, 0xFFFF);
+	}
+
+	// Bottom is exclusive
+	void Reset(uint16 Top, uint16 Bottom)
+	{
+		ASSERT(Top < Bottom, "Invalid rows %i to %i", Top, Bottom);
+
+		m_Top = Top;
+		m_Bottom = Bottom;
+
+		m_CommandCount = 0;
+		m_DataSize = 0;
+		m_IsCleared = false;
+		m_HasOverflowed = false;
+	}
+
+	// Everything recorded so far gets covered, so it's dropped
+	void Clear(Color Color)
+	{
+		m_CommandCount = 0;
+		m_DataSize = 0;
+		m_ClearColor = Color;
+		m_IsCleared = true;
+	}
+
+	void AddFillRectangle(Rect Bounds, Color Color)
+	{
+		// Extend the previous span for horizontally adjacent pixels of the same color, which is what lines produce
+		if (m_CommandCount != 0 && Bounds.Dimension.Y == 1)
+		{
+			Command &last = m_Commands[m_CommandCount - 1];
+
+			if (last.Type == Types::FillRectangle && last.Bounds.Dimension.Y == 1 &&
+				last.Bounds.Position.Y == Bounds.Position.Y &&
+				last.Bounds.Position.X + last.Bounds.Dimension.X == Bounds.Position.X &&
+				last.Color.R == Color.R && last.Color.G == Color.G && last.Color.B == Color.B && last.Color.A == Color.A)
+			{
+				last.Bounds.Dimension.X += Bounds.Dimension.X;
+
+				return;
+			}
+		}
+
+		AddCommand(Types::FillRectangle, Bounds, Color, 0, 1);
+	}
+
+	void AddBlendRow(Point Position, const uint8 *Alphas, uint16 Length, Color Color)
+	{
+		Command *command = AddCommand(Types::BlendRow, {Position.X, Position.Y, Length, 1}, Color, Length, 1);
+		if (command == nullptr)
+			return;
+
+		Memory::Copy(Alphas, m_Data + command->DataOffset, Length);
+	}
+
+	void AddCopyRow(Point Position, const uint16 *R5G6B5, uint16 Length)
+	{
+		Command *command = AddCommand(Types::CopyRow, {Position.X, Position.Y, Length, 1}, {}, Length * sizeof(uint16), sizeof(uint16));
+		if (command == nullptr)
+			return;
+
+		Memory::Copy(reinterpret_cast<const uint8 *>(R5G6B5), m_Data + command->DataOffset, Length * sizeof(uint16));
+	}
+
+	uint16 GetCount(void) const
+	{
+		return m_CommandCount;
+	}
+
+	const Command &Get(uint16 Index) const
+	{
+		return m_Commands[Index];
+	}
+
+	const uint8 *GetData(const Command &Command) const
+	{
+		return m_Data + Command.DataOffset;
+	}
+
+	bool IsCleared(void) const
+	{
+		return m_IsCleared;
+	}
+
+	// Kept across frames, it's the background of the regions no command covers
+	Color GetClearColor(void) const
+	{
+		return m_ClearColor;
+	}
+
+	// Commands got dropped since the last Reset
+	bool HasOverflowed(void) const
+	{
+		return m_HasOverflowed;
+	}
+
+private:
+	Command *AddCommand(Types Type, Rect Bounds, Color Color, uint32 DataSize, uint8 DataAlignment)
+	{
+		if (Bounds.Position.Y >= m_Bottom || Bounds.Position.Y + Bounds.Dimension.Y <= m_Top)
+			return nullptr;
+
+		uint32 dataOffset = ((m_DataSize + DataAlignment - 1) / DataAlignment) * DataAlignment;
+
+		// Not an error, the HAL renders the frame again for fewer rows at a time
+		if (m_CommandCount == m_CommandCapacity || dataOffset + DataSize > m_DataCapacity)
+		{
+			m_HasOverflowed = true;
+
+			return nullptr;
+		}
+
+		Command &command = m_Commands[m_CommandCount++];
+		command.Type = Type;
+		command.Color = Color;
+		command.Bounds = Bounds;
+		command.DataOffset = dataOffset;
+
+		m_DataSize = dataOffset + DataSize;
+
+		return &command;
+	}
+
+private:
+	Command *m_Commands;
+	uint16 m_CommandCapacity;
+	uint16 m_CommandCount;
+
+	uint8 *m_Data;
+	uint32 m_DataCapacity;
+	uint32 m_DataSize;
+
+	uint16 m_Top;
+	uint16 m_Bottom;
+
+	Color m_ClearColor;
+	bool m_IsCleared;
+	bool m_HasOverflowed;
+};
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+#ifndef FIXED_TRIGONOMETRY_H
+#define FIXED_TRIGONOMETRY_H
+
+#include "Common.h"
+
+// Quarter of a sine wave, 2.14 fixed point, built at compile time
+class FixedSineTable
+{
+public:
+	static constexpr uint8 SIZE_SHIFT = 8;
+	static constexpr uint16 SIZE = 1 << SIZE_SHIFT;
+
+public:
+	constexpr FixedSineTable(void)
+		: Values()
+	{
+		for (uint16 i = 0; i <= SIZE; ++i)
+			Values[i] = static_cast<int16>((GetSine((1.57079632679489661923 * i) / SIZE) * (1 << 14)) + 0.5);
+	}
+
+private:
+	// Taylor series, way more accurate than 14 bits on [0, PI / 2]
+	static constexpr double GetSine(double X)
+	{
+		double term = X;
+		double sum = X;
+
+		for (uint8 i = 1; i < 12; ++i)
+		{
+			term *= -(X * X) / ((2 * i) * ((2 * i) + 1));
+			sum += term;
+		}
+
+		return sum;
+	}
+
+public:
+	int16 Values[SIZE + 1];
+};
+
+static constexpr FixedSineTable FIXED_SINE_TABLE;
+
+// Sine and cosine of binary angles, a full turn is 65536 so angles wrap around like uint16 does
+// Results are 2.14 fixed point, linearly interpolated between the entries of FIXED_SINE_TABLE
+class FixedTrigonometry
+{
+public:
+	static constexpr uint8 SHIFT = 14;
+	static constexpr int32 ONE = 1 << SHIFT;
+
+	static constexpr uint16 ANGLE_90 = 0x4000;
+	static constexpr uint16 ANGLE_180 = 0x8000;
+	static constexpr uint16 ANGLE_270 = 0xC000;
+
+private:
+	static constexpr uint8 FRACTION_SHIFT = 14 - FixedSineTable::SIZE_SHIFT;
+	static constexpr uint16 FRACTION_MASK = (1 << FRACTION_SHIFT) - 1;
+
+public:
+	static constexpr uint16 FromDegrees(int32 Degrees)
+	{
+		return static_cast<uint16>((static_cast<int64>(Degrees) * 65536) / 360);
+	}
+
+	static int32 Sine(uint16 Angle)
+	{
+		const uint8 quadrant = Angle >> 14;
+
+		uint16 offset = Angle & (ANGLE_90 - 1);
+		if ((quadrant & 1) != 0)
+			offset = ANGLE_90 - offset;
+
+		const uint16 index = offset >> FRACTION_SHIFT;
+		const int32 fraction = offset & FRACTION_MASK;
+
+		int32 value = FIXED_SINE_TABLE.Values[index];
+		if (fraction != 0)
+			value += ((FIXED_SINE_TABLE.Values[index + 1] - value) * fraction) >> FRACTION_SHIFT;
+
+		return ((quadrant & 2) != 0 ? -value : value);
+	}
+
+	static int32 Cosine(uint16 Angle)
+	{
+		return Sine(static_cast<uint16>(Angle + ANGLE_90));
+	}
+};
+
+#endif
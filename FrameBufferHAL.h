@@ -0,0 +1,333 @@
+#pragma once
+#ifndef FRAME_BUFFER_HAL_H
+#define FRAME_BUFFER_HAL_H
+
+#include "I_LCD_HAL.h"
+#include "PixelFormats.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+#include "DSP/ContextCallback.h"
+#include <daisy_seed.h>
+#include <cstring>
+
+// A Width*Height frame buffer in the layout of PixelFormat, for the panels which aren't 16-bit, like SSD1306 (PixelFormatMonochrome)
+// or the RGB888 ones, the driver of the panel sends the dirty pages in the flush listener
+// Colors get converted into PixelType once per primitive, the spans are then written in the native pixels
+// Dirty areas are tracked per page of PixelFormat::PAGE_HEIGHT rows, as a range of columns
+template <uint32 Width, uint32 Height, typename PixelFormat>
+class FrameBufferHAL final : public I_LCD_HAL
+{
+	static_assert(Width != 0 && Width < 0xFFFF, "Width is out of range");
+	static_assert(Height != 0 && Height < 0xFFFF, "Height is out of range");
+
+	static constexpr uint8 MAX_FRAME_RATE = 60;
+	static constexpr uint32 BUFFER_SIZE = PixelFormat::GetBufferSize(Width, Height);
+	static constexpr uint16 PAGE_COUNT = (Height + PixelFormat::PAGE_HEIGHT - 1) / PixelFormat::PAGE_HEIGHT;
+	static constexpr uint16 NO_COLUMN = 0xFFFF;
+
+	// Inclusive, FirstColumn is NO_COLUMN while the page is clean
+	struct DirtyPage
+	{
+	public:
+		uint16 FirstColumn;
+		uint16 LastColumn;
+	};
+
+public:
+	typedef PixelFormat PixelFormatType;
+	typedef typename PixelFormat::PixelType PixelType;
+
+	typedef ContextCallback<void> RenderEventHandler;
+	typedef ContextCallback<void> FlushEventHandler;
+
+public:
+	FrameBufferHAL(void)
+		: m_Dimension({Width, Height}),
+		  m_Buffer(nullptr),
+		  m_DirtyPages{},
+		  m_TargetFrameRate(0),
+		  m_FrameInterval(0),
+		  m_NextUpdateTime(0)
+	{
+	}
+
+	void Initialize(void)
+	{
+		m_Buffer = Memory::Allocate<uint8>(BUFFER_SIZE, true);
+		std::memset(m_Buffer, 0, BUFFER_SIZE);
+
+		MarkAll();
+
+		SetTargetFrameRate(MAX_FRAME_RATE);
+
+		m_NextUpdateTime = GetTime();
+	}
+
+	void SetOnRender(RenderEventHandler Listener)
+	{
+		m_RenderListener = Listener;
+	}
+
+	// Called after a frame got rendered with dirty pages, which the listener pops and sends
+	void SetOnFlush(FlushEventHandler Listener)
+	{
+		m_FlushListener = Listener;
+	}
+
+	void Update(void) override
+	{
+		const uint32 time = GetTime();
+		if (static_cast<int32>(time - m_NextUpdateTime) < 0)
+			return;
+
+		m_NextUpdateTime += (((time - m_NextUpdateTime) / m_FrameInterval) + 1) * m_FrameInterval;
+
+		m_RenderListener();
+
+		if (IsDirty())
+			m_FlushListener();
+	}
+
+	void SetTargetFrameRate(uint8 Value) override
+	{
+		ASSERT(Value != 0, "Invalid Value %f", Value);
+
+		m_TargetFrameRate = Math::Min(MAX_FRAME_RATE, Value);
+		m_FrameInterval = 1000000 / m_TargetFrameRate;
+	}
+
+	uint8 GetTargetFrameRate(void) const override
+	{
+		return m_TargetFrameRate;
+	}
+
+	void Clear(Color Color) override
+	{
+		const PixelType pixel = PixelFormat::FromColor(Color);
+
+		for (uint16 y = 0; y < Height; ++y)
+			PixelFormat::FillRow(m_Buffer, Width, 0, y, Width, pixel);
+
+		MarkAll();
+	}
+
+	void DrawPixel(Point Position, Color Color) override
+	{
+		PlotPixel(Position, PixelFormat::FromColor(Color), Color.A);
+	}
+
+	void DrawHorizontalLine(Point Position, uint16 Length, Color Color) override
+	{
+		DrawFilledRectangle({Position.X, Position.Y, Length, 1}, Color);
+	}
+
+	void DrawVerticalLine(Point Position, uint16 Length, Color Color) override
+	{
+		DrawFilledRectangle({Position.X, Position.Y, 1, Length}, Color);
+	}
+
+	void DrawFilledRectangle(Rect Rect, Color Color) override
+	{
+		const Point &position = Rect.Position;
+		if (position.X >= Width || position.Y >= Height)
+			return;
+
+		const uint16 width = Math::Min<uint16>(Rect.Dimension.X, Width - position.X);
+		const uint16 height = Math::Min<uint16>(Rect.Dimension.Y, Height - position.Y);
+		if (width == 0 || height == 0)
+			return;
+
+		const PixelType pixel = PixelFormat::FromColor(Color);
+
+		for (uint16 y = position.Y; y < position.Y + height; ++y)
+		{
+			if (Color.A == 255)
+			{
+				PixelFormat::FillRow(m_Buffer, Width, position.X, y, width, pixel);
+
+				continue;
+			}
+
+			for (uint16 x = position.X; x < position.X + width; ++x)
+				PixelFormat::Write(m_Buffer, Width, x, y, PixelFormat::Blend(pixel, PixelFormat::Read(m_Buffer, Width, x, y), Color.A));
+		}
+
+		Mark(position.X, position.Y, position.X + width - 1, position.Y + height - 1);
+	}
+
+	void BlendHorizontalLine(Point Position, const uint8 *Alphas, uint16 Length, Color Color) override
+	{
+		if (Position.X >= Width || Position.Y >= Height)
+			return;
+
+		Length = Math::Min<uint16>(Length, Width - Position.X);
+		if (Length == 0)
+			return;
+
+		const PixelType pixel = PixelFormat::FromColor(Color);
+
+		for (uint16 i = 0; i < Length; ++i)
+		{
+			const uint8 alpha = RGB565Kernels::ScaleAlpha(Alphas[i], Color.A);
+			if (alpha == 0)
+				continue;
+
+			const uint16 x = Position.X + i;
+
+			PixelFormat::Write(m_Buffer, Width, x, Position.Y, (alpha == 255 ? pixel : PixelFormat::Blend(pixel, PixelFormat::Read(m_Buffer, Width, x, Position.Y), alpha)));
+		}
+
+		Mark(Position.X, Position.Y, Position.X + Length - 1, Position.Y);
+	}
+
+	void DrawPixels(const Point *Positions, uint16 Count, Color Color) override
+	{
+		const PixelType pixel = PixelFormat::FromColor(Color);
+
+		for (uint16 i = 0; i < Count; ++i)
+			PlotPixel(Positions[i], pixel, Color.A);
+	}
+
+	void BlendPixels(const Point *Positions, const uint8 *Alphas, uint16 Count, Color Color) override
+	{
+		const PixelType pixel = PixelFormat::FromColor(Color);
+
+		for (uint16 i = 0; i < Count; ++i)
+		{
+			const uint8 alpha = RGB565Kernels::ScaleAlpha(Alphas[i], Color.A);
+			if (alpha != 0)
+				PlotPixel(Positions[i], pixel, alpha);
+		}
+	}
+
+	void DrawRow(Point Position, const uint16 *R5G6B5, uint16 Length) override
+	{
+		if (Position.X >= Width || Position.Y >= Height)
+			return;
+
+		Length = Math::Min<uint16>(Length, Width - Position.X);
+		if (Length == 0)
+			return;
+
+		for (uint16 i = 0; i < Length; ++i)
+			PixelFormat::Write(m_Buffer, Width, Position.X + i, Position.Y, PixelFormat::FromR5G6B5(R5G6B5[i]));
+
+		Mark(Position.X, Position.Y, Position.X + Length - 1, Position.Y);
+	}
+
+	const Point &GetDimension(void) const override
+	{
+		return m_Dimension;
+	}
+
+	// In the layout of PixelFormat
+	const uint8 *GetBuffer(void) const
+	{
+		return m_Buffer;
+	}
+
+	static constexpr uint32 GetBufferSize(void)
+	{
+		return BUFFER_SIZE;
+	}
+
+	static constexpr uint16 GetPageCount(void)
+	{
+		return PAGE_COUNT;
+	}
+
+	bool IsDirty(void) const
+	{
+		for (const DirtyPage &page : m_DirtyPages)
+			if (page.FirstColumn != NO_COLUMN)
+				return true;
+
+		return false;
+	}
+
+	// Removes the next dirty page, the columns are inclusive
+	bool PopDirtyPage(uint16 &Page, uint16 &FirstColumn, uint16 &LastColumn)
+	{
+		for (uint16 i = 0; i < PAGE_COUNT; ++i)
+		{
+			DirtyPage &page = m_DirtyPages[i];
+			if (page.FirstColumn == NO_COLUMN)
+				continue;
+
+			Page = i;
+			FirstColumn = page.FirstColumn;
+			LastColumn = page.LastColumn;
+
+			page.FirstColumn = NO_COLUMN;
+
+			return true;
+		}
+
+		return false;
+	}
+
+private:
+	void PlotPixel(Point Position, PixelType Pixel, uint8 Alpha)
+	{
+		if (Position.X >= Width || Position.Y >= Height)
+			return;
+
+		if (Alpha != 255)
+			Pixel = PixelFormat::Blend(Pixel, PixelFormat::Read(m_Buffer, Width, Position.X, Position.Y), Alpha);
+
+		PixelFormat::Write(m_Buffer, Width, Position.X, Position.Y, Pixel);
+
+		Mark(Position.X, Position.Y, Position.X, Position.Y);
+	}
+
+	// Coordinates are inclusive and must be inside the surface
+	void Mark(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1)
+	{
+		const uint16 lastPage = Y1 / PixelFormat::PAGE_HEIGHT;
+
+		for (uint16 i = Y0 / PixelFormat::PAGE_HEIGHT; i <= lastPage; ++i)
+		{
+			DirtyPage &page = m_DirtyPages[i];
+
+			if (page.FirstColumn == NO_COLUMN)
+			{
+				page.FirstColumn = X0;
+				page.LastColumn = X1;
+
+				continue;
+			}
+
+			page.FirstColumn = Math::Min(page.FirstColumn, X0);
+			page.LastColumn = Math::Max(page.LastColumn, X1);
+		}
+	}
+
+	void MarkAll(void)
+	{
+		for (DirtyPage &page : m_DirtyPages)
+		{
+			page.FirstColumn = 0;
+			page.LastColumn = Width - 1;
+		}
+	}
+
+	// Microseconds, wrapping around every 71 minutes
+	static uint32 GetTime(void)
+	{
+		return daisy::System::GetUs();
+	}
+
+private:
+	Point m_Dimension;
+	uint8 *m_Buffer;
+	DirtyPage m_DirtyPages[PAGE_COUNT];
+
+	RenderEventHandler m_RenderListener;
+	FlushEventHandler m_FlushListener;
+
+	uint8 m_TargetFrameRate;
+	uint32 m_FrameInterval;
+	uint32 m_NextUpdateTime;
+};
+
+#endif
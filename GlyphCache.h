@@ -0,0 +1,177 @@
+#pragma once
+#ifndef GLYPH_CACHE_H
+#define GLYPH_CACHE_H
+
+#include "Common.h"
+#include "DSP/Debug.h"
+
+// Keeps the scaled coverage of the drawn characters as horizontal runs, keyed by (Font, Scale, Char),
+// so text gets drawn as span fills instead of unpacking and scaling the font data on every draw
+class GlyphCache
+{
+public:
+	struct Run
+	{
+	public:
+		uint8 X;
+		uint8 Y;
+		uint8 Length;
+	};
+
+	struct Glyph
+	{
+	public:
+		const uint16 *Data;
+		float Scale;
+		char Char;
+		uint16 FirstRun;
+		uint16 RunCount;
+	};
+
+public:
+	GlyphCache(void)
+		: m_Glyphs(nullptr),
+		  m_GlyphCapacity(0),
+		  m_GlyphCount(0),
+		  m_Runs(nullptr),
+		  m_RunCapacity(0),
+		  m_RunCount(0)
+	{
+	}
+
+	void Initialize(uint16 GlyphCapacity, uint16 RunCapacity, bool OnSDRAM = false)
+	{
+		ASSERT(GlyphCapacity != 0 && (GlyphCapacity & (GlyphCapacity - 1)) == 0, "GlyphCapacity must be a power of two");
+		ASSERT(RunCapacity != 0, "RunCapacity must be greater than zero");
+
+		m_Glyphs = Memory::Allocate<Glyph>(GlyphCapacity, OnSDRAM);
+		m_GlyphCapacity = GlyphCapacity;
+
+		m_Runs = Memory::Allocate<Run>(RunCapacity, OnSDRAM);
+		m_RunCapacity = RunCapacity;
+
+		Reset();
+	}
+
+	void Reset(void)
+	{
+		for (uint16 i = 0; i < m_GlyphCapacity; ++i)
+			m_Glyphs[i].Data = nullptr;
+
+		m_GlyphCount = 0;
+		m_RunCount = 0;
+	}
+
+	const Glyph &Get(const Font &Font, char Char)
+	{
+		ASSERT(m_Glyphs != nullptr, "GlyphCache is not initialized");
+
+		Glyph *glyph = Find(Font, Char);
+		if (glyph->Data != nullptr)
+			return *glyph;
+
+		// Rather than evicting single glyphs, start over when it's full, the working set is small
+		// Scaled up, set pixels land on columns apart from each other, so every one of them can be a run
+		const uint16 maxRunCount = Font.Height * (Font.Scale > 1 ? Font.Width : (Font.Width + 1) / 2);
+		if (m_GlyphCount * 4 >= m_GlyphCapacity * 3 || m_RunCount + maxRunCount > m_RunCapacity)
+		{
+			Reset();
+
+			glyph = Find(Font, Char);
+		}
+
+		Build(*glyph, Font, Char);
+
+		++m_GlyphCount;
+
+		return *glyph;
+	}
+
+	const Run *GetRuns(const Glyph &Glyph) const
+	{
+		return m_Runs + Glyph.FirstRun;
+	}
+
+private:
+	Glyph *Find(const Font &Font, char Char)
+	{
+		uint32 hash = (reinterpret_cast<uintptr_t>(Font.Data) >> 1) ^ (static_cast<uint32>(Font.Scale * 16) * 31) ^ (static_cast<uint8>(Char) * 2654435761U);
+
+		for (uint16 i = 0;; ++i)
+		{
+			Glyph &glyph = m_Glyphs[(hash + i) & (m_GlyphCapacity - 1)];
+
+			if (glyph.Data == nullptr)
+				return &glyph;
+
+			if (glyph.Data == Font.Data && glyph.Scale == Font.Scale && glyph.Char == Char)
+				return &glyph;
+		}
+	}
+
+	// Same nearest placement as LCDCanvas::DrawCharacter, source pixel (x, y) lands on (x * Scale, y * Scale)
+	void Build(Glyph &Glyph, const Font &Font, char Char)
+	{
+		Glyph.Data = Font.Data;
+		Glyph.Scale = Font.Scale;
+		Glyph.Char = Char;
+		Glyph.FirstRun = m_RunCount;
+
+		auto dataPtr = Font.Data + ((Char - ' ') * Font.Height);
+		for (uint8 y = 0; y < Font.Height; ++y)
+		{
+			// Of the source rows and columns landing on the same scaled one, the last one wins
+			const uint8 scaledY = y * Font.Scale;
+			if (y + 1 < Font.Height && (uint8)((y + 1) * Font.Scale) == scaledY)
+				continue;
+
+			uint16 data = dataPtr[y];
+			if (data == 0)
+				continue;
+
+			Run *run = nullptr;
+			for (uint8 x = 0; x < Font.Width; ++x)
+			{
+				const uint8 scaledX = x * Font.Scale;
+				if (x + 1 < Font.Width && (uint8)((x + 1) * Font.Scale) == scaledX)
+					continue;
+
+				if (((1 << x) & data) == 0)
+					continue;
+
+				if (run != nullptr && run->X + run->Length == scaledX)
+				{
+					++run->Length;
+					continue;
+				}
+
+				// A glyph larger than the whole cache gets cut short
+				ASSERT(m_RunCount < m_RunCapacity, "Running out of run capacity");
+				if (m_RunCount == m_RunCapacity)
+				{
+					Glyph.RunCount = m_RunCount - Glyph.FirstRun;
+
+					return;
+				}
+
+				run = &m_Runs[m_RunCount++];
+				run->X = scaledX;
+				run->Y = scaledY;
+				run->Length = 1;
+			}
+		}
+
+		Glyph.RunCount = m_RunCount - Glyph.FirstRun;
+	}
+
+private:
+	Glyph *m_Glyphs;
+	uint16 m_GlyphCapacity;
+	uint16 m_GlyphCount;
+
+	Run *m_Runs;
+	uint16 m_RunCapacity;
+	uint16 m_RunCount;
+};
+
+#endif
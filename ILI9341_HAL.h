@@ -4,162 +4,1530 @@
 
 #include "I_LCD_HAL.h"
 #include "DaisySeedHAL.h"
+#include "DirtyTileMap.h"
+#include "TileSignatureMap.h"
+#include "DisplayList.h"
+#include "RGB565Kernels.h"
+#include "DMA2DAccelerator.h"
+#include "SPIBus.h"
 #include "DSP/Math.h"
 #include "DSP/ContextCallback.h"
 #include <daisy_seed.h>
+#include <atomic>
+#include <cstring>
+#include <new>
 
 template <uint32 Width, uint32 Height>
-class ILI9341_HAL : public I_LCD_HAL
+class ILI9341_HAL final : public I_LCD_HAL
 {
 	static_assert(Width != 0, "Width must be greater than zero");
 	static_assert(Height != 0, "Height must be greater than zero");
 
 	static constexpr uint8 MAX_FRAME_RATE = 60;
+	// Adaptive frame rate goes down to it while nothing gets drawn
+	static constexpr uint8 IDLE_FRAME_RATE = 10;
+	// A pending frame gets sent anyway if no vertical blanking is seen for this long, in microseconds
+	static constexpr uint32 TEARING_EFFECT_TIMEOUT = 20000;
 	static constexpr uint32 FRAME_BUFFER_LENGTH = Width * Height;
-	static constexpr uint16 FRAME_BUFFER_CHUNK_COUNT = 10;
-	static constexpr uint32 FRAME_BUFFER_CHUNK_SIZE = FRAME_BUFFER_LENGTH / FRAME_BUFFER_CHUNK_COUNT;
+	static constexpr uint8 DIRTY_TILE_SIZE = 16;
+	// HAL_SPI_Transmit_DMA accepts the length as uint16
+	static constexpr uint32 MAX_DMA_TRANSFER_SIZE = 0xFFFF;
 
-	static_assert(FRAME_BUFFER_CHUNK_COUNT > 2, "FRAME_BUFFER_CHUNK_COUNT must be greater than 2, cause the HAL_SPI_Transmit_DMA accepts the length as uint16");
+	static_assert((Width > Height ? Width : Height) * sizeof(uint16) <= MAX_DMA_TRANSFER_SIZE, "A single row must fit in one DMA transfer");
+
+	static constexpr uint8 BAND_HEIGHT = 16;
+	static constexpr uint8 BAND_STRIP_COUNT = 2;
+	static constexpr uint32 BAND_STRIP_LENGTH = BAND_HEIGHT * (Width > Height ? Width : Height);
+	static constexpr uint8 NO_BAND = 0xFF;
+	// A typical frame of a clear, a few hundred spans and a few lines of anti-aliased text, about 14 KB,
+	// heavier frames get rendered again band by band
+	static constexpr uint16 DISPLAY_LIST_COMMAND_CAPACITY = 512;
+	static constexpr uint32 DISPLAY_LIST_DATA_CAPACITY = 4 * 1024;
+
+	static_assert(((Width > Height ? Width : Height) + BAND_HEIGHT - 1) / BAND_HEIGHT <= 32, "Band masks are stored in uint32");
+
+	static constexpr uint16 PALETTE_SIZE = 256;
+	static constexpr uint8 PALETTE_CACHE_SIZE = 32;
+	static constexpr uint8 LINE_BUFFER_COUNT = 2;
+	static constexpr uint32 LINE_BUFFER_LENGTH = 4 * (Width > Height ? Width : Height);
+
+	// CASET, its 4 parameters, RASET, its 4 parameters and RAMWR, each one sent by its own DMA transfer
+	static constexpr uint8 WINDOW_STEP_COUNT = 5;
+	static constexpr uint8 WINDOW_COMMANDS_SIZE = 11;
+
+	typedef DirtyTileMap<Width, Height, DIRTY_TILE_SIZE> DirtyTileMapType;
+	typedef TileSignatureMap<Width, Height, DIRTY_TILE_SIZE> TileSignatureMapType;
+
+	// Last colors mapped to palette indices, so drawing with the same colors doesn't search the palette again
+	struct PaletteCacheEntry
+	{
+	public:
+		uint16 R5G6B5;
+		uint8 Index;
+		bool IsValid;
+	};
+
+	// Along the scroll axis, Offset is how far the content has been scrolled
+	struct ScrollRegion
+	{
+	public:
+		uint16 Start;
+		uint16 Length;
+		uint16 Offset;
+	};
 
 public:
+	enum class FrameBufferModes
+	{
+		// Rendering waits for the transmission of the previous frame
+		Single = 0,
+		// Rendering goes to a back buffer while the front buffer is being transmitted, costs a second frame buffer
+		// The back buffer holds native pixels, they get swapped into the panel order while being copied to the front buffer
+		Double,
+		// No frame buffer, drawing is recorded into a display list and replayed into small internal SRAM strips,
+		// so every frame has to be drawn completely; bands which aren't drawn keep what the panel shows
+		// A frame which overflows the display list gets rendered again for a few bands at a time, so the render listener can be called more than once per frame
+		Band,
+		// The frame buffer holds 8-bit indices of a 256 color palette, half the memory of Single, drawn colors get
+		// the nearest palette entry; Update expands dirty regions into small internal SRAM line buffers while
+		// the previous lines are being transmitted, rendering waits for the transmission like Single
+		Palette
+	};
+
 	typedef ContextCallback<void> RenderEventHandler;
 
-public:
-	ILI9341_HAL(IHAL *HAL, GPIOPins SCLK, GPIOPins MOSI, GPIOPins NSS, GPIOPins DC, GPIOPins RST, Orientations Orientation)
-		: m_HAL(HAL),
-		  m_PinSCLK(SCLK),
-		  m_PinMOSI(MOSI),
-		  m_PinNSS(NSS),
-		  m_PinDC(DC),
-		  m_PinRST(RST),
-		  m_Orientation(Orientation),
-		  m_FrameBuffer(nullptr),
-		  m_FrameBufferDirty(nullptr),
-		  m_TargetFrameRate(0),
-		  m_UpdateStep(0),
-		  m_NextUpdateTime(0),
-		  m_IsDMABusy(false),
-		  m_LastFrameBufferDirtyIndex(0)
+public:
+	// Owns SPI_1, nothing else can use the bus, which gets allocated by Initialize
+	ILI9341_HAL(IHAL *HAL, GPIOPins SCLK, GPIOPins MOSI, GPIOPins NSS, GPIOPins DC, GPIOPins RST, Orientations Orientation, FrameBufferModes FrameBufferMode = FrameBufferModes::Single)
+		: ILI9341_HAL(HAL, nullptr, NSS, DC, RST, Orientation, FrameBufferMode)
+	{
+		m_IsBusOwned = true;
+		m_PinSCLK = SCLK;
+		m_PinMOSI = MOSI;
+	}
+
+	// One of the devices of a shared bus, the frame data goes out in chunks with the Low priority,
+	// so the transfers of the other devices get in between
+	ILI9341_HAL(IHAL *HAL, SPIBus *Bus, GPIOPins CS, GPIOPins DC, GPIOPins RST, Orientations Orientation, FrameBufferModes FrameBufferMode = FrameBufferModes::Single)
+		: m_HAL(HAL),
+		  m_Bus(Bus),
+		  m_IsBusOwned(false),
+		  m_Device(0),
+		  m_PinSCLK(GPIOPins::Pin0),
+		  m_PinMOSI(GPIOPins::Pin0),
+		  m_PinCS(CS),
+		  m_PinDC(DC),
+		  m_PinRST(RST),
+		  m_Orientation(Orientation),
+		  m_FrameBufferMode(FrameBufferMode),
+		  m_IsFrameBufferSwapped(FrameBufferMode != FrameBufferModes::Double),
+		  m_FrameBuffer(nullptr),
+		  m_FrontBuffer(nullptr),
+		  m_IndexBuffer(nullptr),
+		  m_Palette{},
+		  m_PaletteCache{},
+		  m_LineBuffers{},
+		  m_LineBufferLengths{},
+		  m_LineBufferWindows{},
+		  m_ExpandingLineBuffer(0),
+		  m_TransmittingLineBuffer(0),
+		  m_IsLineWindowSent(false),
+		  m_AreLinesLost(false),
+		  m_TransmitTiles(nullptr),
+		  m_IsSkippingUnchangedTiles(false),
+		  m_AreTileSignaturesLost(false),
+		  m_HashedTileCount(0),
+		  m_SkippedTileCount(0),
+		  m_SentTileCount(0),
+		  m_Strips{},
+		  m_StripBands{NO_BAND, NO_BAND},
+		  m_TransmittingStrip(0),
+		  m_IsStripWindowSent(false),
+		  m_BandCount(0),
+		  m_BandMask(0),
+		  m_PendingBandMask(0),
+		  m_LastFrameBandMask(0),
+		  m_NextPassBand(0),
+		  m_AreBandsLost(false),
+		  m_TargetFrameRate(0),
+		  m_TargetFrameInterval(0),
+		  m_FrameInterval(0),
+		  m_NextUpdateTime(0),
+		  m_IsAdaptiveFrameRate(false),
+		  m_IsTearingEffectSynced(false),
+		  m_IsDMABusy(false),
+		  m_WindowCommands(nullptr),
+		  m_WindowStep(WINDOW_STEP_COUNT),
+		  m_RetryData(nullptr),
+		  m_RetrySize(0),
+		  m_RetryIsData(false),
+		  m_IsFramePending(false),
+		  m_FramePendingTime(0),
+		  m_DirtyRegionRow(0),
+		  m_DirtyRegionRowsPerTransfer(0),
+		  m_FrameCount(0),
+		  m_FrameRateWindowStartTime(0),
+		  m_AchievedFrameRate(0),
+		  m_DroppedFrameCount(0),
+		  m_RenderTime(0),
+		  m_TransmitStartTime(0),
+		  m_TransmitTime(0),
+		  m_IsTransmitting(false),
+		  m_MaxInterruptTicks(0),
+		  m_ScrollAxis(ScrollAxes::None),
+		  m_IsScrollAxisReversed(false),
+		  m_Scroll{},
+		  m_PanelScroll{}
+	{
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+	}
+
+	void Initialize(void)
+	{
+		m_Accelerator.Initialize();
+
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			for (uint8 i = 0; i < BAND_STRIP_COUNT; ++i)
+				m_Strips[i] = Memory::Allocate<uint16>(BAND_STRIP_LENGTH, false);
+
+			m_DisplayList.Initialize(DISPLAY_LIST_COMMAND_CAPACITY, DISPLAY_LIST_DATA_CAPACITY);
+		}
+		else if (m_FrameBufferMode == FrameBufferModes::Palette)
+		{
+			m_IndexBuffer = Memory::Allocate<uint8>(FRAME_BUFFER_LENGTH, true);
+
+			for (uint8 i = 0; i < LINE_BUFFER_COUNT; ++i)
+				m_LineBuffers[i] = Memory::Allocate<uint16>(LINE_BUFFER_LENGTH, false);
+
+			m_TransmitTiles = &m_DirtyTiles;
+
+			SetDefaultPalette();
+		}
+		else
+		{
+			m_FrameBuffer = Memory::Allocate<uint16>(FRAME_BUFFER_LENGTH, true);
+
+			m_FrontBuffer = m_FrameBuffer;
+			m_TransmitTiles = &m_DirtyTiles;
+			if (m_FrameBufferMode == FrameBufferModes::Double)
+			{
+				m_FrontBuffer = Memory::Allocate<uint16>(FRAME_BUFFER_LENGTH, true);
+				m_TransmitTiles = &m_FrontDirtyTiles;
+			}
+		}
+
+		// Read by the DMA, like the strips
+		m_WindowCommands = Memory::Allocate<uint8>(WINDOW_COMMANDS_SIZE, false);
+
+		InitializeSPI(m_PinCS, m_PinDC, m_PinRST);
+
+		InitDriver(m_Orientation);
+
+		m_DirtyTiles.Initialize(m_Dimension);
+		m_FrontDirtyTiles.Initialize(m_Dimension);
+		m_TileSignatures.Initialize(m_Dimension);
+
+		m_BandCount = (m_Dimension.Y + BAND_HEIGHT - 1) / BAND_HEIGHT;
+
+		SetTargetFrameRate(MAX_FRAME_RATE);
+
+		m_NextUpdateTime = GetTime();
+	}
+
+	void SetOnRender(RenderEventHandler Listener)
+	{
+		m_RenderListener = Listener;
+	}
+
+	void Update(void) override
+	{
+		if (m_RetryData != nullptr)
+			RetryTransfer();
+
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			UpdateBandMode();
+
+			return;
+		}
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette && m_IsTransmitting)
+			UpdateLineBuffers();
+
+		uint32 time = GetTime();
+
+		// A rendered frame waits for the DMA, and for the vertical blanking when synced
+		if (m_IsFramePending && !m_IsDMABusy && IsTransmissionAllowed(time))
+			StartTransmission(time);
+
+		// The frame buffer of Single and Palette modes is being read during the transmission, and the back buffer of Double mode
+		// still holds a frame which hasn't been presented
+		// Palette mode reads it between the transfers too, while the DMA waits for the next line buffer
+		if (m_IsFramePending || (m_IsDMABusy && m_FrameBufferMode != FrameBufferModes::Double) || (m_FrameBufferMode == FrameBufferModes::Palette && m_IsTransmitting))
+			return;
+
+		if (!IsFrameDue(time))
+			return;
+
+		Render(time);
+
+		m_IsFramePending = true;
+		m_FramePendingTime = time;
+
+		if (!m_IsDMABusy && IsTransmissionAllowed(time))
+			StartTransmission(time);
+	}
+
+	void SetTargetFrameRate(uint8 Value)
+	{
+		ASSERT(Value != 0, "Invalid Value %f", Value);
+
+		m_TargetFrameRate = Math::Min(MAX_FRAME_RATE, Value);
+
+		m_TargetFrameInterval = 1000000 / m_TargetFrameRate;
+		m_FrameInterval = m_TargetFrameInterval;
+	}
+
+	uint8 GetTargetFrameRate(void) const
+	{
+		return m_TargetFrameRate;
+	}
+
+	// Number of frames rendered during the last second, to compare against the target frame rate
+	uint8 GetAchievedFrameRate(void) const
+	{
+		return m_AchievedFrameRate;
+	}
+
+	// Frame slots which passed without rendering, since the previous frame was still being rendered or transmitted
+	uint32 GetDroppedFrameCount(void) const
+	{
+		return m_DroppedFrameCount;
+	}
+
+	// Microseconds the render event of the last frame took
+	uint32 GetRenderTime(void) const
+	{
+		return m_RenderTime;
+	}
+
+	// Microseconds from starting the transmission of the last frame to its end
+	uint32 GetTransmitTime(void) const
+	{
+		return m_TransmitTime;
+	}
+
+	// Longest time the DMA completion interrupt took since the last reset, in nanoseconds
+	// It only starts the next transfer of the frame and never waits for the SPI, so this is all it can delay
+	// the other interrupts, like the audio one, by
+	uint32 GetMaxInterruptDuration(void) const
+	{
+		return static_cast<uint32>((static_cast<uint64>(m_MaxInterruptTicks) * 1000000000) / daisy::System::GetTickFreq());
+	}
+
+	void ResetMaxInterruptDuration(void)
+	{
+		m_MaxInterruptTicks = 0;
+	}
+
+	// Slows down to what a frame actually costs while that's more than the target frame rate allows,
+	// and down to IDLE_FRAME_RATE while nothing gets drawn; back to the target as soon as something gets drawn
+	void SetAdaptiveFrameRate(bool Enabled)
+	{
+		m_IsAdaptiveFrameRate = Enabled;
+
+		m_FrameInterval = m_TargetFrameInterval;
+	}
+
+	// Changing the palette retransmits the whole screen, without rendering anything, which is all a palette animation takes
+	// Colors drawn afterwards get mapped to the new entries, the indices already in the frame buffer stay as they are
+	void SetPaletteColor(uint8 Index, Color Color)
+	{
+		ASSERT(m_FrameBufferMode == FrameBufferModes::Palette, "Only Palette mode has a palette");
+
+		m_Palette[Index] = ToFrameBufferOrder(Color.R5G6B5());
+
+		OnPaletteChanged();
+	}
+
+	// Count entries from the first one, the rest keep their colors
+	void SetPalette(const Color *Colors, uint16 Count)
+	{
+		ASSERT(m_FrameBufferMode == FrameBufferModes::Palette, "Only Palette mode has a palette");
+		ASSERT(Colors != nullptr, "Colors cannot be null");
+		ASSERT(Count <= PALETTE_SIZE, "Count is out of the palette");
+
+		for (uint16 i = 0; i < Count; ++i)
+			m_Palette[i] = ToFrameBufferOrder(Colors[i].R5G6B5());
+
+		OnPaletteChanged();
+	}
+
+	Color GetPaletteColor(uint8 Index) const
+	{
+		const uint16 value = ToFrameBufferOrder(m_Palette[Index]);
+
+		return {static_cast<uint8>((((value >> 11) & 0x1F) * 255) / 31),
+				static_cast<uint8>((((value >> 5) & 0x3F) * 255) / 63),
+				static_cast<uint8>(((value & 0x1F) * 255) / 31),
+				255};
+	}
+
+	// Dirty tiles are hashed before being transmitted and dropped if they hold the same pixels as the last time they were sent,
+	// so content which gets redrawn every frame, like a static label, costs no transmission
+	void SetSkipUnchangedTiles(bool Enabled)
+	{
+		ASSERT(m_FrameBufferMode != FrameBufferModes::Band, "Band mode has no frame buffer to hash");
+
+		m_IsSkippingUnchangedTiles = Enabled;
+
+		m_TileSignatures.Invalidate();
+	}
+
+	uint32 GetHashedTileCount(void) const
+	{
+		return m_HashedTileCount;
+	}
+
+	uint32 GetSkippedTileCount(void) const
+	{
+		return m_SkippedTileCount;
+	}
+
+	uint32 GetSentTileCount(void) const
+	{
+		return m_SentTileCount;
+	}
+
+	// Large fills, blends and copies go to the DMA2D unit, its threshold can be tuned through it
+	DMA2DAccelerator &GetAccelerator(void)
+	{
+		return m_Accelerator;
+	}
+
+	// The TE output of the panel goes high during its vertical blanking, transmissions wait for it, so a frame whose
+	// data is sent faster than the panel refreshes, like a partial update, is never shown half written
+	// The pin is polled, so Update has to be called more often than the blanking lasts, otherwise the frame gets sent
+	// after TEARING_EFFECT_TIMEOUT
+	void EnableTearingEffectSync(GPIOPins TE)
+	{
+		ASSERT(m_FrameBufferMode != FrameBufferModes::Band, "Band mode transmits while rasterizing, it can't wait for the vertical blanking");
+		ASSERT(!m_IsDMABusy, "Commands cannot be sent during a transmission");
+
+		daisy::GPIO::Config pinConfig;
+		pinConfig.pin = DaisySeedHALBase::GetPin((uint8)TE);
+		pinConfig.mode = daisy::GPIO::Mode::INPUT;
+		pinConfig.pull = daisy::GPIO::Pull::PULLDOWN;
+		m_TE.Init(pinConfig);
+
+		// TEARING EFFECT LINE ON, V-BLANKING ONLY
+		SendCommand(0x35);
+		{
+			uint8 data[1] = {0x00};
+			SendData(data, 1);
+		}
+
+		m_IsTearingEffectSynced = true;
+	}
+
+	void Clear(Color Color) override
+	{
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			m_DisplayList.Clear(Color);
+
+			return;
+		}
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+			std::memset(m_IndexBuffer, ToPaletteIndex(Color.R5G6B5()), FRAME_BUFFER_LENGTH);
+		else
+			m_Accelerator.Fill(m_FrameBuffer, m_Dimension.X, m_Dimension.X, m_Dimension.Y, ToFrameBufferOrder(Color.R5G6B5()));
+
+		m_DirtyTiles.MarkAll();
+	}
+
+	void DrawPixel(Point Position, Color Color) override
+	{
+		PaintPixels(&Position, nullptr, 1, Color);
+	}
+
+	void DrawHorizontalLine(Point Position, uint16 Length, Color Color) override
+	{
+		DrawFilledRectangle({Position.X, Position.Y, Length, 1}, Color);
+	}
+
+	void DrawVerticalLine(Point Position, uint16 Length, Color Color) override
+	{
+		DrawFilledRectangle({Position.X, Position.Y, 1, Length}, Color);
+	}
+
+	void DrawFilledRectangle(Rect Rect, Color Color) override
+	{
+		const Point &position = Rect.Position;
+		if (position.X >= m_Dimension.X || position.Y >= m_Dimension.Y)
+			return;
+
+		uint16 width = Math::Min<uint16>(Rect.Dimension.X, m_Dimension.X - position.X);
+		uint16 height = Math::Min<uint16>(Rect.Dimension.Y, m_Dimension.Y - position.Y);
+		if (width == 0 || height == 0)
+			return;
+
+		if (m_ScrollAxis == ScrollAxes::Horizontal)
+			ForEachBufferPiece(position.X, width, [&](uint16 PieceX, uint16 Offset, uint16 PieceWidth)
+							   { FillRectangle(PieceX, position.Y, PieceWidth, height, Color); });
+		else
+			ForEachBufferPiece(position.Y, height, [&](uint16 PieceY, uint16 Offset, uint16 PieceHeight)
+							   { FillRectangle(position.X, PieceY, width, PieceHeight, Color); });
+	}
+
+	void BlendHorizontalLine(Point Position, const uint8 *Alphas, uint16 Length, Color Color) override
+	{
+		if (Position.X >= m_Dimension.X || Position.Y >= m_Dimension.Y)
+			return;
+
+		Length = Math::Min<uint16>(Length, m_Dimension.X - Position.X);
+		if (Length == 0)
+			return;
+
+		ForEachBufferRowPiece(Position, Length, [&](Point Piece, uint16 Offset, uint16 PieceLength)
+							  { BlendRow(Piece, Alphas + Offset, PieceLength, Color); });
+	}
+
+	void DrawPixels(const Point *Positions, uint16 Count, Color Color) override
+	{
+		PaintPixels(Positions, nullptr, Count, Color);
+	}
+
+	void BlendPixels(const Point *Positions, const uint8 *Alphas, uint16 Count, Color Color) override
+	{
+		PaintPixels(Positions, Alphas, Count, Color);
+	}
+
+	void DrawRow(Point Position, const uint16 *R5G6B5, uint16 Length) override
+	{
+		if (Position.X >= m_Dimension.X || Position.Y >= m_Dimension.Y)
+			return;
+
+		Length = Math::Min<uint16>(Length, m_Dimension.X - Position.X);
+		if (Length == 0)
+			return;
+
+		ForEachBufferRowPiece(Position, Length, [&](Point Piece, uint16 Offset, uint16 PieceLength)
+							  { CopyRow(Piece, R5G6B5 + Offset, PieceLength); });
+	}
+
+	const Point &GetDimension(void) const override
+	{
+		return m_Dimension;
+	}
+
+	// The panel scrolls along its own lines, which run across the screen in the landscape orientations
+	ScrollAxes GetScrollAxis(void) const override
+	{
+		return m_ScrollAxis;
+	}
+
+	// The frame buffer keeps the region as a ring, so drawing goes on in screen coordinates
+	// Scrolling is sent to the panel right before the data of the frame
+	void SetScrollRegion(uint16 Start, uint16 Length) override
+	{
+		ASSERT(Start + Length <= GetScrollAxisLength(), "Scroll region is out of the screen");
+
+		m_Scroll = {Start, Length, 0};
+	}
+
+	void Scroll(uint16 Lines) override
+	{
+		ASSERT(m_Scroll.Length != 0, "Scroll region is not set");
+
+		if (m_Scroll.Length == 0)
+			return;
+
+		m_Scroll.Offset = (m_Scroll.Offset + Lines) % m_Scroll.Length;
+	}
+
+private:
+	// Alphas of nullptr draws the pixels with the alpha of Color, the color gets converted once for all of them
+	void PaintPixels(const Point *Positions, const uint8 *Alphas, uint16 Count, Color Color)
+	{
+		const uint16 r5g6b5 = Color.R5G6B5();
+
+		const bool isBand = (m_FrameBufferMode == FrameBufferModes::Band);
+		const bool isPalette = (m_FrameBufferMode == FrameBufferModes::Palette);
+		const uint16 value = (isPalette ? ToPaletteIndex(r5g6b5) : ToFrameBufferOrder(r5g6b5));
+
+		if (!isBand && !isPalette)
+			m_Accelerator.Wait();
+
+		for (uint16 i = 0; i < Count; ++i)
+		{
+			const uint8 alpha = (Alphas == nullptr ? Color.A : RGB565Kernels::ScaleAlpha(Alphas[i], Color.A));
+			if (alpha == 0 || Positions[i].X >= m_Dimension.X || Positions[i].Y >= m_Dimension.Y)
+				continue;
+
+			const Point position = ToBufferPosition(Positions[i]);
+
+			if (isBand)
+			{
+				m_DisplayList.AddFillRectangle({position.X, position.Y, 1, 1}, {Color.R, Color.G, Color.B, alpha});
+
+				continue;
+			}
+
+			const uint32 index = position.X + (position.Y * m_Dimension.X);
+
+			if (isPalette)
+			{
+				if (alpha == 255)
+					m_IndexBuffer[index] = static_cast<uint8>(value);
+				else
+					BlendIndex(m_IndexBuffer + index, r5g6b5, alpha);
+			}
+			else if (alpha == 255)
+				m_FrameBuffer[index] = value;
+			else
+				BlendPixel(m_FrameBuffer + index, r5g6b5, alpha);
+
+			m_DirtyTiles.Mark(position.X, position.Y);
+		}
+	}
+
+	void FillRectangle(uint16 X, uint16 Y, uint16 RectWidth, uint16 RectHeight, Color Color)
+	{
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			m_DisplayList.AddFillRectangle({X, Y, RectWidth, RectHeight}, Color);
+
+			return;
+		}
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+			PaintIndexRectangle(X, Y, RectWidth, RectHeight, Color.R5G6B5(), Color.A);
+		else
+			PaintRectangle(m_FrameBuffer, X, Y, RectWidth, RectHeight, Color.R5G6B5(), Color.A);
+
+		m_DirtyTiles.MarkRect(X, Y, X + RectWidth - 1, Y + RectHeight - 1);
+	}
+
+	void BlendRow(Point Position, const uint8 *Alphas, uint16 Length, Color Color)
+	{
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			m_DisplayList.AddBlendRow(Position, Alphas, Length, Color);
+
+			return;
+		}
+
+		const uint32 index = Position.X + (Position.Y * m_Dimension.X);
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+		{
+			for (uint16 i = 0; i < Length; ++i)
+				BlendIndex(m_IndexBuffer + index + i, Color.R5G6B5(), RGB565Kernels::ScaleAlpha(Alphas[i], Color.A));
+		}
+		else
+			BlendSpan(m_FrameBuffer + index, Alphas, Length, Color.R5G6B5(), Color.A);
+
+		m_DirtyTiles.MarkRect(Position.X, Position.Y, Position.X + Length - 1, Position.Y);
+	}
+
+	void CopyRow(Point Position, const uint16 *R5G6B5, uint16 Length)
+	{
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			m_DisplayList.AddCopyRow(Position, R5G6B5, Length);
+
+			return;
+		}
+
+		const uint32 index = Position.X + (Position.Y * m_Dimension.X);
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+		{
+			for (uint16 i = 0; i < Length; ++i)
+				m_IndexBuffer[index + i] = ToPaletteIndex(R5G6B5[i]);
+		}
+		else
+			CopySpan(m_FrameBuffer + index, R5G6B5, Length);
+
+		m_DirtyTiles.MarkRect(Position.X, Position.Y, Position.X + Length - 1, Position.Y);
+	}
+
+	uint16 GetScrollAxisLength(void) const
+	{
+		return (m_ScrollAxis == ScrollAxes::Horizontal ? m_Dimension.X : m_Dimension.Y);
+	}
+
+	// Line of the frame buffer holding the given line of the screen, along the scroll axis
+	uint16 ToBufferLine(uint16 Line) const
+	{
+		if (m_Scroll.Offset == 0 || Line < m_Scroll.Start || Line >= m_Scroll.Start + m_Scroll.Length)
+			return Line;
+
+		uint16 line = Line + m_Scroll.Offset;
+		if (line >= m_Scroll.Start + m_Scroll.Length)
+			line -= m_Scroll.Length;
+
+		return line;
+	}
+
+	Point ToBufferPosition(Point Position) const
+	{
+		if (m_ScrollAxis == ScrollAxes::Horizontal)
+			return {ToBufferLine(Position.X), Position.Y};
+
+		return {Position.X, ToBufferLine(Position.Y)};
+	}
+
+	// Calls Handler(BufferStart, Offset, Length) for the pieces of the lines [Start, Start + Length) along the scroll axis,
+	// the part inside the scroll region may wrap around the ring, so it can take two pieces
+	template <typename PieceHandler>
+	void ForEachBufferPiece(uint16 Start, uint16 Length, PieceHandler Handler)
+	{
+		const uint16 end = Start + Length;
+		const uint16 regionEnd = m_Scroll.Start + m_Scroll.Length;
+
+		if (m_Scroll.Offset == 0 || end <= m_Scroll.Start || regionEnd <= Start)
+		{
+			Handler(Start, 0, Length);
+
+			return;
+		}
+
+		uint16 line = Start;
+		if (line < m_Scroll.Start)
+		{
+			Handler(line, 0, m_Scroll.Start - line);
+
+			line = m_Scroll.Start;
+		}
+
+		const uint16 insideEnd = Math::Min(end, regionEnd);
+		while (line < insideEnd)
+		{
+			const uint16 bufferLine = ToBufferLine(line);
+			const uint16 length = Math::Min<uint16>(insideEnd - line, regionEnd - bufferLine);
+
+			Handler(bufferLine, line - Start, length);
+
+			line += length;
+		}
+
+		if (line < end)
+			Handler(line, line - Start, end - line);
+	}
+
+	template <typename PieceHandler>
+	void ForEachBufferRowPiece(Point Position, uint16 Length, PieceHandler Handler)
+	{
+		if (m_ScrollAxis != ScrollAxes::Horizontal)
+		{
+			Handler(Point(Position.X, ToBufferLine(Position.Y)), 0, Length);
+
+			return;
+		}
+
+		ForEachBufferPiece(Position.X, Length, [&](uint16 PieceX, uint16 Offset, uint16 PieceLength)
+						   { Handler(Point(PieceX, Position.Y), Offset, PieceLength); });
+	}
+
+	// Called while the DMA is idle, before the data of the frame gets sent
+	void ApplyScroll(void)
+	{
+		const bool isRegionChanged = (m_Scroll.Start != m_PanelScroll.Start || m_Scroll.Length != m_PanelScroll.Length);
+		if (!isRegionChanged && m_Scroll.Offset == m_PanelScroll.Offset)
+			return;
+
+		const uint16 lineCount = GetScrollAxisLength();
+
+		uint16 top = m_Scroll.Start;
+		uint16 height = m_Scroll.Length;
+		uint16 offset = m_Scroll.Offset;
+		if (height == 0)
+		{
+			top = 0;
+			height = lineCount;
+		}
+
+		// The lines of the panel run the other way around
+		if (m_IsScrollAxisReversed)
+		{
+			top = lineCount - top - height;
+			offset = (height - offset) % height;
+		}
+
+		if (isRegionChanged)
+		{
+			const uint16 bottom = lineCount - top - height;
+
+			// VERTICAL SCROLLING DEFINITION
+			SendCommand(0x33);
+			{
+				uint8 data[6] = {static_cast<uint8>((top >> 8) & 0xFF),
+								 static_cast<uint8>(top & 0xFF),
+								 static_cast<uint8>((height >> 8) & 0xFF),
+								 static_cast<uint8>(height & 0xFF),
+								 static_cast<uint8>((bottom >> 8) & 0xFF),
+								 static_cast<uint8>(bottom & 0xFF)};
+				SendData(data, 6);
+			}
+		}
+
+		// VERTICAL SCROLLING START ADDRESS
+		SendCommand(0x37);
+		{
+			const uint16 address = top + offset;
+
+			uint8 data[2] = {static_cast<uint8>((address >> 8) & 0xFF),
+							 static_cast<uint8>(address & 0xFF)};
+			SendData(data, 2);
+		}
+
+		m_PanelScroll = m_Scroll;
+	}
+
+private:
+	// Copies the back buffer into the front buffer
+	void Present(void)
+	{
+		Rect region;
+		while (m_DirtyTiles.PopRegion(region))
+		{
+			const Point &position = region.Position;
+			const Point &dimension = region.Dimension;
+
+			uint32 index = position.X + (position.Y * m_Dimension.X);
+
+			m_Accelerator.CopyRectangle<true>(m_FrameBuffer + index, m_Dimension.X, m_FrontBuffer + index, m_Dimension.X, dimension.X, dimension.Y);
+
+			m_FrontDirtyTiles.MarkRect(position.X, position.Y, position.X + dimension.X - 1, position.Y + dimension.Y - 1);
+		}
+	}
+
+	void StartTransmission(uint32 Time)
+	{
+		m_IsFramePending = false;
+
+		if (m_FrameBufferMode == FrameBufferModes::Double)
+			Present();
+
+		// The frame has to be complete before it gets hashed and sent
+		m_Accelerator.Wait();
+
+		ApplyScroll();
+
+		if (m_IsSkippingUnchangedTiles)
+			DropUnchangedTiles();
+
+		m_TransmitStartTime = Time;
+		m_IsTransmitting = true;
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+			UpdateLineBuffers();
+		else
+			UpdateDataDMA();
+	}
+
+	// Buffer lines are sent to the same panel lines whatever the scroll is, so the signatures stay valid across scrolling
+	void DropUnchangedTiles(void)
+	{
+		if (m_AreTileSignaturesLost)
+		{
+			m_AreTileSignaturesLost = false;
+
+			m_TileSignatures.Invalidate();
+		}
+
+		m_TransmitTiles->Filter([&](uint16 Column, uint16 Row)
+								{ return IsTileChanged(Column, Row); });
+	}
+
+	bool IsTileChanged(uint16 Column, uint16 Row)
+	{
+		++m_HashedTileCount;
+
+		bool isChanged;
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+			isChanged = m_TileSignatures.Update(m_IndexBuffer, Column, Row);
+		else
+			isChanged = m_TileSignatures.Update(m_FrontBuffer, Column, Row);
+
+		if (!isChanged)
+		{
+			++m_SkippedTileCount;
+
+			return false;
+		}
+
+		++m_SentTileCount;
+
+		return true;
+	}
+
+	// Called from the main loop and the DMA completion
+	void EndTransmission(void)
+	{
+		if (!m_IsTransmitting)
+			return;
+
+		m_TransmitTime = GetTime() - m_TransmitStartTime;
+		m_IsTransmitting = false;
+	}
+
+	// Microseconds, wrapping around every 71 minutes
+	static uint32 GetTime(void)
+	{
+		return daisy::System::GetUs();
+	}
+
+	bool IsTransmissionAllowed(uint32 Time)
+	{
+		if (!m_IsTearingEffectSynced)
+			return true;
+
+		return (m_TE.Read() || Time - m_FramePendingTime >= TEARING_EFFECT_TIMEOUT);
+	}
+
+	// Frames are due on a fixed grid of the frame interval, so the pace doesn't drift with the time Update gets called at
+	bool IsFrameDue(uint32 Time)
+	{
+		if (static_cast<int32>(Time - m_NextUpdateTime) < 0)
+			return false;
+
+		const uint32 missedCount = (Time - m_NextUpdateTime) / m_FrameInterval;
+
+		m_DroppedFrameCount += missedCount;
+		m_NextUpdateTime += (missedCount + 1) * m_FrameInterval;
+
+		return true;
+	}
+
+	void Render(uint32 Time)
+	{
+		m_RenderListener();
+
+		m_RenderTime = GetTime() - Time;
+
+		UpdateFrameRate(Time);
+
+		if (!m_IsAdaptiveFrameRate)
+			return;
+
+		const bool isDirty = (m_FrameBufferMode == FrameBufferModes::Band ? m_DisplayList.GetCount() != 0 || m_DisplayList.IsCleared() : m_DirtyTiles.IsDirty());
+		if (!isDirty)
+		{
+			m_FrameInterval = Math::Min(m_FrameInterval * 2, Math::Max<uint32>(m_TargetFrameInterval, 1000000 / IDLE_FRAME_RATE));
+
+			return;
+		}
+
+		// Rendering and transmission overlap only in Double mode
+		uint32 frameTime = m_RenderTime + m_TransmitTime;
+		if (m_FrameBufferMode == FrameBufferModes::Double)
+			frameTime = Math::Max(m_RenderTime, m_TransmitTime);
+
+		m_FrameInterval = Math::Max(m_TargetFrameInterval, frameTime);
+	}
+
+	void UpdateBandMode(void)
+	{
+		if (IsBandFrameInProgress())
+		{
+			UpdateBands();
+
+			EndBandFrame();
+
+			return;
+		}
+
+		// The rest of a frame which didn't fit the display list
+		if (m_NextPassBand != 0)
+		{
+			RenderBandPass(m_BandCount - m_NextPassBand);
+
+			UpdateBands();
+
+			EndBandFrame();
+
+			return;
+		}
+
+		uint32 time = GetTime();
+		if (!IsFrameDue(time))
+			return;
+
+		m_LastFrameBandMask = m_BandMask;
+		m_BandMask = 0;
+
+		// A failed transfer leaves the panel with whatever it got of the last frame
+		if (m_AreBandsLost)
+		{
+			m_LastFrameBandMask = static_cast<uint32>((1ULL << m_BandCount) - 1);
+			m_AreBandsLost = false;
+		}
+
+		m_DisplayList.Reset(0, m_Dimension.Y);
+
+		Render(time);
+
+		ApplyScroll();
+
+		m_TransmitStartTime = time;
+		m_IsTransmitting = true;
+
+		if (m_DisplayList.HasOverflowed())
+			RenderBandPass(Math::Max(m_BandCount / 2, 1));
+		else
+			BeginBands(0, m_BandCount);
+
+		UpdateBands();
+
+		EndBandFrame();
+	}
+
+	// Renders the frame again for BandCount bands from m_NextPassBand on, halving them until the display list doesn't overflow
+	void RenderBandPass(uint8 BandCount)
+	{
+		const uint8 firstBand = m_NextPassBand;
+
+		while (true)
+		{
+			m_DisplayList.Reset(firstBand * BAND_HEIGHT, (firstBand + BandCount) * BAND_HEIGHT);
+
+			m_RenderListener();
+
+			if (!m_DisplayList.HasOverflowed() || BandCount == 1)
+				break;
+
+			BandCount /= 2;
+		}
+
+		const uint8 lastBand = firstBand + BandCount;
+
+		m_NextPassBand = (lastBand == m_BandCount ? 0 : lastBand);
+
+		BeginBands(firstBand, lastBand);
+	}
+
+	// Called once the bands are sent, unless more passes of the frame are left
+	void EndBandFrame(void)
+	{
+		if (IsBandFrameInProgress() || m_NextPassBand != 0)
+			return;
+
+		EndTransmission();
+	}
+
+	void UpdateFrameRate(uint32 Time)
+	{
+		++m_FrameCount;
+
+		if (Time - m_FrameRateWindowStartTime < 1000000)
+			return;
+
+		m_AchievedFrameRate = Math::Min<uint32>(static_cast<uint64>(m_FrameCount) * 1000000 / (Time - m_FrameRateWindowStartTime), 255);
+
+		m_FrameCount = 0;
+		m_FrameRateWindowStartTime = Time;
+	}
+
+	// Buffer holds full rows starting at row 0, either the frame buffer or a band strip
+	void PaintRectangle(uint16 *Buffer, uint16 X, uint16 Y, uint16 RectWidth, uint16 RectHeight, uint16 R5G6B5, uint8 Alpha)
+	{
+		uint16 *pixel = Buffer + X + (Y * m_Dimension.X);
+
+		if (RectWidth == 1)
+		{
+			PaintSpan(pixel, RectHeight, m_Dimension.X, R5G6B5, Alpha);
+
+			return;
+		}
+
+		if (m_IsFrameBufferSwapped)
+			m_Accelerator.Blend<true>(pixel, m_Dimension.X, RectWidth, RectHeight, R5G6B5, Alpha);
+		else
+			m_Accelerator.Blend<false>(pixel, m_Dimension.X, RectWidth, RectHeight, R5G6B5, Alpha);
+	}
+
+	void PaintSpan(uint16 *Pixel, uint16 Length, uint16 Step, uint16 R5G6B5, uint8 Alpha)
+	{
+		if (Alpha == 0)
+			return;
+
+		m_Accelerator.Wait();
+
+		if (Step == 1)
+		{
+			if (m_IsFrameBufferSwapped)
+				RGB565Kernels::Blend<true>(Pixel, R5G6B5, Alpha, Length);
+			else
+				RGB565Kernels::Blend<false>(Pixel, R5G6B5, Alpha, Length);
+
+			return;
+		}
+
+		if (Alpha == 255)
+		{
+			uint16 color = ToFrameBufferOrder(R5G6B5);
+
+			for (uint16 i = 0; i < Length; ++i, Pixel += Step)
+				*Pixel = color;
+
+			return;
+		}
+
+		for (uint16 i = 0; i < Length; ++i, Pixel += Step)
+			BlendPixel(Pixel, R5G6B5, Alpha);
+	}
+
+	void BlendPixel(uint16 *Pixel, uint16 R5G6B5, uint8 Alpha)
+	{
+		if (m_IsFrameBufferSwapped)
+			RGB565Kernels::BlendPixel<true>(Pixel, R5G6B5, Alpha);
+		else
+			RGB565Kernels::BlendPixel<false>(Pixel, R5G6B5, Alpha);
+	}
+
+	void BlendSpan(uint16 *Pixel, const uint8 *Alphas, uint16 Length, uint16 R5G6B5, uint8 Alpha)
+	{
+		m_Accelerator.Wait();
+
+		if (m_IsFrameBufferSwapped)
+			RGB565Kernels::BlendAlphas<true>(Pixel, Alphas, R5G6B5, Alpha, Length);
+		else
+			RGB565Kernels::BlendAlphas<false>(Pixel, Alphas, R5G6B5, Alpha, Length);
+	}
+
+	void CopySpan(uint16 *Pixel, const uint16 *R5G6B5, uint16 Length)
 	{
-		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+		m_Accelerator.Wait();
+
+		if (m_IsFrameBufferSwapped)
+			RGB565Kernels::Copy<true>(R5G6B5, Pixel, Length);
+		else
+			RGB565Kernels::Copy<false>(R5G6B5, Pixel, Length);
 	}
 
-	void Initialize(void)
+	void PaintIndexRectangle(uint16 X, uint16 Y, uint16 RectWidth, uint16 RectHeight, uint16 R5G6B5, uint8 Alpha)
 	{
-		m_FrameBuffer = Memory::Allocate<uint16>(FRAME_BUFFER_LENGTH, true);
-		m_FrameBufferDirty = Memory::Allocate<bool>(FRAME_BUFFER_CHUNK_COUNT, true);
+		if (Alpha == 0)
+			return;
 
-		InitializeSPI(m_PinSCLK, m_PinMOSI, m_PinNSS, m_PinDC, m_PinRST);
+		uint8 *index = m_IndexBuffer + X + (Y * m_Dimension.X);
 
-		InitDriver(m_Orientation);
+		if (Alpha == 255)
+		{
+			const uint8 value = ToPaletteIndex(R5G6B5);
 
-		SetTargetFrameRate(MAX_FRAME_RATE);
+			for (uint16 y = 0; y < RectHeight; ++y, index += m_Dimension.X)
+				std::memset(index, value, RectWidth);
+
+			return;
+		}
+
+		for (uint16 y = 0; y < RectHeight; ++y, index += m_Dimension.X)
+			for (uint16 x = 0; x < RectWidth; ++x)
+				BlendIndex(index + x, R5G6B5, Alpha);
 	}
 
-	void SetOnRender(RenderEventHandler Listener)
+	// Blends with the color of the index, then takes the nearest entry to the result
+	void BlendIndex(uint8 *Index, uint16 R5G6B5, uint8 Alpha)
 	{
-		m_RenderListener = Listener;
+		if (Alpha == 0)
+			return;
+
+		if (Alpha != 255)
+			R5G6B5 = RGB565Kernels::BlendPixel(R5G6B5, ToFrameBufferOrder(m_Palette[*Index]), Alpha);
+
+		*Index = ToPaletteIndex(R5G6B5);
 	}
 
-	void Update(void) override
+	uint8 ToPaletteIndex(uint16 R5G6B5)
+	{
+		PaletteCacheEntry &entry = m_PaletteCache[(R5G6B5 ^ (R5G6B5 >> 5) ^ (R5G6B5 >> 11)) % PALETTE_CACHE_SIZE];
+		if (entry.IsValid && entry.R5G6B5 == R5G6B5)
+			return entry.Index;
+
+		entry.R5G6B5 = R5G6B5;
+		entry.Index = FindNearestPaletteIndex(R5G6B5);
+		entry.IsValid = true;
+
+		return entry.Index;
+	}
+
+	// Distance over 6-bit channels
+	uint8 FindNearestPaletteIndex(uint16 R5G6B5) const
+	{
+		const int16 r = (R5G6B5 >> 10) & 0x3E;
+		const int16 g = (R5G6B5 >> 5) & 0x3F;
+		const int16 b = (R5G6B5 << 1) & 0x3E;
+
+		uint8 nearest = 0;
+		uint32 nearestDistance = 0xFFFFFFFF;
+
+		for (uint16 i = 0; i < PALETTE_SIZE; ++i)
+		{
+			const uint16 value = ToFrameBufferOrder(m_Palette[i]);
+
+			const int16 deltaR = ((value >> 10) & 0x3E) - r;
+			const int16 deltaG = ((value >> 5) & 0x3F) - g;
+			const int16 deltaB = ((value << 1) & 0x3E) - b;
+
+			const uint32 distance = (deltaR * deltaR) + (deltaG * deltaG) + (deltaB * deltaB);
+			if (distance >= nearestDistance)
+				continue;
+
+			nearest = i;
+			nearestDistance = distance;
+
+			if (distance == 0)
+				break;
+		}
+
+		return nearest;
+	}
+
+	// R3G3B2, so drawing works before a palette is set
+	void SetDefaultPalette(void)
 	{
-		if (m_IsDMABusy)
+		for (uint16 i = 0; i < PALETTE_SIZE; ++i)
+		{
+			const Color color = {static_cast<uint8>((((i >> 5) & 0x07) * 255) / 7),
+								 static_cast<uint8>((((i >> 2) & 0x07) * 255) / 7),
+								 static_cast<uint8>(((i & 0x03) * 255) / 3),
+								 255};
+
+			m_Palette[i] = ToFrameBufferOrder(color.R5G6B5());
+		}
+
+		OnPaletteChanged();
+	}
+
+	void OnPaletteChanged(void)
+	{
+		for (PaletteCacheEntry &entry : m_PaletteCache)
+			entry.IsValid = false;
+
+		m_DirtyTiles.MarkAll();
+		m_TileSignatures.Invalidate();
+	}
+
+	// Main loop, expands the next rows of the dirty regions into the free line buffers, the DMA completion sends them
+	// Expanding isn't done in the interrupt, so it stays short, but the transmission only goes on as often as Update gets called
+	void UpdateLineBuffers(void)
+	{
+		// A failed transfer drops the rest of the frame, the next one gets sent as a whole
+		if (m_AreLinesLost)
+		{
+			m_AreLinesLost = false;
+
+			for (uint8 i = 0; i < LINE_BUFFER_COUNT; ++i)
+				m_LineBufferLengths[i] = 0;
+
+			m_ExpandingLineBuffer = 0;
+			m_TransmittingLineBuffer = 0;
+
+			m_TransmitTiles->MarkAll();
+			m_AreTileSignaturesLost = true;
+			m_DirtyRegionRow = m_DirtyRegion.Dimension.Y;
+
+			EndTransmission();
+
 			return;
+		}
+
+		bool hasRows = true;
+		while (hasRows && m_LineBufferLengths[m_ExpandingLineBuffer] == 0)
+		{
+			hasRows = ExpandNextRows(m_ExpandingLineBuffer);
 
-		uint32 time = m_HAL->GetTimeSinceStartupMs();
-		if (time < m_NextUpdateTime)
+			if (hasRows)
+				m_ExpandingLineBuffer = (m_ExpandingLineBuffer + 1) % LINE_BUFFER_COUNT;
+		}
+
+		// The DMA ran out of expanded rows
+		if (!m_IsDMABusy)
+			TransmitNextLines();
+
+		if (hasRows || m_IsDMABusy)
 			return;
-		m_NextUpdateTime = time + m_UpdateStep;
 
-		m_RenderListener();
+		for (uint8 i = 0; i < LINE_BUFFER_COUNT; ++i)
+			if (m_LineBufferLengths[i] != 0)
+				return;
 
-		UpdateDataDMA();
+		EndTransmission();
 	}
 
-	void SetTargetFrameRate(uint8 Value)
+	// Returns false once every dirty region has been expanded
+	bool ExpandNextRows(uint8 LineBuffer)
 	{
-		ASSERT(Value != 0, "Invalid Value %f", Value);
+		Rect window = {};
 
-		m_TargetFrameRate = Math::Min(MAX_FRAME_RATE, Value);
+		if (m_DirtyRegionRow == m_DirtyRegion.Dimension.Y)
+		{
+			if (!m_TransmitTiles->PopRegion(m_DirtyRegion))
+				return false;
+
+			m_DirtyRegionRow = 0;
+			m_DirtyRegionRowsPerTransfer = LINE_BUFFER_LENGTH / m_DirtyRegion.Dimension.X;
+
+			window = m_DirtyRegion;
+		}
 
-		m_UpdateStep = 1000 / m_TargetFrameRate;
+		const uint16 rowCount = Math::Min<uint16>(m_DirtyRegionRowsPerTransfer, m_DirtyRegion.Dimension.Y - m_DirtyRegionRow);
+		const uint16 width = m_DirtyRegion.Dimension.X;
+
+		const uint8 *indices = m_IndexBuffer + m_DirtyRegion.Position.X + ((m_DirtyRegion.Position.Y + m_DirtyRegionRow) * m_Dimension.X);
+		uint16 *pixel = m_LineBuffers[LineBuffer];
+
+		for (uint16 i = 0; i < rowCount; ++i, indices += m_Dimension.X, pixel += width)
+			RGB565Kernels::Expand(indices, m_Palette, pixel, width);
+
+		const uint32 length = width * rowCount * sizeof(uint16);
+
+		dsy_dma_clear_cache_for_buffer(reinterpret_cast<uint8 *>(m_LineBuffers[LineBuffer]), length);
+
+		m_DirtyRegionRow += rowCount;
+
+		m_LineBufferWindows[LineBuffer] = window;
+
+		// Hands the line buffer over to the DMA completion
+		m_LineBufferLengths[LineBuffer] = length;
+
+		return true;
 	}
 
-	uint8 GetTargetFrameRate(void) const
+	// Called from the main loop and the DMA completion, sends the expanded line buffers in order one transfer at a time,
+	// the address window first for the ones starting a dirty region
+	void TransmitNextLines(void)
 	{
-		return m_TargetFrameRate;
+		if (m_WindowStep != WINDOW_STEP_COUNT)
+		{
+			SendWindowStep();
+
+			return;
+		}
+
+		// Left for UpdateLineBuffers to drop
+		if (m_AreLinesLost)
+			return;
+
+		const uint8 lineBuffer = m_TransmittingLineBuffer;
+
+		const uint32 length = m_LineBufferLengths[lineBuffer];
+		if (length == 0)
+			return;
+
+		m_IsDMABusy = true;
+
+		const Rect &window = m_LineBufferWindows[lineBuffer];
+		if (window.Dimension.Y != 0 && !m_IsLineWindowSent)
+		{
+			m_IsLineWindowSent = true;
+
+			BeginWindow(window.Position.X, window.Position.Y, window.Position.X + window.Dimension.X - 1, window.Position.Y + window.Dimension.Y - 1);
+
+			SendWindowStep();
+
+			return;
+		}
+
+		m_IsLineWindowSent = false;
+
+		EnqueueTransfer(reinterpret_cast<uint8 *>(m_LineBuffers[lineBuffer]), length, true);
 	}
 
-	void Clear(Color Color) override
+	// 8-bit SPI sends the high byte of every pixel first, so the buffers DMA reads from hold swapped pixels
+	uint16 ToFrameBufferOrder(uint16 R5G6B5) const
+	{
+		return (m_IsFrameBufferSwapped ? SWAP_ENDIAN_16BIT(R5G6B5) : R5G6B5);
+	}
+
+	// LastBand is exclusive
+	void BeginBands(uint8 FirstBand, uint8 LastBand)
 	{
-		uint16 color = Color.R5G6B5();
+		const uint32 passBandMask = static_cast<uint32>((1ULL << LastBand) - (1ULL << FirstBand));
+
+		uint32 bandMask = 0;
+
+		if (m_DisplayList.IsCleared())
+			bandMask = passBandMask;
+
+		for (uint16 i = 0; i < m_DisplayList.GetCount(); ++i)
+		{
+			const Rect &bounds = m_DisplayList.Get(i).Bounds;
+
+			uint16 firstBand = bounds.Position.Y / BAND_HEIGHT;
+			uint16 lastBand = (bounds.Position.Y + bounds.Dimension.Y - 1) / BAND_HEIGHT;
+
+			for (uint16 band = firstBand; band <= lastBand; ++band)
+				bandMask |= (1UL << band);
+		}
+
+		bandMask &= passBandMask;
 
-		for (uint32 y = 0; y < m_Dimension.Y; ++y)
-			for (uint32 x = 0; x < m_Dimension.X; ++x)
-				m_FrameBuffer[x + (y * m_Dimension.X)] = SWAP_ENDIAN_16BIT(color);
+		m_BandMask |= bandMask;
 
-		Memory::Set(m_FrameBufferDirty, 1, FRAME_BUFFER_CHUNK_COUNT);
+		// Bands drawn in the last frame have to be repainted too, to erase what isn't drawn anymore
+		m_PendingBandMask = (bandMask | m_LastFrameBandMask) & passBandMask;
 	}
 
-	void DrawPixel(Point Position, Color Color) override
+	void UpdateBands(void)
 	{
-		if (Position.X < 0 || Position.Y < 0 ||
-			Position.X >= m_Dimension.X || Position.Y >= m_Dimension.Y)
-			return;
+		if (m_PendingBandMask != 0)
+		{
+			for (uint8 i = 0; i < BAND_STRIP_COUNT; ++i)
+			{
+				if (m_StripBands[i] != NO_BAND)
+					continue;
+
+				uint8 band = __builtin_ctz(m_PendingBandMask);
+				m_PendingBandMask &= ~(1UL << band);
+
+				RasterizeBand(band, m_Strips[i]);
+
+				m_StripBands[i] = band;
 
-		PaintPixel(Position.X, Position.Y, Color.R5G6B5(), Color.A);
+				break;
+			}
+		}
+
+		if (!m_IsDMABusy)
+			TransmitNextBand();
 	}
 
-	const Point &GetDimension(void) const override
+	bool IsBandFrameInProgress(void) const
 	{
-		return m_Dimension;
+		if (m_PendingBandMask != 0 || m_IsDMABusy)
+			return true;
+
+		for (uint8 i = 0; i < BAND_STRIP_COUNT; ++i)
+			if (m_StripBands[i] != NO_BAND)
+				return true;
+
+		return false;
 	}
 
-private:
-	void PaintPixel(uint16 X, uint16 Y, uint16 R5G6B5, uint8 Alpha)
+	void RasterizeBand(uint8 Band, uint16 *Strip)
 	{
-		uint32 index = X + (Y * m_Dimension.X);
+		const uint16 bandY = Band * BAND_HEIGHT;
+		const uint16 bandHeight = Math::Min<uint16>(BAND_HEIGHT, m_Dimension.Y - bandY);
 
-		if (Alpha != 255)
+		m_Accelerator.Fill(Strip, m_Dimension.X, m_Dimension.X, bandHeight, ToFrameBufferOrder(m_DisplayList.GetClearColor().R5G6B5()));
+
+		for (uint16 i = 0; i < m_DisplayList.GetCount(); ++i)
+		{
+			const DisplayList::Command &command = m_DisplayList.Get(i);
+			const Point &position = command.Bounds.Position;
+			const Point &dimension = command.Bounds.Dimension;
+
+			if (position.Y >= bandY + bandHeight || position.Y + dimension.Y <= bandY)
+				continue;
+
+			const uint16 y0 = Math::Max(position.Y, bandY);
+			const uint16 y1 = Math::Min<uint16>(position.Y + dimension.Y, bandY + bandHeight);
+
+			switch (command.Type)
+			{
+			case DisplayList::Types::FillRectangle:
+				PaintRectangle(Strip, position.X, y0 - bandY, dimension.X, y1 - y0, command.Color.R5G6B5(), command.Color.A);
+				break;
+
+			case DisplayList::Types::BlendRow:
+				BlendSpan(Strip + position.X + ((y0 - bandY) * m_Dimension.X), m_DisplayList.GetData(command), dimension.X, command.Color.R5G6B5(), command.Color.A);
+				break;
+
+			case DisplayList::Types::CopyRow:
+				CopySpan(Strip + position.X + ((y0 - bandY) * m_Dimension.X), reinterpret_cast<const uint16 *>(m_DisplayList.GetData(command)), dimension.X);
+				break;
+			}
+		}
+
+		// The strip gets sent right after
+		m_Accelerator.Wait();
+	}
+
+	// Called from the main loop and the DMA completion, sends the rasterized strip of the lowest band
+	// one transfer at a time, the address window first
+	void TransmitNextBand(void)
+	{
+		if (m_WindowStep != WINDOW_STEP_COUNT)
+		{
+			SendWindowStep();
+
+			return;
+		}
+
+		if (m_IsStripWindowSent)
+		{
+			m_IsStripWindowSent = false;
+
+			const uint16 bandY = m_StripBands[m_TransmittingStrip] * BAND_HEIGHT;
+			const uint16 bandHeight = Math::Min<uint16>(BAND_HEIGHT, m_Dimension.Y - bandY);
+
+			uint8 *data = reinterpret_cast<uint8 *>(m_Strips[m_TransmittingStrip]);
+			uint32 length = bandHeight * m_Dimension.X * sizeof(uint16);
+
+			dsy_dma_clear_cache_for_buffer(data, length);
+
+			EnqueueTransfer(data, length, true);
+
+			return;
+		}
+
+		int8 strip = -1;
+		for (uint8 i = 0; i < BAND_STRIP_COUNT; ++i)
 		{
-			uint16 currentColor = SWAP_ENDIAN_16BIT(m_FrameBuffer[index]);
-			R5G6B5 = Color::BlendR5G6B5(R5G6B5, currentColor, Alpha);
+			if (m_StripBands[i] == NO_BAND)
+				continue;
+
+			if (strip == -1 || m_StripBands[i] < m_StripBands[strip])
+				strip = i;
 		}
 
-		m_FrameBuffer[index] = SWAP_ENDIAN_16BIT(R5G6B5);
+		if (strip == -1)
+			return;
+
+		const uint16 bandY = m_StripBands[strip] * BAND_HEIGHT;
+		const uint16 bandHeight = Math::Min<uint16>(BAND_HEIGHT, m_Dimension.Y - bandY);
+
+		m_IsDMABusy = true;
+		m_TransmittingStrip = strip;
+		m_IsStripWindowSent = true;
+
+		BeginWindow(0, bandY, m_Dimension.X - 1, bandY + bandHeight - 1);
 
-		m_FrameBufferDirty[index / FRAME_BUFFER_CHUNK_SIZE] = true;
+		SendWindowStep();
 	}
 
-	void InitializeSPI(GPIOPins SCLK, GPIOPins MOSI, GPIOPins NSS, GPIOPins DC, GPIOPins RST)
+	void InitializeSPI(GPIOPins CS, GPIOPins DC, GPIOPins RST)
 	{
-		daisy::SpiHandle::Config spiConfig;
-		spiConfig.periph = daisy::SpiHandle::Config::Peripheral::SPI_1;
-		spiConfig.mode = daisy::SpiHandle::Config::Mode::MASTER;
-		spiConfig.direction = daisy::SpiHandle::Config::Direction::TWO_LINES_TX_ONLY;
-		spiConfig.clock_polarity = daisy::SpiHandle::Config::ClockPolarity::LOW;
-		spiConfig.baud_prescaler = daisy::SpiHandle::Config::BaudPrescaler::PS_2;
-		spiConfig.clock_phase = daisy::SpiHandle::Config::ClockPhase::ONE_EDGE;
-		spiConfig.nss = daisy::SpiHandle::Config::NSS::HARD_OUTPUT;
-		spiConfig.datasize = 8;
-		spiConfig.pin_config.sclk = DaisySeedHALBase::GetPin((uint8)SCLK);
-		spiConfig.pin_config.mosi = DaisySeedHALBase::GetPin((uint8)MOSI);
-		spiConfig.pin_config.nss = DaisySeedHALBase::GetPin((uint8)NSS);
+		if (m_IsBusOwned)
+		{
+			m_Bus = new (Memory::Allocate<SPIBus>(1, false)) SPIBus();
+			m_Bus->Initialize(daisy::SpiHandle::Config::Peripheral::SPI_1, m_PinSCLK, m_PinMOSI);
+		}
 
-		m_SPI.Init(spiConfig);
+		ASSERT(m_Bus != nullptr, "m_Bus cannot be null");
+
+		SPIBus::DeviceConfig deviceConfig;
+		deviceConfig.ChipSelect = CS;
+		deviceConfig.HasDataCommand = true;
+		deviceConfig.DataCommand = DC;
+		deviceConfig.BaudPrescaler = daisy::SpiHandle::Config::BaudPrescaler::PS_2;
+		deviceConfig.ClockPolarity = daisy::SpiHandle::Config::ClockPolarity::LOW;
+		deviceConfig.ClockPhase = daisy::SpiHandle::Config::ClockPhase::ONE_EDGE;
+
+		m_Device = m_Bus->AddDevice(deviceConfig);
 
 		daisy::GPIO::Config pinConfig;
 		pinConfig.mode = daisy::GPIO::Mode::OUTPUT;
 
-		pinConfig.pin = DaisySeedHALBase::GetPin((uint8)DC);
-		m_DC.Init(pinConfig);
-
 		pinConfig.pin = DaisySeedHALBase::GetPin((uint8)RST);
 		m_RST.Init(pinConfig);
-
-		pinConfig.pin = DaisySeedHALBase::GetPin((uint8)NSS);
-		m_CS.Init(pinConfig);
-		m_CS.Write(0);
 	}
 
 	void InitDriver(Orientations Orientation)
@@ -386,128 +1754,326 @@ private:
 		break;
 		}
 
+		// The panel scrolls along its memory rows, they run along X once MV exchanges rows and columns, and MY reverses them
+		m_ScrollAxis = ((rotationBits & ili_mv) != 0 ? ScrollAxes::Horizontal : ScrollAxes::Vertical);
+		m_IsScrollAxisReversed = ((rotationBits & ili_my) != 0);
+
 		return rotationBits;
 	}
 
 	void SendCommand(uint8 Command)
 	{
-		m_DC.Write(0);
-
-		m_SPI.BlockingTransmit(&Command, 1);
+		m_Bus->BlockingTransmit(m_Device, &Command, 1, false);
 	}
 
 	void SendData(uint8 *Buffer, uint32 Size)
 	{
-		m_DC.Write(1);
-
-		m_SPI.BlockingTransmit(Buffer, Size);
+		m_Bus->BlockingTransmit(m_Device, Buffer, Size, true);
 	}
 
-	void SetAddressWindow(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1)
+	// Prepares the commands of the address window, SendWindowStep sends them
+	void BeginWindow(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1)
 	{
+		uint8 *data = m_WindowCommands;
+
 		// Column address set
-		SendCommand(0x2A); // CASET
-		{
-			uint8 data[4] = {static_cast<uint8>((X0 >> 8) & 0xFF),
-							 static_cast<uint8>(X0 & 0xFF),
-							 static_cast<uint8>((X1 >> 8) & 0xFF),
-							 static_cast<uint8>(X1 & 0xFF)};
-			SendData(data, 4);
-		}
+		*data++ = 0x2A; // CASET
+		*data++ = static_cast<uint8>((X0 >> 8) & 0xFF);
+		*data++ = static_cast<uint8>(X0 & 0xFF);
+		*data++ = static_cast<uint8>((X1 >> 8) & 0xFF);
+		*data++ = static_cast<uint8>(X1 & 0xFF);
 
 		// Row address set
-		SendCommand(0x2B); // RASET
-		{
-			uint8 data[4] = {static_cast<uint8>((Y0 >> 8) & 0xFF),
-							 static_cast<uint8>(Y0 & 0xFF),
-							 static_cast<uint8>((Y1 >> 8) & 0xFF),
-							 static_cast<uint8>(Y1 & 0xFF)};
-			SendData(data, 4);
-		}
+		*data++ = 0x2B; // RASET
+		*data++ = static_cast<uint8>((Y0 >> 8) & 0xFF);
+		*data++ = static_cast<uint8>(Y0 & 0xFF);
+		*data++ = static_cast<uint8>((Y1 >> 8) & 0xFF);
+		*data++ = static_cast<uint8>(Y1 & 0xFF);
 
 		// Write to RAM
-		SendCommand(0x2C); // RAMWR
+		*data++ = 0x2C; // RAMWR
+
+		dsy_dma_clear_cache_for_buffer(m_WindowCommands, WINDOW_COMMANDS_SIZE);
+
+		m_WindowStep = 0;
+	}
+
+	// A transfer which doesn't fit the queue of the bus is kept, Update retries it
+	void EnqueueTransfer(uint8 *Data, uint16 Size, bool IsData)
+	{
+		if (m_Bus->Enqueue(m_Device, Data, Size, IsData, SPIBus::Priorities::Low, &OnDMATransmissionCompleted, this))
+			return;
+
+		m_RetrySize = Size;
+		m_RetryIsData = IsData;
+		m_RetryData = Data;
+	}
+
+	// No completion is coming while a transfer waits for the retry, so this is the only one touching it
+	void RetryTransfer(void)
+	{
+		uint8 *data = m_RetryData;
+		m_RetryData = nullptr;
+
+		EnqueueTransfer(data, m_RetrySize, m_RetryIsData);
+	}
+
+	// Commands are the even steps, they're sent with DC low
+	void SendWindowStep(void)
+	{
+		static constexpr uint8 OFFSETS[WINDOW_STEP_COUNT] = {0, 1, 5, 6, 10};
+		static constexpr uint8 LENGTHS[WINDOW_STEP_COUNT] = {1, 4, 1, 4, 1};
+
+		const uint8 step = m_WindowStep++;
+
+		EnqueueTransfer(m_WindowCommands + OFFSETS[step], LENGTHS[step], (step & 1) != 0);
 	}
 
+	// Started from the main loop, then advanced by every DMA completion, one transfer at a time
 	void UpdateDataDMA(void)
 	{
-		bool found = false;
-		for (uint8 i = m_LastFrameBufferDirtyIndex; i < FRAME_BUFFER_CHUNK_COUNT; ++i)
+		if (m_WindowStep != WINDOW_STEP_COUNT)
 		{
-			if (!m_FrameBufferDirty[i])
-				continue;
+			SendWindowStep();
 
-			m_LastFrameBufferDirtyIndex = i;
-			found = true;
-			break;
+			return;
 		}
 
-		if (!found)
-			return;
+		if (m_DirtyRegionRow == m_DirtyRegion.Dimension.Y)
+		{
+			if (!m_TransmitTiles->PopRegion(m_DirtyRegion))
+			{
+				m_IsDMABusy = false;
+
+				EndTransmission();
+
+				return;
+			}
 
-		const uint16 chunkHeight = FRAME_BUFFER_CHUNK_SIZE / m_Dimension.X;
+			const Point &position = m_DirtyRegion.Position;
+			const Point &dimension = m_DirtyRegion.Dimension;
 
-		const uint16 x0 = 0;
-		const uint16 y0 = m_LastFrameBufferDirtyIndex * chunkHeight;
-		const uint16 x1 = m_Dimension.X - 1;
-		const uint16 y1 = y0 + chunkHeight;
-		SetAddressWindow(x0, y0, x1, y1);
+			m_DirtyRegionRow = 0;
+
+			// Full width regions are contiguous in the frame buffer, others go out row by row
+			m_DirtyRegionRowsPerTransfer = 1;
+			if (dimension.X == m_Dimension.X)
+				m_DirtyRegionRowsPerTransfer = MAX_DMA_TRANSFER_SIZE / (dimension.X * sizeof(uint16));
+
+			m_IsDMABusy = true;
+
+			BeginWindow(position.X, position.Y, position.X + dimension.X - 1, position.Y + dimension.Y - 1);
+
+			SendWindowStep();
+
+			return;
+		}
 
 		m_IsDMABusy = true;
 
-		uint8 *data = reinterpret_cast<uint8 *>(m_FrameBuffer + (m_LastFrameBufferDirtyIndex * FRAME_BUFFER_CHUNK_SIZE));
-		uint32 length = FRAME_BUFFER_CHUNK_SIZE * sizeof(uint16);
+		const uint16 rowCount = Math::Min<uint16>(m_DirtyRegionRowsPerTransfer, m_DirtyRegion.Dimension.Y - m_DirtyRegionRow);
+		const uint32 index = m_DirtyRegion.Position.X + ((m_DirtyRegion.Position.Y + m_DirtyRegionRow) * m_Dimension.X);
 
-		dsy_dma_clear_cache_for_buffer(data, length);
+		uint8 *data = reinterpret_cast<uint8 *>(m_FrontBuffer + index);
+		uint32 length = m_DirtyRegion.Dimension.X * rowCount * sizeof(uint16);
 
-		m_DC.Write(1);
+		m_DirtyRegionRow += rowCount;
 
-		m_SPI.DmaTransmit(data, length, nullptr, &OnDMATransmissionCompleted, this);
+		dsy_dma_clear_cache_for_buffer(data, length);
+
+		EnqueueTransfer(data, length, true);
 	}
 
+	// Interrupt context, nothing in here waits for the SPI
 	static void OnDMATransmissionCompleted(void *Context, daisy::SpiHandle::Result Result)
+	{
+		auto *thisPtr = static_cast<ILI9341_HAL *>(Context);
+
+		const uint32 startTicks = daisy::System::GetTick();
+
+		thisPtr->OnTransferCompleted(Result);
+
+		const uint32 ticks = daisy::System::GetTick() - startTicks;
+		if (ticks > thisPtr->m_MaxInterruptTicks)
+			thisPtr->m_MaxInterruptTicks = ticks;
+	}
+
+	void OnTransferCompleted(daisy::SpiHandle::Result Result)
 	{
 		if (Result != daisy::SpiHandle::Result::OK)
+		{
+			AbortTransmission();
+
 			return;
+		}
 
-		auto *thisPtr = static_cast<ILI9341_HAL *>(Context);
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			// The window or the strip data is still to be sent
+			if (m_WindowStep != WINDOW_STEP_COUNT || m_IsStripWindowSent)
+			{
+				TransmitNextBand();
+
+				return;
+			}
+
+			m_StripBands[m_TransmittingStrip] = NO_BAND;
+			m_IsDMABusy = false;
+
+			TransmitNextBand();
+
+			EndBandFrame();
+
+			return;
+		}
+
+		if (m_FrameBufferMode == FrameBufferModes::Palette)
+		{
+			// The window or the line buffer is still to be sent
+			if (m_WindowStep != WINDOW_STEP_COUNT || m_IsLineWindowSent)
+			{
+				TransmitNextLines();
+
+				return;
+			}
 
-		thisPtr->m_FrameBufferDirty[thisPtr->m_LastFrameBufferDirtyIndex] = false;
+			// Update expands the next rows into it
+			m_LineBufferLengths[m_TransmittingLineBuffer] = 0;
+			m_TransmittingLineBuffer = (m_TransmittingLineBuffer + 1) % LINE_BUFFER_COUNT;
+			m_IsDMABusy = false;
 
-		if (++thisPtr->m_LastFrameBufferDirtyIndex == FRAME_BUFFER_CHUNK_COUNT)
+			TransmitNextLines();
+
+			return;
+		}
+
+		UpdateDataDMA();
+	}
+
+	// Drops the rest of the frame after a failed transfer, the next one gets sent as a whole
+	void AbortTransmission(void)
+	{
+		m_WindowStep = WINDOW_STEP_COUNT;
+
+		if (m_FrameBufferMode == FrameBufferModes::Band)
+		{
+			m_PendingBandMask = 0;
+			for (uint8 i = 0; i < BAND_STRIP_COUNT; ++i)
+				m_StripBands[i] = NO_BAND;
+
+			m_IsStripWindowSent = false;
+			m_NextPassBand = 0;
+			m_AreBandsLost = true;
+		}
+		else if (m_FrameBufferMode == FrameBufferModes::Palette)
 		{
-			thisPtr->m_IsDMABusy = false;
-			thisPtr->m_LastFrameBufferDirtyIndex = 0;
+			// The main loop is expanding from the dirty regions, it drops them and ends the transmission
+			m_IsLineWindowSent = false;
+			m_AreLinesLost = true;
+			m_IsDMABusy = false;
 
 			return;
 		}
+		else
+		{
+			m_TransmitTiles->MarkAll();
+			m_AreTileSignaturesLost = true;
+			m_DirtyRegionRow = m_DirtyRegion.Dimension.Y;
+		}
 
-		thisPtr->UpdateDataDMA();
+		m_IsDMABusy = false;
+
+		EndTransmission();
 	}
 
 private:
 	IHAL *m_HAL;
-	GPIOPins m_PinSCLK, m_PinMOSI, m_PinNSS, m_PinDC, m_PinRST;
+	SPIBus *m_Bus;
+	bool m_IsBusOwned;
+	uint8 m_Device;
+	GPIOPins m_PinSCLK, m_PinMOSI, m_PinCS, m_PinDC, m_PinRST;
 	Orientations m_Orientation;
+	FrameBufferModes m_FrameBufferMode;
+	bool m_IsFrameBufferSwapped;
 
 	RenderEventHandler m_RenderListener;
 
 	uint16 *m_FrameBuffer;
-	bool *m_FrameBufferDirty;
-
-	daisy::SpiHandle m_SPI;
+	uint16 *m_FrontBuffer;
+	DMA2DAccelerator m_Accelerator;
+	uint8 *m_IndexBuffer;
+	uint16 m_Palette[PALETTE_SIZE];
+	PaletteCacheEntry m_PaletteCache[PALETTE_CACHE_SIZE];
+	uint16 *m_LineBuffers[LINE_BUFFER_COUNT];
+	// Bytes expanded into each line buffer and waiting for the DMA, zero once it's free again
+	std::atomic<uint32> m_LineBufferLengths[LINE_BUFFER_COUNT];
+	// Sent before the line buffer when it starts a dirty region, otherwise of zero dimension
+	Rect m_LineBufferWindows[LINE_BUFFER_COUNT];
+	uint8 m_ExpandingLineBuffer;
+	volatile uint8 m_TransmittingLineBuffer;
+	volatile bool m_IsLineWindowSent;
+	volatile bool m_AreLinesLost;
+	DirtyTileMapType m_DirtyTiles;
+	DirtyTileMapType m_FrontDirtyTiles;
+	DirtyTileMapType *m_TransmitTiles;
+	TileSignatureMapType m_TileSignatures;
+	bool m_IsSkippingUnchangedTiles;
+	volatile bool m_AreTileSignaturesLost;
+	uint32 m_HashedTileCount;
+	uint32 m_SkippedTileCount;
+	uint32 m_SentTileCount;
+
+	DisplayList m_DisplayList;
+	uint16 *m_Strips[BAND_STRIP_COUNT];
+	volatile uint8 m_StripBands[BAND_STRIP_COUNT];
+	uint8 m_TransmittingStrip;
+	bool m_IsStripWindowSent;
+	uint8 m_BandCount;
+	uint32 m_BandMask;
+	uint32 m_PendingBandMask;
+	uint32 m_LastFrameBandMask;
+	uint8 m_NextPassBand;
+	volatile bool m_AreBandsLost;
 
 	daisy::GPIO m_RST;
-	daisy::GPIO m_DC;
-	daisy::GPIO m_CS;
+	daisy::GPIO m_TE;
 
 	uint8 m_TargetFrameRate;
 	Point m_Dimension;
 
-	uint16 m_UpdateStep;
+	// Microseconds
+	uint32 m_TargetFrameInterval;
+	uint32 m_FrameInterval;
 	uint32 m_NextUpdateTime;
-	bool m_IsDMABusy;
-	uint8 m_LastFrameBufferDirtyIndex;
+	bool m_IsAdaptiveFrameRate;
+	bool m_IsTearingEffectSynced;
+	// Shared with the DMA completion interrupt, the sequentially consistent accesses order the rest around them
+	std::atomic<bool> m_IsDMABusy;
+	uint8 *m_WindowCommands;
+	volatile uint8 m_WindowStep;
+	uint8 *volatile m_RetryData;
+	uint16 m_RetrySize;
+	bool m_RetryIsData;
+	bool m_IsFramePending;
+	uint32 m_FramePendingTime;
+	Rect m_DirtyRegion;
+	uint16 m_DirtyRegionRow;
+	uint16 m_DirtyRegionRowsPerTransfer;
+
+	uint32 m_FrameCount;
+	uint32 m_FrameRateWindowStartTime;
+	uint8 m_AchievedFrameRate;
+	uint32 m_DroppedFrameCount;
+	uint32 m_RenderTime;
+	uint32 m_TransmitStartTime;
+	volatile uint32 m_TransmitTime;
+	std::atomic<bool> m_IsTransmitting;
+	volatile uint32 m_MaxInterruptTicks;
+
+	ScrollAxes m_ScrollAxis;
+	bool m_IsScrollAxisReversed;
+	ScrollRegion m_Scroll;
+	ScrollRegion m_PanelScroll;
 };
 
 typedef ILI9341_HAL<320, 240> ILI9341_HAL_320_240;
@@ -15,6 +15,13 @@ public:
 		ToLeft
 	};
 
+	enum class ScrollAxes
+	{
+		None = 0,
+		Horizontal,
+		Vertical
+	};
+
 public:
 	virtual void Update(void) = 0;
 
@@ -25,7 +32,41 @@ public:
 
 	virtual void DrawPixel(Point Position, Color Color) = 0;
 
+	virtual void DrawHorizontalLine(Point Position, uint16 Length, Color Color) = 0;
+	virtual void DrawVerticalLine(Point Position, uint16 Length, Color Color) = 0;
+	virtual void DrawFilledRectangle(Rect Rect, Color Color) = 0;
+
+	// Blends Color into the row starting at Position, using one alpha per pixel
+	virtual void BlendHorizontalLine(Point Position, const uint8 *Alphas, uint16 Length, Color Color) = 0;
+
+	// Draws Count scattered pixels, Color gets converted once for all of them
+	virtual void DrawPixels(const Point *Positions, uint16 Count, Color Color) = 0;
+
+	// Blends Color into Count scattered pixels, using one alpha per pixel
+	virtual void BlendPixels(const Point *Positions, const uint8 *Alphas, uint16 Count, Color Color) = 0;
+
+	// Copies Length native R5G6B5 pixels into the row starting at Position
+	virtual void DrawRow(Point Position, const uint16 *R5G6B5, uint16 Length) = 0;
+
 	virtual const Point &GetDimension(void) const = 0;
+
+	// Hardware scrolling is optional, a HAL supporting it scrolls a region of the screen along its scroll axis
+	// without sending the region again, so only the exposed lines have to be drawn and transmitted
+	virtual ScrollAxes GetScrollAxis(void) const
+	{
+		return ScrollAxes::None;
+	}
+
+	// Start and Length are along the scroll axis, a Length of 0 turns scrolling off
+	// The content of the region has to be drawn again afterwards
+	virtual void SetScrollRegion(uint16 Start, uint16 Length)
+	{
+	}
+
+	// Moves the content of the region towards its start by Lines, the last Lines lines of the region are the exposed ones
+	virtual void Scroll(uint16 Lines)
+	{
+	}
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,348 @@
+#pragma once
+#ifndef IMAGE_DECODERS_H
+#define IMAGE_DECODERS_H
+
+#include "Common.h"
+#include "PixelFormats.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+
+// Streaming decoders of Image and Sprite, they hand out one pixel at a time in row order and keep only
+// a few bytes of state, so images get drawn straight from the flash without a decode buffer
+// Read returns the next pixel as R5G6B5 along with its alpha, Skip passes over pixels which are clipped away
+// Decoding stops where the data of a compressed image is shorter than the image, the rest of its pixels are transparent
+
+class RLE565Decoder
+{
+public:
+	RLE565Decoder(const Image &Image)
+		: m_Data(Image.Data),
+		  m_End(Image.Data + Image.Size),
+		  m_Count(0),
+		  m_IsRun(false),
+		  m_Pixel(0),
+		  m_IsTruncated(false)
+	{
+		ASSERT(Image.Format == ImageFormats::RLE565, "Image isn't RLE565");
+	}
+
+	uint16 Read(uint8 &Alpha)
+	{
+		if (m_Count == 0)
+			StartPacket();
+
+		if (m_IsTruncated)
+		{
+			Alpha = 0;
+
+			return 0;
+		}
+
+		Alpha = 255;
+
+		--m_Count;
+
+		if (m_IsRun)
+			return m_Pixel;
+
+		return ReadPixel();
+	}
+
+	// Runs are skipped as a whole
+	void Skip(uint32 Count)
+	{
+		while (Count != 0)
+		{
+			if (m_Count == 0)
+				StartPacket();
+
+			if (m_IsTruncated)
+				return;
+
+			const uint8 count = Math::Min<uint32>(Count, m_Count);
+
+			if (!m_IsRun)
+				m_Data += count * sizeof(uint16);
+
+			m_Count -= count;
+			Count -= count;
+		}
+	}
+
+private:
+	// A literal packet is checked as a whole, so its pixels get read without any checks
+	void StartPacket(void)
+	{
+		if (!HasData(1))
+			return;
+
+		const uint8 header = *m_Data++;
+
+		m_Count = (header & 0x7F) + 1;
+		m_IsRun = ((header & 0x80) != 0);
+
+		if (!HasData(m_IsRun ? sizeof(uint16) : m_Count * sizeof(uint16)))
+			return;
+
+		if (m_IsRun)
+			m_Pixel = ReadPixel();
+	}
+
+	bool HasData(uint32 Size)
+	{
+		if (m_IsTruncated)
+			return false;
+
+		if (static_cast<uint32>(m_End - m_Data) >= Size)
+			return true;
+
+		ASSERT(false, "Data is shorter than the image");
+
+		m_IsTruncated = true;
+		m_Count = 0;
+
+		return false;
+	}
+
+	// Byte by byte, the data has no alignment
+	uint16 ReadPixel(void)
+	{
+		const uint16 value = m_Data[0] | (m_Data[1] << 8);
+
+		m_Data += sizeof(uint16);
+
+		return value;
+	}
+
+private:
+	const uint8 *m_Data;
+	const uint8 *m_End;
+	uint8 m_Count;
+	bool m_IsRun;
+	uint16 m_Pixel;
+	bool m_IsTruncated;
+};
+
+// https://qoiformat.org/qoi-specification.pdf, the colors get reduced to R5G6B5 as they are handed out
+class QOIDecoder
+{
+	static constexpr uint8 HEADER_SIZE = 14;
+	static constexpr uint8 END_MARKER_SIZE = 8;
+	static constexpr uint8 INDEX_SIZE = 64;
+
+	static constexpr uint8 OP_INDEX = 0x00;
+	static constexpr uint8 OP_DIFF = 0x40;
+	static constexpr uint8 OP_LUMA = 0x80;
+	static constexpr uint8 OP_RUN = 0xC0;
+	static constexpr uint8 OP_RGB = 0xFE;
+	static constexpr uint8 OP_RGBA = 0xFF;
+	static constexpr uint8 OP_MASK = 0xC0;
+
+	// Channels wrap around, as the differences are meant to
+	struct Pixel
+	{
+	public:
+		uint8 R;
+		uint8 G;
+		uint8 B;
+		uint8 A;
+	};
+
+public:
+	QOIDecoder(const Image &Image)
+		: m_Data(Image.Data + HEADER_SIZE),
+		  m_End(Image.Size >= HEADER_SIZE + END_MARKER_SIZE ? Image.Data + Image.Size - END_MARKER_SIZE : m_Data),
+		  m_Index{},
+		  m_Pixel{0, 0, 0, 255},
+		  m_RunCount(0),
+		  m_IsTruncated(false)
+	{
+		ASSERT(Image.Format == ImageFormats::QOI, "Image isn't QOI");
+		ASSERT(Image.Size >= HEADER_SIZE + END_MARKER_SIZE, "Image is too short");
+		ASSERT(Image.Data[0] == 'q' && Image.Data[1] == 'o' && Image.Data[2] == 'i' && Image.Data[3] == 'f', "Image isn't QOI");
+	}
+
+	uint16 Read(uint8 &Alpha)
+	{
+		Decode();
+
+		if (m_IsTruncated)
+		{
+			Alpha = 0;
+
+			return 0;
+		}
+
+		Alpha = m_Pixel.A;
+
+		return PixelFormatRGB565::FromRGB(m_Pixel.R, m_Pixel.G, m_Pixel.B);
+	}
+
+	// Every chunk still has to be decoded, as the following ones depend on it, but runs are skipped as a whole
+	void Skip(uint32 Count)
+	{
+		while (Count != 0 && !m_IsTruncated)
+		{
+			if (m_RunCount != 0)
+			{
+				const uint8 count = Math::Min<uint32>(Count, m_RunCount);
+
+				m_RunCount -= count;
+				Count -= count;
+
+				continue;
+			}
+
+			Decode();
+			--Count;
+		}
+	}
+
+private:
+	void Decode(void)
+	{
+		if (m_RunCount != 0)
+		{
+			--m_RunCount;
+
+			return;
+		}
+
+		if (!HasData(1))
+			return;
+
+		const uint8 op = *m_Data++;
+
+		if (!HasData(GetOperandSize(op)))
+			return;
+
+		if (op == OP_RGB)
+		{
+			m_Pixel.R = m_Data[0];
+			m_Pixel.G = m_Data[1];
+			m_Pixel.B = m_Data[2];
+			m_Data += 3;
+		}
+		else if (op == OP_RGBA)
+		{
+			m_Pixel = {m_Data[0], m_Data[1], m_Data[2], m_Data[3]};
+			m_Data += 4;
+		}
+		else
+		{
+			switch (op & OP_MASK)
+			{
+			case OP_INDEX:
+				m_Pixel = m_Index[op];
+				break;
+
+			case OP_DIFF:
+				m_Pixel.R += ((op >> 4) & 0x03) - 2;
+				m_Pixel.G += ((op >> 2) & 0x03) - 2;
+				m_Pixel.B += (op & 0x03) - 2;
+				break;
+
+			case OP_LUMA:
+			{
+				const int8 greenDifference = (op & 0x3F) - 32;
+				const uint8 next = *m_Data++;
+
+				m_Pixel.R += greenDifference - 8 + ((next >> 4) & 0x0F);
+				m_Pixel.G += greenDifference;
+				m_Pixel.B += greenDifference - 8 + (next & 0x0F);
+			}
+			break;
+
+			case OP_RUN:
+				// This pixel is the first one of the run
+				m_RunCount = op & 0x3F;
+				break;
+			}
+		}
+
+		m_Index[((m_Pixel.R * 3) + (m_Pixel.G * 5) + (m_Pixel.B * 7) + (m_Pixel.A * 11)) % INDEX_SIZE] = m_Pixel;
+	}
+
+	// Bytes following the op
+	static uint8 GetOperandSize(uint8 Op)
+	{
+		if (Op == OP_RGB)
+			return 3;
+
+		if (Op == OP_RGBA)
+			return 4;
+
+		return ((Op & OP_MASK) == OP_LUMA ? 1 : 0);
+	}
+
+	bool HasData(uint32 Size)
+	{
+		if (m_IsTruncated)
+			return false;
+
+		if (static_cast<uint32>(m_End - m_Data) >= Size)
+			return true;
+
+		ASSERT(false, "Data is shorter than the image");
+
+		m_IsTruncated = true;
+
+		return false;
+	}
+
+private:
+	const uint8 *m_Data;
+	const uint8 *m_End;
+	Pixel m_Index[INDEX_SIZE];
+	Pixel m_Pixel;
+	uint8 m_RunCount;
+	bool m_IsTruncated;
+};
+
+class SpriteDecoder
+{
+public:
+	SpriteDecoder(const Sprite &Sprite)
+		: m_Sprite(Sprite),
+		  m_Row(Sprite.Data),
+		  m_Stride(((Sprite.Width * Sprite.BitsPerPixel) + 7) / 8),
+		  m_Mask((1 << Sprite.BitsPerPixel) - 1),
+		  m_Column(0)
+	{
+		ASSERT(Sprite.BitsPerPixel == 1 || Sprite.BitsPerPixel == 2 || Sprite.BitsPerPixel == 4, "Invalid BitsPerPixel %i", Sprite.BitsPerPixel);
+	}
+
+	uint16 Read(uint8 &Alpha)
+	{
+		const uint32 bit = m_Column * m_Sprite.BitsPerPixel;
+		const uint8 index = (m_Row[bit / 8] >> (8 - m_Sprite.BitsPerPixel - (bit % 8))) & m_Mask;
+
+		if (++m_Column == m_Sprite.Width)
+		{
+			m_Column = 0;
+			m_Row += m_Stride;
+		}
+
+		Alpha = (index == m_Sprite.TransparentIndex ? 0 : 255);
+
+		return m_Sprite.Palette[index];
+	}
+
+	// Rows can be reached directly
+	void Skip(uint32 Count)
+	{
+		Count += m_Column;
+
+		m_Row += (Count / m_Sprite.Width) * m_Stride;
+		m_Column = Count % m_Sprite.Width;
+	}
+
+private:
+	const Sprite &m_Sprite;
+	const uint8 *m_Row;
+	uint16 m_Stride;
+	uint8 m_Mask;
+	uint16 m_Column;
+};
+
+#endif
@@ -3,22 +3,119 @@
 #define LCD_CANVAS_H
 
 #include "I_LCD_HAL.h"
+#include "GlyphCache.h"
+#include "ScanlineRasterizer.h"
+#include "FixedTrigonometry.h"
+#include "ImageDecoders.h"
 #include "DSP/Math.h"
 #include "DSP/Debug.h"
 
 #define TO_UINT16(Value) static_cast<uint16>(Value)
 
-class LCDCanvas
+template <typename HALType>
+class LCDCanvasT
 {
+	static constexpr uint8 MAX_CLIP_DEPTH = 8;
+	static constexpr uint8 MAX_POLYGON_EDGE_COUNT = 64;
+
+	static constexpr uint8 OUT_CODE_LEFT = 1;
+	static constexpr uint8 OUT_CODE_RIGHT = 2;
+	static constexpr uint8 OUT_CODE_TOP = 4;
+	static constexpr uint8 OUT_CODE_BOTTOM = 8;
+
+	typedef ScanlineRasterizer<MAX_POLYGON_EDGE_COUNT> RasterizerType;
+
+	static constexpr uint8 ROUND_CAP_VERTEX_COUNT = 12;
+	static constexpr uint8 ANTI_ALIASED_RUN_LENGTH = 32;
+	static constexpr uint8 IMAGE_RUN_LENGTH = 64;
+	static constexpr uint8 PIXEL_BATCH_LENGTH = 32;
+
+	// A clockwise sweep is the intersection of the clockwise side of its start ray and the other side of its end ray,
+	// so the sweeps of 180 degrees and more are split in two
+	struct ArcSweep
+	{
+	public:
+		uint8 Count;
+		int32 Cosines[3];
+		int32 Sines[3];
+	};
+
+	// Scattered pixels of one color, handed to the HAL a batch at a time, so the color gets converted once per batch
+	// instead of once per pixel, pixels outside of Clip are dropped
+	class PixelBatch
+	{
+	public:
+		PixelBatch(HALType *HAL, const Rect &Clip, Color Color)
+			: m_HAL(HAL),
+			  m_Clip(Clip),
+			  m_Color(Color),
+			  m_Count(0),
+			  m_IsBlended(false)
+		{
+		}
+
+		void Add(int32 X, int32 Y, uint8 Alpha = 255)
+		{
+			if (X < m_Clip.Position.X || X >= m_Clip.Position.X + m_Clip.Dimension.X || Y < m_Clip.Position.Y || Y >= m_Clip.Position.Y + m_Clip.Dimension.Y)
+				return;
+
+			if (m_Count == PIXEL_BATCH_LENGTH)
+				Flush();
+
+			m_Positions[m_Count] = {TO_UINT16(X), TO_UINT16(Y)};
+			m_Alphas[m_Count] = Alpha;
+			++m_Count;
+
+			m_IsBlended |= (Alpha != 255);
+		}
+
+		void Flush(void)
+		{
+			if (m_Count == 0)
+				return;
+
+			if (m_IsBlended)
+				m_HAL->BlendPixels(m_Positions, m_Alphas, m_Count, m_Color);
+			else
+				m_HAL->DrawPixels(m_Positions, m_Count, m_Color);
+
+			m_Count = 0;
+			m_IsBlended = false;
+		}
+
+	private:
+		HALType *m_HAL;
+		Rect m_Clip;
+		Color m_Color;
+		Point m_Positions[PIXEL_BATCH_LENGTH];
+		uint8 m_Alphas[PIXEL_BATCH_LENGTH];
+		uint8 m_Count;
+		bool m_IsBlended;
+	};
+
+public:
+	// Ends of the lines thicker than 1
+	enum class LineCaps
+	{
+		// Ends on the end points
+		Butt = 0,
+		// Goes past the end points by half of the thickness
+		Square,
+		Round
+	};
+
 public:
-	LCDCanvas(void)
+	LCDCanvasT(void)
 		: m_HAL(nullptr),
+		  m_GlyphCache(nullptr),
 		  m_CharacterSpacing(0),
-		  m_LineSpacing(0)
+		  m_LineSpacing(0),
+		  m_LineCap(LineCaps::Butt),
+		  m_ClipDepth(0)
 	{
 	}
 
-	void Initialize(I_LCD_HAL *HAL)
+	void Initialize(HALType *HAL)
 	{
 		ASSERT(HAL != nullptr, "HAL cannot be null");
 
@@ -32,294 +129,1580 @@ public:
 		m_HAL->Clear(Color);
 	}
 
-	void DrawPixel(uint16 X, uint16 Y, Color Color)
+	// Drawing is limited to the intersection of the pushed rectangles and the screen
+	void PushClipRect(int16 X, int16 Y, uint16 Width, uint16 Height)
+	{
+		ASSERT(m_ClipDepth < MAX_CLIP_DEPTH, "Running out of clip depth");
+
+		const Rect clip = GetClipRect();
+
+		const int32 left = Math::Max<int32>(X, clip.Position.X);
+		const int32 top = Math::Max<int32>(Y, clip.Position.Y);
+		const int32 right = Math::Min<int32>(X + Width, clip.Position.X + clip.Dimension.X);
+		const int32 bottom = Math::Min<int32>(Y + Height, clip.Position.Y + clip.Dimension.Y);
+
+		m_ClipRects[m_ClipDepth++] = {TO_UINT16(left), TO_UINT16(top), TO_UINT16(Math::Max<int32>(right - left, 0)), TO_UINT16(Math::Max<int32>(bottom - top, 0))};
+	}
+
+	void PushClipRect(Rect Rect)
+	{
+		PushClipRect(Rect.Position.X, Rect.Position.Y, Rect.Dimension.X, Rect.Dimension.Y);
+	}
+
+	void PopClipRect(void)
+	{
+		ASSERT(m_ClipDepth != 0, "There is no clip rect to pop");
+
+		--m_ClipDepth;
+	}
+
+	Rect GetClipRect(void) const
+	{
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+
+		if (m_ClipDepth == 0)
+			return {{}, m_HAL->GetDimension()};
+
+		return m_ClipRects[m_ClipDepth - 1];
+	}
+
+	void DrawPixel(int16 X, int16 Y, Color Color)
 	{
 		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
 
-		m_HAL->DrawPixel({X, Y}, Color);
+		if (!IsVisible(X, Y, 1, 1))
+			return;
+
+		m_HAL->DrawPixel({TO_UINT16(X), TO_UINT16(Y)}, Color);
 	}
 
-	void DrawLine(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1, Color Color, uint8 Thickness = 1)
+	// Thicker lines are filled as a quad around the line between the pixel centers, ended by the line cap
+	void DrawLine(int16 X0, int16 Y0, int16 X1, int16 Y1, Color Color, uint8 Thickness = 1)
 	{
+		if (Thickness == 0)
+			return;
+
+		if (Thickness > 1)
+		{
+			AddStroke(GetPixelCenter(X0), GetPixelCenter(Y0), GetPixelCenter(X1), GetPixelCenter(Y1), Thickness, m_LineCap, m_LineCap);
+
+			FillPolygon(Color);
+
+			return;
+		}
+
 		if (X0 == X1)
 		{
-			DrawVerticalLine(X0, Y0, Y1 - Y0 + 1, Color, Thickness);
+			DrawVerticalLine(X0, Y0, Y1 - Y0 + 1, Color);
 
 			return;
 		}
 
 		if (Y0 == Y1)
 		{
-			DrawHorizontalLine(X0, Y0, X1 - X0 + 1, Color, Thickness);
+			DrawHorizontalLine(X0, Y0, X1 - X0 + 1, Color);
+
+			return;
+		}
 
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+
+		int32 deltaX = Math::Absolute(X1 - X0);
+		int32 deltaY = Math::Absolute(Y1 - Y0);
+		int32 signX = Math::Sign(X1 - X0);
+		int32 signY = Math::Sign(Y1 - Y0);
+
+		// Only the visible steps get walked, starting from the state the walk would have at the first of them
+		int32 firstStep, lastStep;
+		if (!ClipLine(X0, Y0, X1, Y1, firstStep, lastStep))
 			return;
+
+		int32 x, y, error;
+		if (deltaX >= deltaY)
+		{
+			int32 minorStep = GetLineStepOffset(firstStep, deltaX, deltaY);
+
+			x = X0 + (signX * firstStep);
+			y = Y0 + (signY * minorStep);
+			error = deltaX - deltaY - (firstStep * deltaY) + (minorStep * deltaX);
+		}
+		else
+		{
+			int32 minorStep = GetLineStepOffset(firstStep, deltaY, deltaX);
+
+			x = X0 + (signX * minorStep);
+			y = Y0 + (signY * firstStep);
+			error = deltaX - deltaY - (minorStep * deltaY) + (firstStep * deltaX);
 		}
 
-		for (uint8 t = 0; t < Thickness; ++t)
+		PixelBatch batch(m_HAL, GetClipRect(), Color);
+
+		for (int32 step = firstStep; step <= lastStep; ++step)
 		{
-			int16 x0 = (X0 - Thickness / 2) + t;
-			int16 x1 = (X1 - Thickness / 2) + t;
-			int16 y0 = Y0;
+			batch.Add(x, y);
 
-			int32 deltaX = Math::Absolute((int16)x1 - (int16)x0);
-			int32 deltaY = Math::Absolute((int16)Y1 - (int16)Y0);
-			int32 signX = Math::Sign((int16)x1 - (int16)x0);
-			int32 signY = Math::Sign((int16)Y1 - (int16)Y0);
-			int32 error = deltaX - deltaY;
+			int32 error2 = error * 2;
 
-			DrawPixel(x1, Y1, Color);
+			if (error2 > -deltaY)
+			{
+				error -= deltaY;
+				x += signX;
+			}
 
-			while ((x0 != x1) || (y0 != Y1))
+			if (error2 < deltaX)
 			{
-				DrawPixel(x0, y0, Color);
+				error += deltaX;
+				y += signY;
+			}
+		}
+
+		batch.Flush();
+	}
 
-				int32 error2 = error * 2;
+	// Xiaolin Wu's line, every step blends the two pixels nearest to the line by their coverage
+	// The pixels of consecutive steps on the same rows are blended as one run
+	void DrawAntiAliasedLine(int16 X0, int16 Y0, int16 X1, int16 Y1, Color Color)
+	{
+		int32 deltaX = X1 - X0;
+		int32 deltaY = Y1 - Y0;
 
-				if (error2 > -deltaY)
-				{
-					error -= deltaY;
-					x0 += signX;
-				}
+		// Nothing to blend on these
+		if (deltaX == 0 || deltaY == 0 || Math::Absolute(deltaX) == Math::Absolute(deltaY))
+		{
+			DrawLine(X0, Y0, X1, Y1, Color);
+
+			return;
+		}
 
-				if (error2 < deltaX)
+		if (!IsVisible(Math::Min(X0, X1), Math::Min(Y0, Y1), Math::Absolute(deltaX) + 2, Math::Absolute(deltaY) + 2))
+			return;
+
+		const Rect clip = GetClipRect();
+		PixelBatch batch(m_HAL, clip, Color);
+
+		batch.Add(X0, Y0);
+		batch.Add(X1, Y1);
+
+		// The error is the distance to the next minor step in 0.16 fixed point, wrapping around on the step
+		uint16 error = 0;
+
+		if (Math::Absolute(deltaX) > Math::Absolute(deltaY))
+		{
+			// Always walk right
+			if (deltaX < 0)
+			{
+				std::swap(X0, X1);
+				std::swap(Y0, Y1);
+				deltaX = -deltaX;
+				deltaY = -deltaY;
+			}
+
+			const int32 signY = Math::Sign(deltaY);
+			const uint16 errorStep = (static_cast<uint32>(Math::Absolute(deltaY)) << 16) / deltaX;
+
+			uint8 nearAlphas[ANTI_ALIASED_RUN_LENGTH];
+			uint8 farAlphas[ANTI_ALIASED_RUN_LENGTH];
+			uint8 runLength = 0;
+			int32 runX = X0 + 1;
+			int32 y = Y0;
+
+			for (int32 x = X0 + 1; x < X1; ++x)
+			{
+				const uint16 previousError = error;
+				error += errorStep;
+
+				if (error <= previousError || runLength == ANTI_ALIASED_RUN_LENGTH)
 				{
-					error += deltaX;
-					y0 += signY;
+					BlendRun(batch, clip, runX, y, nearAlphas, runLength, Color);
+					BlendRun(batch, clip, runX, y + signY, farAlphas, runLength, Color);
+
+					runX = x;
+					runLength = 0;
 				}
+
+				if (error <= previousError)
+					y += signY;
+
+				const uint8 coverage = error >> 8;
+				nearAlphas[runLength] = 255 - coverage;
+				farAlphas[runLength] = coverage;
+				++runLength;
 			}
+
+			BlendRun(batch, clip, runX, y, nearAlphas, runLength, Color);
+			BlendRun(batch, clip, runX, y + signY, farAlphas, runLength, Color);
+
+			batch.Flush();
+
+			return;
+		}
+
+		// Always walk down
+		if (deltaY < 0)
+		{
+			std::swap(X0, X1);
+			std::swap(Y0, Y1);
+			deltaX = -deltaX;
+			deltaY = -deltaY;
+		}
+
+		const int32 signX = Math::Sign(deltaX);
+		const uint16 errorStep = (static_cast<uint32>(Math::Absolute(deltaX)) << 16) / deltaY;
+
+		int32 x = X0;
+
+		for (int32 y = Y0 + 1; y < Y1; ++y)
+		{
+			const uint16 previousError = error;
+			error += errorStep;
+			if (error <= previousError)
+				x += signX;
+
+			const uint8 coverage = error >> 8;
+
+			// Both pixels are on the same row
+			batch.Add(x, y, 255 - coverage);
+			batch.Add(x + signX, y, coverage);
 		}
+
+		batch.Flush();
 	}
 
-	void DrawRectangle(uint16 X, uint16 Y, uint16 Width, uint16 Height, Color Color, uint8 Thickness = 1)
+	void DrawRectangle(int16 X, int16 Y, uint16 Width, uint16 Height, Color Color, uint8 Thickness = 1)
 	{
 		int32 x2 = X + Width;
 		int32 y2 = Y + Height;
 
+		if (Thickness > 1)
+		{
+			AddOutlineSide(X, Y, x2, Y, Thickness);
+			AddOutlineSide(x2, Y, x2, y2, Thickness);
+			AddOutlineSide(x2, y2, X, y2, Thickness);
+			AddOutlineSide(X, y2, X, Y, Thickness);
+
+			FillPolygon(Color);
+
+			return;
+		}
+
 		DrawLine(X, Y, X, y2, Color, Thickness);
 		DrawLine(X, Y, x2, Y, Color, Thickness);
 		DrawLine(X, y2, x2, y2, Color, Thickness);
 		DrawLine(x2, Y, x2, y2, Color, Thickness);
 	}
 
-	void DrawFilledRectangle(uint16 X, uint16 Y, uint16 Width, uint16 Height, Color Color)
+	void DrawFilledRectangle(int16 X, int16 Y, uint16 Width, uint16 Height, Color Color)
 	{
-		for (uint32 j = 0; j < Height; ++j)
-			for (uint32 i = 0; i < Width; ++i)
-				DrawPixel(X + i, Y + j, Color);
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+
+		const Rect clip = GetClipRect();
+
+		const int32 left = Math::Max<int32>(X, clip.Position.X);
+		const int32 top = Math::Max<int32>(Y, clip.Position.Y);
+		const int32 right = Math::Min<int32>(X + Width, clip.Position.X + clip.Dimension.X);
+		const int32 bottom = Math::Min<int32>(Y + Height, clip.Position.Y + clip.Dimension.Y);
+		if (left >= right || top >= bottom)
+			return;
+
+		m_HAL->DrawFilledRectangle({TO_UINT16(left), TO_UINT16(top), TO_UINT16(right - left), TO_UINT16(bottom - top)}, Color);
 	}
 
-	void DrawParallelogram(uint16 LeftTopX, uint16 LeftTopY, uint16 LeftBottomX, uint16 LeftBottomY, uint16 RightTopX, uint16 RightTopY, uint16 RightBottomX, uint16 RightBottomY, Color Color, uint8 Thickness = 1)
+	void DrawParallelogram(int16 LeftTopX, int16 LeftTopY, int16 LeftBottomX, int16 LeftBottomY, int16 RightTopX, int16 RightTopY, int16 RightBottomX, int16 RightBottomY, Color Color, uint8 Thickness = 1)
 	{
+		if (Thickness > 1)
+		{
+			AddOutlineSide(LeftTopX, LeftTopY, RightTopX, RightTopY, Thickness);
+			AddOutlineSide(RightTopX, RightTopY, RightBottomX, RightBottomY, Thickness);
+			AddOutlineSide(RightBottomX, RightBottomY, LeftBottomX, LeftBottomY, Thickness);
+			AddOutlineSide(LeftBottomX, LeftBottomY, LeftTopX, LeftTopY, Thickness);
+
+			FillPolygon(Color);
+
+			return;
+		}
+
 		DrawLine(LeftTopX, LeftTopY, LeftBottomX, LeftBottomY, Color, Thickness);
 		DrawLine(LeftTopX, LeftTopY, RightTopX, RightTopY, Color, Thickness);
 		DrawLine(RightTopX, RightTopY, RightBottomX, RightBottomY, Color, Thickness);
 		DrawLine(LeftBottomX, LeftBottomY, RightBottomX, RightBottomY, Color, Thickness);
 	}
 
-	void DrawFilledParallelogram(uint16 LeftTopX, uint16 LeftTopY, uint16 LeftBottomX, uint16 LeftBottomY, uint16 RightTopX, uint16 RightTopY, uint16 RightBottomX, uint16 RightBottomY, Color Color)
+	void DrawFilledParallelogram(int16 LeftTopX, int16 LeftTopY, int16 LeftBottomX, int16 LeftBottomY, int16 RightTopX, int16 RightTopY, int16 RightBottomX, int16 RightBottomY, Color Color)
+	{
+		AddPolygonEdge(LeftTopX, LeftTopY, RightTopX, RightTopY);
+		AddPolygonEdge(RightTopX, RightTopY, RightBottomX, RightBottomY);
+		AddPolygonEdge(RightBottomX, RightBottomY, LeftBottomX, LeftBottomY);
+		AddPolygonEdge(LeftBottomX, LeftBottomY, LeftTopX, LeftTopY);
+
+		FillPolygon(Color);
+	}
+
+	// Any simple or self-intersecting polygon, filled with the non-zero winding rule
+	void DrawFilledPolygon(const Point *Points, uint8 Count, Color Color)
+	{
+		ASSERT(Points != nullptr, "Points cannot be null");
+		ASSERT(Count <= MAX_POLYGON_EDGE_COUNT, "Running out of polygon edge capacity");
+
+		for (uint8 i = 0; i < Count; ++i)
+		{
+			const Point &point0 = Points[i];
+			const Point &point1 = Points[(i + 1) % Count];
+
+			AddPolygonEdge(point0.X, point0.Y, point1.X, point1.Y);
+		}
+
+		FillPolygon(Color);
+	}
+
+	void DrawTriangle(int16 X0, int16 Y0, int16 X1, int16 Y1, int16 X2, int16 Y2, Color Color, uint8 Thickness = 1)
+	{
+		if (Thickness > 1)
+		{
+			AddOutlineSide(X0, Y0, X1, Y1, Thickness);
+			AddOutlineSide(X1, Y1, X2, Y2, Thickness);
+			AddOutlineSide(X2, Y2, X0, Y0, Thickness);
+
+			FillPolygon(Color);
+
+			return;
+		}
+
+		DrawLine(X0, Y0, X1, Y1, Color, Thickness);
+		DrawLine(X1, Y1, X2, Y2, Color, Thickness);
+		DrawLine(X2, Y2, X0, Y0, Color, Thickness);
+	}
+
+	void DrawFilledTriangle(int16 X0, int16 Y0, int16 X1, int16 Y1, int16 X2, int16 Y2, Color Color)
+	{
+		AddPolygonEdge(X0, Y0, X1, Y1);
+		AddPolygonEdge(X1, Y1, X2, Y2);
+		AddPolygonEdge(X2, Y2, X0, Y0);
+
+		FillPolygon(Color);
+	}
+
+	// Thicker circles are centered on the circle of Thickness 1 and filled row by row
+	void DrawCircle(int16 X0, int16 Y0, uint16 Radius, Color Color, uint8 Thickness = 1)
+	{
+		if (Radius == 0 || Thickness == 0)
+			return;
+
+		const int16 extent = Radius + Thickness;
+		if (!IsVisible(X0 - extent, Y0 - extent, (2 * extent) + 1, (2 * extent) + 1))
+			return;
+
+		if (Thickness > 1)
+		{
+			FillRing(X0, Y0, (2 * (Radius - 1)) + Thickness, (2 * (Radius - 1)) - Thickness, Color);
+
+			return;
+		}
+
+		--Radius;
+
+		int16 f = 1 - Radius;
+		int16 ddF_x = 1;
+		int16 ddF_y = -2 * Radius;
+		int16 x = 0;
+		int16 y = Radius;
+
+		PixelBatch batch(m_HAL, GetClipRect(), Color);
+
+		batch.Add(X0, Y0 + Radius);
+		batch.Add(X0, Y0 - Radius);
+		batch.Add(X0 + Radius, Y0);
+		batch.Add(X0 - Radius, Y0);
+
+		while (x < y)
+		{
+			if (f >= 0)
+			{
+				y--;
+				ddF_y += 2;
+				f += ddF_y;
+			}
+			x++;
+			ddF_x += 2;
+			f += ddF_x;
+
+			batch.Add(X0 + x, Y0 + y);
+			batch.Add(X0 - x, Y0 + y);
+			batch.Add(X0 + x, Y0 - y);
+			batch.Add(X0 - x, Y0 - y);
+			batch.Add(X0 + y, Y0 + x);
+			batch.Add(X0 - y, Y0 + x);
+			batch.Add(X0 + y, Y0 - x);
+			batch.Add(X0 - y, Y0 - x);
+		}
+
+		batch.Flush();
+	}
+
+	// Xiaolin Wu's circle on the circle of DrawCircle
+	void DrawAntiAliasedCircle(int16 X0, int16 Y0, uint16 Radius, Color Color)
+	{
+		if (Radius == 0 || !IsVisible(X0 - Radius - 1, Y0 - Radius - 1, (2 * Radius) + 3, (2 * Radius) + 3))
+			return;
+
+		const Rect clip = GetClipRect();
+		PixelBatch batch(m_HAL, clip, Color);
+
+		WalkAntiAliasedCircle(Radius - 1, [&](int32 X, int32 Y, const uint8 *Alphas, uint8 Length)
+							  { BlendRun(batch, clip, X0 + X, Y0 + Y, Alphas, Length, Color); });
+
+		batch.Flush();
+	}
+
+	// Angles are FixedTrigonometry angles, zero points right and they grow clockwise
+	// Arcs go clockwise from StartAngle up to EndAngle, pixels on the ray of EndAngle belong to the next arc,
+	// the same angles make an empty arc
+	void DrawArc(int16 X0, int16 Y0, uint16 Radius, uint16 StartAngle, uint16 EndAngle, Color Color, uint8 Thickness = 1)
+	{
+		if (Radius == 0 || Thickness == 0)
+			return;
+
+		const int16 extent = Radius + Thickness;
+		if (!IsVisible(X0 - extent, Y0 - extent, (2 * extent) + 1, (2 * extent) + 1))
+			return;
+
+		FillArc(X0, Y0, (2 * (Radius - 1)) + Thickness, (2 * (Radius - 1)) - Thickness, StartAngle, EndAngle, Color);
+	}
+
+	// Part of the ring between the filled circles of the radii, InnerRadius of zero makes a pie slice
+	void DrawFilledArc(int16 X0, int16 Y0, uint16 OuterRadius, uint16 InnerRadius, uint16 StartAngle, uint16 EndAngle, Color Color)
+	{
+		if (OuterRadius <= InnerRadius || !IsVisible(X0 - OuterRadius, Y0 - OuterRadius, (2 * OuterRadius) + 1, (2 * OuterRadius) + 1))
+			return;
+
+		FillArc(X0, Y0, (2 * OuterRadius) - 1, (2 * InnerRadius) - 1, StartAngle, EndAngle, Color);
+	}
+
+	// Delta arc mode, for arcs showing a value from StartAngle, only the part between the previous and the new end gets painted,
+	// with ForegroundColor when the arc grows and with BackgroundColor when it shrinks
+	void UpdateArc(int16 X0, int16 Y0, uint16 Radius, uint16 StartAngle, uint16 PreviousEndAngle, uint16 EndAngle, Color ForegroundColor, Color BackgroundColor, uint8 Thickness = 1)
+	{
+		const uint16 previousSweep = PreviousEndAngle - StartAngle;
+		const uint16 sweep = EndAngle - StartAngle;
+
+		if (sweep > previousSweep)
+			DrawArc(X0, Y0, Radius, PreviousEndAngle, EndAngle, ForegroundColor, Thickness);
+		else if (sweep < previousSweep)
+			DrawArc(X0, Y0, Radius, EndAngle, PreviousEndAngle, BackgroundColor, Thickness);
+	}
+
+	void UpdateFilledArc(int16 X0, int16 Y0, uint16 OuterRadius, uint16 InnerRadius, uint16 StartAngle, uint16 PreviousEndAngle, uint16 EndAngle, Color ForegroundColor, Color BackgroundColor)
+	{
+		const uint16 previousSweep = PreviousEndAngle - StartAngle;
+		const uint16 sweep = EndAngle - StartAngle;
+
+		if (sweep > previousSweep)
+			DrawFilledArc(X0, Y0, OuterRadius, InnerRadius, PreviousEndAngle, EndAngle, ForegroundColor);
+		else if (sweep < previousSweep)
+			DrawFilledArc(X0, Y0, OuterRadius, InnerRadius, EndAngle, PreviousEndAngle, BackgroundColor);
+	}
+
+	// The part of DrawAntiAliasedCircle in the sweep of DrawArc, the ends are cut at the rays
+	void DrawAntiAliasedArc(int16 X0, int16 Y0, uint16 Radius, uint16 StartAngle, uint16 EndAngle, Color Color)
+	{
+		if (Radius == 0 || StartAngle == EndAngle || !IsVisible(X0 - Radius - 1, Y0 - Radius - 1, (2 * Radius) + 3, (2 * Radius) + 3))
+			return;
+
+		const Rect clip = GetClipRect();
+		const ArcSweep sweep = GetArcSweep(StartAngle, EndAngle);
+		PixelBatch batch(m_HAL, clip, Color);
+
+		WalkAntiAliasedCircle(Radius - 1, [&](int32 X, int32 Y, const uint8 *Alphas, uint8 Length)
+							  {
+								  // Splits the run into the parts in the sweep
+								  uint8 start = 0;
+								  for (uint8 i = 0; i <= Length; ++i)
+								  {
+									  if (i < Length && IsInArcSweep(sweep, X + i, Y))
+										  continue;
+
+									  if (start < i)
+										  BlendRun(batch, clip, X0 + X + start, Y0 + Y, Alphas + start, i - start, Color);
+
+									  start = i + 1;
+								  }
+							  });
+
+		batch.Flush();
+	}
+
+	// A line along Angle from InnerRadius to OuterRadius, its ends aren't rounded to pixels so it moves smoothly
+	void DrawNeedle(int16 X0, int16 Y0, uint16 Angle, uint16 InnerRadius, uint16 OuterRadius, Color Color, uint8 Thickness = 1)
+	{
+		if (Thickness == 0)
+			return;
+
+		const int32 cosine = FixedTrigonometry::Cosine(Angle);
+		const int32 sine = FixedTrigonometry::Sine(Angle);
+		const uint8 shift = FixedTrigonometry::SHIFT - RasterizerType::SUBPIXEL_SHIFT;
+
+		const int32 x = GetPixelCenter(X0);
+		const int32 y = GetPixelCenter(Y0);
+
+		AddStroke(x + ((cosine * InnerRadius) >> shift), y + ((sine * InnerRadius) >> shift), x + ((cosine * OuterRadius) >> shift), y + ((sine * OuterRadius) >> shift), Thickness, m_LineCap, m_LineCap);
+
+		FillPolygon(Color);
+	}
+
+	void DrawFilledCircle(int16 X0, int16 Y0, uint16 Radius, Color Color)
+	{
+		if (Radius == 0 || !IsVisible(X0 - Radius, Y0 - Radius, (2 * Radius) + 1, (2 * Radius) + 1))
+			return;
+
+		WalkCircleRows(Radius - 1, [&](int16 Y, int16 HalfWidth)
+					   {
+						   FillHorizontalSpan(X0 - HalfWidth, Y0 - Y, (2 * HalfWidth) + 1, Color);
+
+						   if (Y != 0)
+							   FillHorizontalSpan(X0 - HalfWidth, Y0 + Y, (2 * HalfWidth) + 1, Color);
+					   });
+	}
+
+	void DrawFilledEllipse(int16 X0, int16 Y0, uint16 RadiusX, uint16 RadiusY, Color Color)
 	{
-		uint16 minX = LeftTopX;
-		uint16 minY = LeftTopY;
+		if (RadiusX == 0 || RadiusY == 0 || !IsVisible(X0 - RadiusX, Y0 - RadiusY, (2 * RadiusX) + 1, (2 * RadiusY) + 1))
+			return;
+
+		// Spans the same box as DrawFilledCircle, covers the pixel centers in the ellipse of radii (Radius - 0.5)
+		const uint64 width = (2 * RadiusX) - 1;
+		const uint64 height = (2 * RadiusY) - 1;
+
+		const Rect clip = GetClipRect();
+
+		for (int32 y = 0; y < RadiusY; ++y)
+		{
+			const bool isTopVisible = (Y0 - y >= clip.Position.Y && Y0 - y < clip.Position.Y + clip.Dimension.Y);
+			const bool isBottomVisible = (y != 0 && Y0 + y >= clip.Position.Y && Y0 + y < clip.Position.Y + clip.Dimension.Y);
+			if (!isTopVisible && !isBottomVisible)
+				continue;
+
+			// x^2 / (width / 2)^2 + y^2 / (height / 2)^2 <= 1
+			const int32 halfWidth = IntegerSquareRoot(width * width * ((height * height) - (4 * y * y))) / (2 * height);
+
+			if (isTopVisible)
+				FillHorizontalSpan(X0 - halfWidth, Y0 - y, (2 * halfWidth) + 1, Color);
+
+			if (isBottomVisible)
+				FillHorizontalSpan(X0 - halfWidth, Y0 + y, (2 * halfWidth) + 1, Color);
+		}
+	}
+
+	// The corners are DrawFilledCircle quarters of Radius + 1, so Radius of zero is a plain rectangle
+	void DrawFilledRoundedRectangle(int16 X, int16 Y, uint16 Width, uint16 Height, uint16 Radius, Color Color)
+	{
+		if (Width == 0 || Height == 0 || !IsVisible(X, Y, Width, Height))
+			return;
+
+		Radius = Math::Min<uint16>(Radius, (Math::Min(Width, Height) - 1) / 2);
+
+		const int16 centerLeft = X + Radius;
+		const int16 centerRight = X + Width - 1 - Radius;
+		const int16 centerTop = Y + Radius;
+		const int16 centerBottom = Y + Height - 1 - Radius;
+
+		DrawFilledRectangle(X, centerTop, Width, centerBottom - centerTop + 1, Color);
+
+		if (Radius == 0)
+			return;
+
+		WalkCircleRows(Radius, [&](int16 RowY, int16 HalfWidth)
+					   {
+						   if (RowY == 0)
+							   return;
+
+						   const int16 left = centerLeft - HalfWidth;
+						   const int16 length = (centerRight + HalfWidth) - left + 1;
+
+						   FillHorizontalSpan(left, centerTop - RowY, length, Color);
+						   FillHorizontalSpan(left, centerBottom + RowY, length, Color);
+					   });
+	}
+
+	// https://www.cambridgeincolour.com/tutorials/image-interpolation.htm
+	void DrawCharacter(int16 X, int16 Y, char Char, const Font &Font, Color Color)
+	{
+		const uint8 MAX_SCALED_SIZE = 128;
+
+		ASSERT(Font.Width * Font.Scale <= MAX_SCALED_SIZE, "Running out of max scaled size");
+		ASSERT(Font.Height * Font.Scale <= MAX_SCALED_SIZE, "Running out of max scaled size");
+
+		if (Char < ' ' || '~' < Char)
+			return;
+
+		uint8 newWidth = Font.Width * Font.Scale;
+		if (!IsVisible(X, Y, newWidth, Font.Height * Font.Scale))
+			return;
+
+		if (m_GlyphCache != nullptr)
+		{
+			const GlyphCache::Glyph &glyph = m_GlyphCache->Get(Font, Char);
+			const GlyphCache::Run *runs = m_GlyphCache->GetRuns(glyph);
+
+			for (uint16 i = 0; i < glyph.RunCount; ++i)
+			{
+				const GlyphCache::Run &run = runs[i];
+
+				FillHorizontalSpan(X + run.X, Y + run.Y, run.Length, Color);
+			}
+
+			return;
+		}
+
+		const Rect clip = GetClipRect();
+
+		const int16 visibleX = Math::Max<int16>(X, clip.Position.X);
+		const uint16 skippedWidth = visibleX - X;
+		const uint16 visibleWidth = Math::Min<int32>(X + newWidth, clip.Position.X + clip.Dimension.X) - visibleX;
+
+		// Every source row lands on a single scaled row, so one row of alpha is enough
+		uint8 alphaRow[MAX_SCALED_SIZE];
+
+		uint8 charIndex = Char - ' ';
+		auto dataPtr = Font.Data + (charIndex * Font.Height);
+		for (uint8 y = 0; y < Font.Height; ++y)
+		{
+			// Scales below 1 land several source rows on the same scaled row, the last one wins
+			const uint8 scaledY = y * Font.Scale;
+			if (y + 1 < Font.Height && (uint8)((y + 1) * Font.Scale) == scaledY)
+				continue;
+
+			uint16 data = dataPtr[y];
+			if (data == 0)
+				continue;
+
+			int16 rowY = Y + scaledY;
+			if (rowY < clip.Position.Y || rowY >= clip.Position.Y + clip.Dimension.Y)
+				continue;
+
+			for (uint8 x = 0; x < newWidth; ++x)
+				alphaRow[x] = 0;
+
+			// And so does the last source column
+			for (uint8 x = 0; x < Font.Width; ++x)
+				alphaRow[(uint8)(x * Font.Scale)] = (((1 << x) & data) == 0 ? 0 : 255);
+
+			m_HAL->BlendHorizontalLine({TO_UINT16(visibleX), TO_UINT16(rowY)}, alphaRow + skippedWidth, visibleWidth, Color);
+		}
+	}
+
+	void DrawString(int16 X, int16 Y, cstr const String, const Font &Font, Color Color)
+	{
+		DrawString(X, Y, String, GetStringLength(String), Font, Color);
+	}
+
+	void DrawString(int16 X, int16 Y, cstr String, uint16 Length, const Font &Font, Color Color)
+	{
+		ASSERT(String != nullptr, "String cannot be null");
+
+		if (Length == 0)
+			return;
+
+		int16 x = X;
+
+		for (uint16 i = 0; i < Length; ++i)
+		{
+			char ch = String[i];
+
+			if (ch == '\n' || ch == '\r')
+			{
+				Y += (Font.Height * Font.Scale) + m_LineSpacing;
+				x = X;
+				continue;
+			}
+
+			DrawCharacter(x, Y, ch, Font, Color);
+
+			x += (Font.Width * Font.Scale) + m_CharacterSpacing;
+		}
+	}
+
+	Point MeasureCharacterDimension(char Character, const Font &Font)
+	{
+		if (Character == '\n' || Character == '\r')
+			return {};
+
+		return {TO_UINT16((Font.Width * Font.Scale) + m_CharacterSpacing), TO_UINT16((Font.Height * Font.Scale) + m_LineSpacing)};
+	}
+
+	Point MeasureStringDimension(cstr String, const Font &Font)
+	{
+		return MeasureStringDimension(String, GetStringLength(String), Font);
+	}
+
+	Point MeasureStringDimension(cstr String, uint16 Length, const Font &Font)
+	{
+		ASSERT(String != nullptr, "String cannot be null");
+
+		if (Length == 0)
+			return {};
+
+		uint16 maxCharCountPerLine = 0;
+		uint16 charCount = 0;
+		uint16 lineCount = 1;
+		for (uint16 i = 0; i < Length; ++i)
+		{
+			char ch = String[i];
+
+			if (ch == '\n' || ch == '\r')
+			{
+				++lineCount;
+				charCount = 0;
+
+				continue;
+			}
+
+			++charCount;
+
+			if (maxCharCountPerLine < charCount)
+				maxCharCountPerLine = charCount;
+		}
+
+		return {TO_UINT16(((Font.Width * Font.Scale) + m_CharacterSpacing) * maxCharCountPerLine), TO_UINT16(((Font.Height * Font.Scale) + m_LineSpacing) * lineCount)};
+	}
+
+	// Draws Value into a field of Width cells, right aligned, only the cells whose character changed since the last
+	// draw of the same readout get drawn, together with their background, so nothing has to be cleared under it
+	// The field is as wide as MeasureStringDimension of Width characters, Width of 0 fits the text
+	void DrawNumber(int16 X, int16 Y, int32 Value, const Font &Font, Color ForegroundColor, Color BackgroundColor, NumericReadout &Readout, uint8 Width = 0)
+	{
+		char text[NumericReadout::MAX_LENGTH + 1];
+		const uint8 length = FormatNumber(Value, text);
+
+		DrawReadout(X, Y, text, length, Font, ForegroundColor, BackgroundColor, Readout, Width);
+	}
+
+	// Value has FractionDigits decimal digits, e.g. 1234 with 2 is drawn as 12.34
+	void DrawFixed(int16 X, int16 Y, int32 Value, uint8 FractionDigits, const Font &Font, Color ForegroundColor, Color BackgroundColor, NumericReadout &Readout, uint8 Width = 0)
+	{
+		char text[NumericReadout::MAX_LENGTH + 1];
+		const uint8 length = FormatFixed(Value, FractionDigits, text);
+
+		DrawReadout(X, Y, text, length, Font, ForegroundColor, BackgroundColor, Readout, Width);
+	}
+
+	// Writes the same text as DrawNumber, null terminated, into Buffer of NumericReadout::MAX_LENGTH + 1 and returns its length
+	static uint8 FormatNumber(int32 Value, char *Buffer)
+	{
+		return FormatFixed(Value, 0, Buffer);
+	}
+
+	static uint8 FormatFixed(int32 Value, uint8 FractionDigits, char *Buffer)
+	{
+		ASSERT(Buffer != nullptr, "Buffer cannot be null");
+		ASSERT(FractionDigits < NumericReadout::MAX_LENGTH - 2, "FractionDigits is out of range");
+
+		uint32 magnitude = (Value < 0 ? 0 - static_cast<uint32>(Value) : static_cast<uint32>(Value));
+
+		// Backwards from the last digit, at least one integer digit
+		char digits[NumericReadout::MAX_LENGTH];
+		uint8 count = 0;
+		do
+		{
+			if (count == FractionDigits && count != 0)
+				digits[count++] = '.';
+
+			digits[count++] = '0' + (magnitude % 10);
+			magnitude /= 10;
+		} while (magnitude != 0 || count <= FractionDigits);
+
+		uint8 length = 0;
+		if (Value < 0)
+			Buffer[length++] = '-';
+
+		while (count != 0)
+			Buffer[length++] = digits[--count];
+
+		Buffer[length] = '\0';
+
+		return length;
+	}
+
+	void DrawCharacter(int16 X, int16 Y, char Char, const PackedFont &Font, Color Color)
+	{
+		if (Char < Font.FirstChar || Font.LastChar < Char)
+			return;
+
+		const PackedGlyph &glyph = Font.Glyphs[Char - Font.FirstChar];
+		const uint8 *data = Font.Bitmap + glyph.Offset;
+
+		const int32 left = X + (int32)(glyph.OffsetX * Font.Scale);
+		const int32 top = Y + (int32)(glyph.OffsetY * Font.Scale);
+
+		if (!IsVisible(left, top, (int32)(glyph.Width * Font.Scale) + 1, (int32)(glyph.Height * Font.Scale) + 1))
+			return;
+
+		// Only the bounding box is stored, so empty rows and columns cost nothing
+		uint16 bit = 0;
+		for (uint8 y = 0; y < glyph.Height; ++y, bit += glyph.Width)
+		{
+			uint8 x = 0;
+			while (x < glyph.Width)
+			{
+				if (!IsBitSet(data, bit + x))
+				{
+					++x;
+					continue;
+				}
+
+				uint8 start = x;
+				while (x < glyph.Width && IsBitSet(data, bit + x))
+					++x;
+
+				if (Font.Scale == 1)
+				{
+					FillHorizontalSpan(left + start, top + y, x - start, Color);
+					continue;
+				}
+
+				const int32 x0 = left + (int32)(start * Font.Scale);
+				const int32 x1 = left + (int32)(x * Font.Scale);
+				const int32 y1 = top + (int32)((y + 1) * Font.Scale);
+				for (int32 scaledY = top + (int32)(y * Font.Scale); scaledY < y1; ++scaledY)
+					FillHorizontalSpan(x0, scaledY, x1 - x0, Color);
+			}
+		}
+	}
+
+	void DrawString(int16 X, int16 Y, cstr const String, const PackedFont &Font, Color Color)
+	{
+		DrawString(X, Y, String, GetStringLength(String), Font, Color);
+	}
+
+	void DrawString(int16 X, int16 Y, cstr String, uint16 Length, const PackedFont &Font, Color Color)
+	{
+		ASSERT(String != nullptr, "String cannot be null");
+
+		int16 x = X;
+		char previous = '\0';
+
+		for (uint16 i = 0; i < Length; ++i)
+		{
+			char ch = String[i];
+
+			if (ch == '\n' || ch == '\r')
+			{
+				Y += (Font.Height * Font.Scale) + m_LineSpacing;
+				x = X;
+				previous = '\0';
+				continue;
+			}
+
+			x += GetKerning(Font, previous, ch) * Font.Scale;
+
+			DrawCharacter(x, Y, ch, Font, Color);
+
+			x += (GetAdvance(Font, ch) * Font.Scale) + m_CharacterSpacing;
+			previous = ch;
+		}
+	}
+
+	Point MeasureCharacterDimension(char Character, const PackedFont &Font)
+	{
+		if (Character == '\n' || Character == '\r')
+			return {};
+
+		return {TO_UINT16((GetAdvance(Font, Character) * Font.Scale) + m_CharacterSpacing), TO_UINT16((Font.Height * Font.Scale) + m_LineSpacing)};
+	}
+
+	Point MeasureStringDimension(cstr String, const PackedFont &Font)
+	{
+		return MeasureStringDimension(String, GetStringLength(String), Font);
+	}
+
+	Point MeasureStringDimension(cstr String, uint16 Length, const PackedFont &Font)
+	{
+		ASSERT(String != nullptr, "String cannot be null");
+
+		if (Length == 0)
+			return {};
+
+		int32 maxLineWidth = 0;
+		int32 lineWidth = 0;
+		uint16 lineCount = 1;
+		char previous = '\0';
+		for (uint16 i = 0; i < Length; ++i)
+		{
+			char ch = String[i];
+
+			if (ch == '\n' || ch == '\r')
+			{
+				++lineCount;
+				lineWidth = 0;
+				previous = '\0';
+
+				continue;
+			}
+
+			lineWidth += (int32)(GetKerning(Font, previous, ch) * Font.Scale);
+			lineWidth += (int32)(GetAdvance(Font, ch) * Font.Scale) + m_CharacterSpacing;
+			previous = ch;
+
+			if (maxLineWidth < lineWidth)
+				maxLineWidth = lineWidth;
+		}
+
+		return {TO_UINT16(maxLineWidth), TO_UINT16(((Font.Height * Font.Scale) + m_LineSpacing) * lineCount)};
+	}
+
+	// Decoded while being drawn, only the pixels inside the clip rect reach the HAL
+	void DrawImage(int16 X, int16 Y, const Image &Image)
+	{
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+		ASSERT(Image.Data != nullptr, "Image.Data cannot be null");
+
+		if (!IsVisible(X, Y, Image.Width, Image.Height))
+			return;
+
+		if (Image.Format == ImageFormats::RLE565)
+		{
+			RLE565Decoder decoder(Image);
+			BlitImage(X, Y, Image.Width, Image.Height, decoder);
+		}
+		else
+		{
+			QOIDecoder decoder(Image);
+			BlitImage(X, Y, Image.Width, Image.Height, decoder);
+		}
+	}
+
+	// The transparent pixels are left as they are
+	void DrawSprite(int16 X, int16 Y, const Sprite &Sprite)
+	{
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+		ASSERT(Sprite.Data != nullptr, "Sprite.Data cannot be null");
+		ASSERT(Sprite.Palette != nullptr, "Sprite.Palette cannot be null");
+
+		if (!IsVisible(X, Y, Sprite.Width, Sprite.Height))
+			return;
+
+		SpriteDecoder decoder(Sprite);
+		BlitImage(X, Y, Sprite.Width, Sprite.Height, decoder);
+	}
+
+	void DrawPixel(Point Position, Color Color)
+	{
+		DrawPixel(Position.X, Position.Y, Color);
+	}
+
+	void DrawLine(Point Position0, Point Position1, Color Color, uint8 Thickness = 1)
+	{
+		DrawLine(Position0.X, Position0.Y, Position1.X, Position1.Y, Color, Thickness);
+	}
+
+	void DrawAntiAliasedLine(Point Position0, Point Position1, Color Color)
+	{
+		DrawAntiAliasedLine(Position0.X, Position0.Y, Position1.X, Position1.Y, Color);
+	}
+
+	void DrawRectangle(Rect Rect, Color Color, uint8 Thickness = 1)
+	{
+		DrawRectangle(Rect.Position.X, Rect.Position.Y, Rect.Dimension.X, Rect.Dimension.Y, Color, Thickness);
+	}
+
+	void DrawFilledRectangle(Rect Rect, Color Color)
+	{
+		DrawFilledRectangle(Rect.Position.X, Rect.Position.Y, Rect.Dimension.X, Rect.Dimension.Y, Color);
+	}
+
+	void DrawParallelogram(Point LeftTop, Point LeftBottom, Point RightTop, Point RightBottom, Color Color, uint8 Thickness = 1)
+	{
+		DrawParallelogram(LeftTop.X, LeftTop.Y, LeftBottom.X, LeftBottom.Y, RightTop.X, RightTop.Y, RightBottom.X, RightBottom.Y, Color, Thickness);
+	}
+
+	void DrawFilledParallelogram(Point LeftTop, Point LeftBottom, Point RightTop, Point RightBottom, Color Color)
+	{
+		DrawFilledParallelogram(LeftTop.X, LeftTop.Y, LeftBottom.X, LeftBottom.Y, RightTop.X, RightTop.Y, RightBottom.X, RightBottom.Y, Color);
+	}
+
+	void DrawTriangle(Point Position0, Point Position1, Point Position2, Color Color, uint8 Thickness = 1)
+	{
+		DrawTriangle(Position0.X, Position0.Y, Position1.X, Position1.Y, Position2.X, Position2.Y, Color, Thickness);
+	}
+
+	void DrawFilledTriangle(Point Position0, Point Position1, Point Position2, Color Color)
+	{
+		DrawFilledTriangle(Position0.X, Position0.Y, Position1.X, Position1.Y, Position2.X, Position2.Y, Color);
+	}
+
+	void DrawCircle(Point Position, uint16 Radius, Color Color, uint8 Thickness = 1)
+	{
+		DrawCircle(Position.X, Position.Y, Radius, Color, Thickness);
+	}
+
+	void DrawAntiAliasedCircle(Point Position, uint16 Radius, Color Color)
+	{
+		DrawAntiAliasedCircle(Position.X, Position.Y, Radius, Color);
+	}
+
+	void DrawArc(Point Position, uint16 Radius, uint16 StartAngle, uint16 EndAngle, Color Color, uint8 Thickness = 1)
+	{
+		DrawArc(Position.X, Position.Y, Radius, StartAngle, EndAngle, Color, Thickness);
+	}
+
+	void DrawFilledArc(Point Position, uint16 OuterRadius, uint16 InnerRadius, uint16 StartAngle, uint16 EndAngle, Color Color)
+	{
+		DrawFilledArc(Position.X, Position.Y, OuterRadius, InnerRadius, StartAngle, EndAngle, Color);
+	}
+
+	void UpdateArc(Point Position, uint16 Radius, uint16 StartAngle, uint16 PreviousEndAngle, uint16 EndAngle, Color ForegroundColor, Color BackgroundColor, uint8 Thickness = 1)
+	{
+		UpdateArc(Position.X, Position.Y, Radius, StartAngle, PreviousEndAngle, EndAngle, ForegroundColor, BackgroundColor, Thickness);
+	}
+
+	void UpdateFilledArc(Point Position, uint16 OuterRadius, uint16 InnerRadius, uint16 StartAngle, uint16 PreviousEndAngle, uint16 EndAngle, Color ForegroundColor, Color BackgroundColor)
+	{
+		UpdateFilledArc(Position.X, Position.Y, OuterRadius, InnerRadius, StartAngle, PreviousEndAngle, EndAngle, ForegroundColor, BackgroundColor);
+	}
+
+	void DrawAntiAliasedArc(Point Position, uint16 Radius, uint16 StartAngle, uint16 EndAngle, Color Color)
+	{
+		DrawAntiAliasedArc(Position.X, Position.Y, Radius, StartAngle, EndAngle, Color);
+	}
+
+	void DrawNeedle(Point Position, uint16 Angle, uint16 InnerRadius, uint16 OuterRadius, Color Color, uint8 Thickness = 1)
+	{
+		DrawNeedle(Position.X, Position.Y, Angle, InnerRadius, OuterRadius, Color, Thickness);
+	}
+
+	void DrawFilledCircle(Point Position, uint16 Radius, Color Color)
+	{
+		DrawFilledCircle(Position.X, Position.Y, Radius, Color);
+	}
+
+	void DrawFilledEllipse(Point Position, uint16 RadiusX, uint16 RadiusY, Color Color)
+	{
+		DrawFilledEllipse(Position.X, Position.Y, RadiusX, RadiusY, Color);
+	}
+
+	void DrawFilledRoundedRectangle(Rect Rect, uint16 Radius, Color Color)
+	{
+		DrawFilledRoundedRectangle(Rect.Position.X, Rect.Position.Y, Rect.Dimension.X, Rect.Dimension.Y, Radius, Color);
+	}
+
+	void DrawCharacter(Point Position, char Char, const Font &Font, Color Color)
+	{
+		DrawCharacter(Position.X, Position.Y, Char, Font, Color);
+	}
+
+	void DrawString(Point Position, cstr String, const Font &Font, Color Color)
+	{
+		DrawString(Position.X, Position.Y, String, Font, Color);
+	}
+
+	void DrawString(Point Position, cstr String, uint16 Length, const Font &Font, Color Color)
+	{
+		DrawString(Position.X, Position.Y, String, Length, Font, Color);
+	}
+
+	void DrawCharacter(Point Position, char Char, const PackedFont &Font, Color Color)
+	{
+		DrawCharacter(Position.X, Position.Y, Char, Font, Color);
+	}
+
+	void DrawString(Point Position, cstr String, const PackedFont &Font, Color Color)
+	{
+		DrawString(Position.X, Position.Y, String, Font, Color);
+	}
+
+	void DrawString(Point Position, cstr String, uint16 Length, const PackedFont &Font, Color Color)
+	{
+		DrawString(Position.X, Position.Y, String, Length, Font, Color);
+	}
+
+	void DrawImage(Point Position, const Image &Image)
+	{
+		DrawImage(Position.X, Position.Y, Image);
+	}
+
+	void DrawSprite(Point Position, const Sprite &Sprite)
+	{
+		DrawSprite(Position.X, Position.Y, Sprite);
+	}
+
+	void DrawNumber(Point Position, int32 Value, const Font &Font, Color ForegroundColor, Color BackgroundColor, NumericReadout &Readout, uint8 Width = 0)
+	{
+		DrawNumber(Position.X, Position.Y, Value, Font, ForegroundColor, BackgroundColor, Readout, Width);
+	}
+
+	void DrawFixed(Point Position, int32 Value, uint8 FractionDigits, const Font &Font, Color ForegroundColor, Color BackgroundColor, NumericReadout &Readout, uint8 Width = 0)
+	{
+		DrawFixed(Position.X, Position.Y, Value, FractionDigits, Font, ForegroundColor, BackgroundColor, Readout, Width);
+	}
+
+	// Optional, once set the characters are drawn from the cached runs
+	void SetGlyphCache(GlyphCache *Cache)
+	{
+		m_GlyphCache = Cache;
+	}
+
+	void SetStringSpacing(int8 Character, int8 Line)
+	{
+		m_CharacterSpacing = Character;
+		m_LineSpacing = Line;
+	}
+
+	// Closed outlines join their sides with square ends, or with round ones when the cap is round
+	void SetLineCap(LineCaps Cap)
+	{
+		m_LineCap = Cap;
+	}
+
+	const Point &GetDimension(void) const
+	{
+		return m_HAL->GetDimension();
+	}
+
+private:
+	void DrawVerticalLine(int16 X, int16 Y, int16 Height, Color Color)
+	{
+		if (Height < 0)
+		{
+			Y += Height;
+			Height *= -1;
+		}
+
+		FillVerticalSpan(X, Y, Height, Color);
+	}
+
+	void DrawHorizontalLine(int16 X, int16 Y, int16 Width, Color Color)
+	{
+		if (Width < 0)
+		{
+			X += Width;
+			Width *= -1;
+		}
+
+		FillHorizontalSpan(X, Y, Width, Color);
+	}
+
+	// Pixels whose centers are in InnerDiameter / 2 <= Distance < OuterDiameter / 2, one or two spans per row
+	void FillRing(int16 X0, int16 Y0, int32 OuterDiameter, int32 InnerDiameter, Color Color)
+	{
+		const Rect clip = GetClipRect();
+
+		const int32 top = Math::Max<int32>(Y0 - (OuterDiameter / 2), clip.Position.Y);
+		const int32 bottom = Math::Min<int32>(Y0 + (OuterDiameter / 2), clip.Position.Y + clip.Dimension.Y - 1);
+
+		for (int32 y = top; y <= bottom; ++y)
+		{
+			int32 lefts[2];
+			int32 rights[2];
+			const uint8 spanCount = GetRingSpans(OuterDiameter, InnerDiameter, y - Y0, lefts, rights);
+
+			for (uint8 i = 0; i < spanCount; ++i)
+				FillHorizontalSpan(X0 + lefts[i], y, rights[i] - lefts[i] + 1, Color);
+		}
+	}
+
+	// The pixels of FillRing in the clockwise sweep from StartAngle to EndAngle, row by row
+	// The center pixel has no angle and is left out
+	void FillArc(int16 X0, int16 Y0, int32 OuterDiameter, int32 InnerDiameter, uint16 StartAngle, uint16 EndAngle, Color Color)
+	{
+		if (StartAngle == EndAngle)
+			return;
+
+		const ArcSweep sweep = GetArcSweep(StartAngle, EndAngle);
+
+		const Rect clip = GetClipRect();
+
+		const int32 top = Math::Max<int32>(Y0 - (OuterDiameter / 2), clip.Position.Y);
+		const int32 bottom = Math::Min<int32>(Y0 + (OuterDiameter / 2), clip.Position.Y + clip.Dimension.Y - 1);
+
+		for (int32 y = top; y <= bottom; ++y)
+		{
+			int32 lefts[2];
+			int32 rights[2];
+			const uint8 spanCount = GetRingSpans(OuterDiameter, InnerDiameter, y - Y0, lefts, rights);
+
+			for (uint8 i = 0; i < sweep.Count; ++i)
+			{
+				int32 startLeft, startRight, endLeft, endRight;
+				GetRaySideColumns(sweep.Cosines[i], sweep.Sines[i], y - Y0, true, startLeft, startRight);
+				GetRaySideColumns(sweep.Cosines[i + 1], sweep.Sines[i + 1], y - Y0, false, endLeft, endRight);
+
+				const int32 sweepLeft = Math::Max(startLeft, endLeft);
+				const int32 sweepRight = Math::Min(startRight, endRight);
+
+				for (uint8 j = 0; j < spanCount; ++j)
+				{
+					const int32 left = Math::Max(sweepLeft, lefts[j]);
+					const int32 right = Math::Min(sweepRight, rights[j]);
+
+					if (left <= right)
+						FillHorizontalSpan(X0 + left, y, right - left + 1, Color);
+				}
+			}
+		}
+	}
+
+	static ArcSweep GetArcSweep(uint16 StartAngle, uint16 EndAngle)
+	{
+		const uint16 sweep = EndAngle - StartAngle;
+
+		uint16 angles[3] = {StartAngle, EndAngle, EndAngle};
+
+		ArcSweep result;
+		result.Count = 1;
+
+		if (sweep >= FixedTrigonometry::ANGLE_180)
+		{
+			angles[1] = StartAngle + (sweep / 2);
+			result.Count = 2;
+		}
+
+		for (uint8 i = 0; i <= result.Count; ++i)
+		{
+			result.Cosines[i] = FixedTrigonometry::Cosine(angles[i]);
+			result.Sines[i] = FixedTrigonometry::Sine(angles[i]);
+		}
+
+		return result;
+	}
+
+	// Same sides as GetRaySideColumns, for a single pixel relative to the center
+	static bool IsInArcSweep(const ArcSweep &Sweep, int32 X, int32 Y)
+	{
+		for (uint8 i = 0; i < Sweep.Count; ++i)
+			if ((Sweep.Cosines[i] * Y) - (Sweep.Sines[i] * X) >= 0 && (Sweep.Cosines[i + 1] * Y) - (Sweep.Sines[i + 1] * X) < 0)
+				return true;
+
+		return false;
+	}
+
+	// Columns of the ring on the row Y relative to its center, doubled diameters keep odd thicknesses integer
+	static uint8 GetRingSpans(int64 OuterDiameter, int64 InnerDiameter, int32 Y, int32 *Lefts, int32 *Rights)
+	{
+		const int64 distanceY = 4 * static_cast<int64>(Y) * Y;
+		if (distanceY >= OuterDiameter * OuterDiameter)
+			return 0;
+
+		const int32 outerHalfWidth = IntegerSquareRoot(((OuterDiameter * OuterDiameter) - distanceY - 1) / 4);
+
+		if (InnerDiameter <= 0 || distanceY >= InnerDiameter * InnerDiameter)
+		{
+			Lefts[0] = -outerHalfWidth;
+			Rights[0] = outerHalfWidth;
+
+			return 1;
+		}
+
+		const int32 innerHalfWidth = IntegerSquareRoot(((InnerDiameter * InnerDiameter) - distanceY - 1) / 4);
+
+		Lefts[0] = -outerHalfWidth;
+		Rights[0] = -innerHalfWidth - 1;
+		Lefts[1] = innerHalfWidth + 1;
+		Rights[1] = outerHalfWidth;
+
+		return 2;
+	}
+
+	// Columns of the row Y relative to the center on the clockwise side of the ray, Cosine * Y - Sine * X >= 0,
+	// or on the other side of it
+	static void GetRaySideColumns(int32 Cosine, int32 Sine, int32 Y, bool IsClockwiseSide, int32 &Left, int32 &Right)
+	{
+		const int32 product = Cosine * Y;
+
+		// Unbounded, as far as int16 coordinates go
+		Left = -32768;
+		Right = 32767;
+
+		if (Sine == 0)
+		{
+			if ((product >= 0) != IsClockwiseSide)
+			{
+				Left = 0;
+				Right = -1;
+			}
+
+			return;
+		}
+
+		if (Sine > 0)
+		{
+			const int32 bound = FloorDivide(product, Sine);
+
+			if (IsClockwiseSide)
+				Right = bound;
+			else
+				Left = bound + 1;
+		}
+		else
+		{
+			const int32 bound = -FloorDivide(-product, Sine);
+
+			if (IsClockwiseSide)
+				Left = bound;
+			else
+				Right = bound - 1;
+		}
+	}
+
+	static int32 FloorDivide(int32 Numerator, int32 Denominator)
+	{
+		int32 quotient = Numerator / Denominator;
+		if ((Numerator % Denominator) != 0 && ((Numerator < 0) != (Denominator < 0)))
+			--quotient;
+
+		return quotient;
+	}
+
+	static bool IsBitSet(const uint8 *Data, uint16 Bit)
+	{
+		return ((Data[Bit >> 3] & (0x80 >> (Bit & 7))) != 0);
+	}
+
+	static uint8 GetAdvance(const PackedFont &Font, char Char)
+	{
+		if (Char < Font.FirstChar || Font.LastChar < Char)
+			return 0;
+
+		return Font.Glyphs[Char - Font.FirstChar].Advance;
+	}
+
+	static int8 GetKerning(const PackedFont &Font, char Left, char Right)
+	{
+		if (Left == '\0')
+			return 0;
+
+		int32 low = 0;
+		int32 high = Font.KerningPairCount - 1;
+		while (low <= high)
+		{
+			int32 middle = (low + high) / 2;
+			const KerningPair &pair = Font.KerningPairs[middle];
+
+			int32 compare = (pair.Left != Left ? (uint8)pair.Left - (uint8)Left : (uint8)pair.Right - (uint8)Right);
+			if (compare == 0)
+				return pair.Offset;
+
+			if (compare < 0)
+				low = middle + 1;
+			else
+				high = middle - 1;
+		}
+
+		return 0;
+	}
+
+	void DrawReadout(int16 X, int16 Y, cstr Text, uint8 Length, const Font &Font, Color ForegroundColor, Color BackgroundColor, NumericReadout &Readout, uint8 Width)
+	{
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
+		ASSERT(Width <= NumericReadout::MAX_LENGTH, "Width is out of range");
+		ASSERT(m_CharacterSpacing >= 0, "Cells of a readout cannot overlap");
+
+		const uint8 cellWidth = (Font.Width * Font.Scale) + m_CharacterSpacing;
+		const uint16 foregroundColor = ForegroundColor.R5G6B5();
+		const uint16 backgroundColor = BackgroundColor.R5G6B5();
+
+		// Otherwise the previous text is somewhere else or looks different
+		const bool isInPlace = (Readout.X == X && Readout.Y == Y && Readout.FontData == Font.Data && Readout.FontScale == Font.Scale &&
+								Readout.CellWidth == cellWidth && Readout.ForegroundColor == foregroundColor && Readout.BackgroundColor == backgroundColor);
+		const uint8 previousLength = (isInPlace ? Readout.Length : 0);
+
+		const uint8 padding = (Length < Width ? Width - Length : 0);
+		const uint8 length = padding + Length;
+
+		// Cells left over from a longer text are drawn blank
+		const uint8 count = Math::Max(length, previousLength);
+		for (uint8 i = 0; i < count; ++i)
+		{
+			const char ch = (padding <= i && i < length ? Text[i - padding] : ' ');
+
+			if (i < previousLength && Readout.Text[i] == ch)
+				continue;
+
+			DrawCell(X + (i * cellWidth), Y, cellWidth, ch, Font, foregroundColor, backgroundColor);
+		}
+
+		for (uint8 i = 0; i < length; ++i)
+			Readout.Text[i] = (i < padding ? ' ' : Text[i - padding]);
+
+		Readout.Length = length;
+		Readout.X = X;
+		Readout.Y = Y;
+		Readout.FontData = Font.Data;
+		Readout.FontScale = Font.Scale;
+		Readout.CellWidth = cellWidth;
+		Readout.ForegroundColor = foregroundColor;
+		Readout.BackgroundColor = backgroundColor;
+	}
+
+	// Whole rows of a character cell, background included, with the same nearest placement as DrawCharacter
+	void DrawCell(int16 X, int16 Y, uint8 CellWidth, char Char, const Font &Font, uint16 ForegroundColor, uint16 BackgroundColor)
+	{
+		const uint8 MAX_SCALED_SIZE = 128;
+
+		ASSERT(CellWidth <= MAX_SCALED_SIZE, "Running out of max scaled size");
 
-		uint16 maxX = RightBottomX;
-		uint16 maxY = RightBottomY;
+		const uint8 height = Font.Height * Font.Scale;
+		if (!IsVisible(X, Y, CellWidth, height))
+			return;
 
-		// TODO: Handle the middle point
-		if (LeftTopX != LeftBottomX)
-		{
-			minX = Math::Max(LeftTopX, LeftBottomX);
+		const Rect clip = GetClipRect();
 
-			DrawFilledTriangle(LeftTopX, LeftTopY, LeftTopX, LeftBottomY, LeftBottomX, LeftBottomY, Color);
-		}
+		const int16 visibleX = Math::Max<int16>(X, clip.Position.X);
+		const uint16 skippedWidth = visibleX - X;
+		const uint16 visibleWidth = Math::Min<int32>(X + CellWidth, clip.Position.X + clip.Dimension.X) - visibleX;
 
-		// TODO: Handle the middle point
-		if (LeftTopY != RightTopY)
-		{
-			minY = Math::Max(LeftTopY, RightTopY);
+		const uint16 *dataPtr = nullptr;
+		if (' ' <= Char && Char <= '~')
+			dataPtr = Font.Data + ((Char - ' ') * Font.Height);
 
-			DrawFilledTriangle(LeftTopX, LeftTopY, LeftTopX, RightTopY, RightBottomX, RightBottomY, Color);
-		}
+		uint16 row[MAX_SCALED_SIZE];
 
-		if (RightTopX != RightBottomX)
+		uint8 sourceY = 0;
+		for (uint8 y = 0; y < height; ++y)
 		{
-			maxX = Math::Min(RightTopX, RightBottomX);
+			// The last source row landing on this row, like DrawCharacter
+			uint16 data = 0;
+			for (; dataPtr != nullptr && sourceY < Font.Height && (uint8)(sourceY * Font.Scale) == y; ++sourceY)
+				data = dataPtr[sourceY];
 
-			uint16 y2 = RightBottomY;
-			if (RightTopX > RightBottomX)
-				y2 = RightTopY;
+			const int16 rowY = Y + y;
+			if (rowY < clip.Position.Y || rowY >= clip.Position.Y + clip.Dimension.Y)
+				continue;
 
-			DrawFilledTriangle(RightTopX, RightTopY, maxX, y2, RightBottomX, RightBottomY, Color);
-		}
+			for (uint8 x = 0; x < CellWidth; ++x)
+				row[x] = BackgroundColor;
 
-		// TODO: Handle the middle point
-		if (LeftBottomY != RightBottomY)
-		{
-			maxY = Math::Min(LeftBottomY, RightBottomY);
+			for (uint8 x = 0; data != 0 && x < Font.Width; ++x)
+				row[(uint8)(x * Font.Scale)] = (((1 << x) & data) == 0 ? BackgroundColor : ForegroundColor);
 
-			DrawFilledTriangle(LeftBottomX, LeftBottomY, LeftBottomX, RightBottomY, RightBottomX, RightBottomY, Color);
+			m_HAL->DrawRow({TO_UINT16(visibleX), TO_UINT16(rowY)}, row + skippedWidth, visibleWidth);
 		}
+	}
+
+	void AddPolygonEdge(int32 X0, int32 Y0, int32 X1, int32 Y1)
+	{
+		const uint8 shift = RasterizerType::SUBPIXEL_SHIFT;
 
-		DrawFilledRectangle(minX, minY, maxX - minX, maxY - minY, Color);
+		m_Rasterizer.AddEdge(X0 * (1 << shift), Y0 * (1 << shift), X1 * (1 << shift), Y1 * (1 << shift));
 	}
 
-	void DrawTriangle(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1, uint16 X2, uint16 Y2, Color Color, uint8 Thickness = 1)
+	// Corners get the round cap of one of their sides, square ends of both sides make a miter on right angles
+	void AddOutlineSide(int32 X0, int32 Y0, int32 X1, int32 Y1, uint8 Thickness)
 	{
-		DrawLine(X0, Y0, X1, Y1, Color, Thickness);
-		DrawLine(X1, Y1, X2, Y2, Color, Thickness);
-		DrawLine(X2, Y2, X0, Y0, Color, Thickness);
+		if (m_LineCap == LineCaps::Round)
+			AddStroke(GetPixelCenter(X0), GetPixelCenter(Y0), GetPixelCenter(X1), GetPixelCenter(Y1), Thickness, LineCaps::Round, LineCaps::Butt);
+		else
+			AddStroke(GetPixelCenter(X0), GetPixelCenter(Y0), GetPixelCenter(X1), GetPixelCenter(Y1), Thickness, LineCaps::Square, LineCaps::Square);
 	}
 
-	void DrawFilledTriangle(uint16 X0, uint16 Y0, uint16 X1, uint16 Y1, uint16 X2, uint16 Y2, Color Color)
+	// Adds the quad around the line between the end points, plus the polygons of the round caps, all in 24.8 fixed point
+	// Every stroke is wound the same way, so overlapping strokes get filled once
+	void AddStroke(int32 X0, int32 Y0, int32 X1, int32 Y1, uint8 Thickness, LineCaps StartCap, LineCaps EndCap)
 	{
-		int16 a, b, y, last;
+		const int32 halfWidth = (Thickness * RasterizerType::SUBPIXEL_ONE) / 2;
 
-		// Sort coordinates by Y order (y2 >= y1 >= y0)
-		if (Y0 > Y1)
-		{
-			std::swap(Y0, Y1);
-			std::swap(X0, X1);
-		}
-		if (Y1 > Y2)
-		{
-			std::swap(Y2, Y1);
-			std::swap(X2, X1);
-		}
-		if (Y0 > Y1)
-		{
-			std::swap(Y0, Y1);
-			std::swap(X0, X1);
-		}
+		int64 deltaX = X1 - X0;
+		int64 deltaY = Y1 - Y0;
 
-		if (Y0 == Y2)
+		if (deltaX == 0 && deltaY == 0)
 		{
-			// Handle awkward all-on-same-line case as its own thing
-			a = b = X0;
+			if (StartCap == LineCaps::Round || EndCap == LineCaps::Round)
+			{
+				AddRoundCap(X0, Y0, halfWidth);
 
-			if (X1 < a)
-				a = X1;
-			else if (X1 > b)
-				b = X1;
+				return;
+			}
 
-			if (X2 < a)
-				a = X2;
-			else if (X2 > b)
-				b = X2;
+			// Vertical, like the zero length lines of Thickness 1
+			deltaY = RasterizerType::SUBPIXEL_ONE;
+		}
 
-			DrawHorizontalLine(a, Y0, b - a + 1, Color);
+		const int32 startExtent = GetCapExtent(StartCap, halfWidth);
+		const int32 endExtent = GetCapExtent(EndCap, halfWidth);
 
-			return;
-		}
+		const int64 length = IntegerSquareRoot((deltaX * deltaX) + (deltaY * deltaY));
 
-		int16 dx01 = X1 - X0, dy01 = Y1 - Y0, dx02 = X2 - X0, dy02 = Y2 - Y0,
-			  dx12 = X2 - X1, dy12 = Y2 - Y1;
-		int32 sa = 0, sb = 0;
+		const int32 normalX = static_cast<int32>((-deltaY * halfWidth) / length);
+		const int32 normalY = static_cast<int32>((deltaX * halfWidth) / length);
 
-		// For upper part of triangle, find scanline crossings for segments
-		// 0-1 and 0-2.  If y1=y2 (flat-bottomed triangle), the scanline y1
-		// is included here (and second loop will be skipped, avoiding a /0
-		// error there), otherwise scanline y1 is skipped here and handled
-		// in the second loop...which also avoids a /0 error here if y0=y1
-		// (flat-topped triangle).
-		if (Y1 == Y2)
-		{
-			last = Y1; // Include y1 scanline
-		}
-		else
-		{
-			last = Y1 - 1; // Skip it
-		}
+		const int32 startX = X0 - static_cast<int32>((deltaX * startExtent) / length);
+		const int32 startY = Y0 - static_cast<int32>((deltaY * startExtent) / length);
+		const int32 endX = X1 + static_cast<int32>((deltaX * endExtent) / length);
+		const int32 endY = Y1 + static_cast<int32>((deltaY * endExtent) / length);
 
-		for (y = Y0; y < last; ++y)
-		{
-			a = X0 + sa / dy01;
-			b = X0 + sb / dy02;
-			sa += dx01;
-			sb += dx02;
-			/* longhand:
-			a = x0 + (x1 - x0) * (y - y0) / (y1 - y0);
-			b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
-			*/
-			if (a > b)
-			{
-				std::swap(a, b);
-			}
+		m_Rasterizer.AddEdge(startX + normalX, startY + normalY, endX + normalX, endY + normalY);
+		m_Rasterizer.AddEdge(endX + normalX, endY + normalY, endX - normalX, endY - normalY);
+		m_Rasterizer.AddEdge(endX - normalX, endY - normalY, startX - normalX, startY - normalY);
+		m_Rasterizer.AddEdge(startX - normalX, startY - normalY, startX + normalX, startY + normalY);
 
-			DrawHorizontalLine(a, y, b - a + 1, Color);
-		}
+		if (StartCap == LineCaps::Round)
+			AddRoundCap(X0, Y0, halfWidth);
+
+		if (EndCap == LineCaps::Round)
+			AddRoundCap(X1, Y1, halfWidth);
+	}
 
-		// For lower part of triangle, find scanline crossings for segments
-		// 0-2 and 1-2.  This loop is skipped if y1=y2.
-		sa = (int32)dx12 * (y - Y1);
-		sb = (int32)dx02 * (y - Y0);
-		for (; y < Y2; ++y)
+	// A polygon around the end point, wound like the quads of AddStroke
+	void AddRoundCap(int32 X, int32 Y, int32 Radius)
+	{
+		for (uint8 i = ROUND_CAP_VERTEX_COUNT; i > 0; --i)
 		{
-			a = X1 + sa / dy12;
-			b = X0 + sb / dy02;
-			sa += dx12;
-			sb += dx02;
-			/* longhand:
-				a = x1 + (x2 - x1) * (y - y1) / (y2 - y1);
-				b = x0 + (x2 - x0) * (y - y0) / (y2 - y0);
-			*/
-			if (a > b)
-			{
-				std::swap(a, b);
-			}
+			const uint16 angle0 = ((i % ROUND_CAP_VERTEX_COUNT) * 65536) / ROUND_CAP_VERTEX_COUNT;
+			const uint16 angle1 = ((i - 1) * 65536) / ROUND_CAP_VERTEX_COUNT;
 
-			DrawHorizontalLine(a, y, b - a + 1, Color);
+			const int32 x0 = X + ((FixedTrigonometry::Cosine(angle0) * Radius) >> FixedTrigonometry::SHIFT);
+			const int32 y0 = Y + ((FixedTrigonometry::Sine(angle0) * Radius) >> FixedTrigonometry::SHIFT);
+			const int32 x1 = X + ((FixedTrigonometry::Cosine(angle1) * Radius) >> FixedTrigonometry::SHIFT);
+			const int32 y1 = Y + ((FixedTrigonometry::Sine(angle1) * Radius) >> FixedTrigonometry::SHIFT);
+
+			m_Rasterizer.AddEdge(x0, y0, x1, y1);
 		}
 	}
 
-	void DrawCircle(uint16 X0, uint16 Y0, uint16 Radius, Color Color, uint8 Thickness = 1)
+	// 24.8 fixed point center of the pixel
+	static int32 GetPixelCenter(int32 Value)
 	{
-		--Radius;
+		return (Value * RasterizerType::SUBPIXEL_ONE) + (RasterizerType::SUBPIXEL_ONE / 2);
+	}
 
-		for (int16 r = -Thickness / 2; r < Thickness; ++r)
+	// How far a line goes past its end points, butt ends still cover the end pixels like lines of Thickness 1
+	static int32 GetCapExtent(LineCaps Cap, int32 HalfWidth)
+	{
+		switch (Cap)
 		{
-			int16 radius = Radius + r;
+		case LineCaps::Butt:
+			return RasterizerType::SUBPIXEL_ONE / 2;
 
-			int16 f = 1 - radius;
-			int16 ddF_x = 1;
-			int16 ddF_y = -2 * radius;
-			int16 x = 0;
-			int16 y = radius;
+		case LineCaps::Square:
+			return HalfWidth;
 
-			DrawPixel(X0, Y0 + radius, Color);
-			DrawPixel(X0, Y0 - radius, Color);
-			DrawPixel(X0 + radius, Y0, Color);
-			DrawPixel(X0 - radius, Y0, Color);
-
-			while (x < y)
-			{
-				if (f >= 0)
-				{
-					y--;
-					ddF_y += 2;
-					f += ddF_y;
-				}
-				x++;
-				ddF_x += 2;
-				f += ddF_x;
-
-				DrawPixel(X0 + x, Y0 + y, Color);
-				DrawPixel(X0 - x, Y0 + y, Color);
-				DrawPixel(X0 + x, Y0 - y, Color);
-				DrawPixel(X0 - x, Y0 - y, Color);
-				DrawPixel(X0 + y, Y0 + x, Color);
-				DrawPixel(X0 - y, Y0 + x, Color);
-				DrawPixel(X0 + y, Y0 - x, Color);
-				DrawPixel(X0 - y, Y0 - x, Color);
-			}
+		default:
+			return 0;
 		}
 	}
 
-	void DrawFilledCircle(uint16 X0, uint16 Y0, uint16 Radius, Color Color)
+	// Fills the edges added so far as one polygon, every covered pixel once
+	void FillPolygon(Color Color)
 	{
-		--Radius;
+		// The dropped edges leave the outline open, its spans would run to the side of the clip
+		if (m_Rasterizer.HasOverflowed())
+		{
+			m_Rasterizer.Reset();
+
+			return;
+		}
+
+		const Rect clip = GetClipRect();
+
+		m_Rasterizer.Rasterize(clip.Position.X, clip.Position.Y, clip.Position.X + clip.Dimension.X, clip.Position.Y + clip.Dimension.Y, [&](int32 X, int32 Y, int32 Length)
+							   { FillHorizontalSpan(X, Y, Length, Color); });
 
-		DrawLine(X0, Y0 - Radius, X0, Y0 + Radius + 1, Color);
+		m_Rasterizer.Reset();
+	}
 
-		const uint8 CORNER_NAME = 3;
+	// Midpoint circle, calls Handler(Y, HalfWidth) once for every row 0 <= Y <= Radius of the filled circle,
+	// each row gets the widest span of the two octants that reach it
+	template <typename RowHandler>
+	static void WalkCircleRows(int16 Radius, RowHandler Handler)
+	{
+		Handler(0, Radius);
 
 		int16 f = 1 - Radius;
 		int16 ddF_x = 1;
@@ -327,14 +1710,14 @@ public:
 		int16 x = 0;
 		int16 y = Radius;
 
-		uint16 delta = 0;
-
-		delta++;
-
 		while (x < y)
 		{
 			if (f >= 0)
 			{
+				// Row y is done, unless the other octant reaches it with a wider span
+				if (y > x + 1)
+					Handler(y, x);
+
 				y--;
 				ddF_y += 2;
 				f += ddF_y;
@@ -343,264 +1726,390 @@ public:
 			ddF_x += 2;
 			f += ddF_x;
 
-			if (CORNER_NAME & 0x1)
-			{
-				DrawLine(X0 + x, Y0 - y, X0 + x, Y0 - y + 2 * y + delta - 1, Color);
-				DrawLine(X0 + y, Y0 - x, X0 + y, Y0 - x + 2 * x + delta - 1, Color);
-			}
-
-			if (CORNER_NAME & 0x2)
-			{
-				DrawLine(X0 - x, Y0 - y, X0 - x, Y0 - y + 2 * y + delta - 1, Color);
-				DrawLine(X0 - y, Y0 - x, X0 - y, Y0 - x + 2 * x + delta - 1, Color);
-			}
+			Handler(x, y);
 		}
+
+		if (y > x)
+			Handler(y, x);
 	}
 
-	// https://www.cambridgeincolour.com/tutorials/image-interpolation.htm
-	void DrawCharacter(uint16 X, uint16 Y, char Char, const Font &Font, Color Color)
+	// Xiaolin Wu's circle, calls Handler(X, Y, Alphas, Length) for runs of pixels relative to the center, every pixel once
+	// Each column of the octants next to the vertical axis gets the two pixels around the circle, the rows of the
+	// octants next to the horizontal axis mirror them, and the pixel on the diagonal belongs to the columns
+	// The fraction of the row, sqrt(Row^2 + Error) - Row, is taken as Error / (2 * Row + 1), which is off by less than a tenth
+	// of a pixel and costs one division per column instead of a square root
+	template <typename RunHandler>
+	static void WalkAntiAliasedCircle(int32 Radius, RunHandler Handler)
 	{
-		const uint8 MAX_SCALED_SIZE = 128;
-
-		ASSERT(Font.Height * Font.Scale <= MAX_SCALED_SIZE, "Running out of max scaled size");
-
-		if (Char < ' ' || '~' < Char)
-			return;
+		const int64 radiusSquare = static_cast<int64>(Radius) * Radius;
 
-		uint8 alphaMap[MAX_SCALED_SIZE * MAX_SCALED_SIZE] = {};
-#define ALPHA_VALUE(IndexX, IndexY) alphaMap[(uint8)(IndexX) + ((uint8)(IndexY) * newWidth)]
+		// Columns on the same rows make runs
+		uint8 innerAlphas[ANTI_ALIASED_RUN_LENGTH];
+		uint8 outerAlphas[ANTI_ALIASED_RUN_LENGTH];
+		uint8 runLength = 0;
+		int32 runX = 0;
+		int32 runRow = Radius;
 
-		uint8 newWidth = Font.Width * Font.Scale;
-		uint8 newHeight = Font.Height * Font.Scale;
+		int32 row = Radius;
 
-		uint8 charIndex = Char - ' ';
-		auto dataPtr = Font.Data + (charIndex * Font.Height);
-		for (uint8 y = 0; y < Font.Height; ++y)
+		for (int32 x = 0;; ++x)
 		{
-			uint16 data = dataPtr[y];
+			const int64 remaining = radiusSquare - (static_cast<int64>(x) * x);
+			while (static_cast<int64>(row) * row > remaining)
+				--row;
 
-			for (uint8 x = 0; x < Font.Width; ++x)
-				ALPHA_VALUE(x * Font.Scale, y * Font.Scale) = (((1 << x) & data) == 0 ? 0 : 255);
-		}
+			if (row < x)
+				break;
+
+			const uint32 error = static_cast<uint32>(remaining - (static_cast<int64>(row) * row));
+			const uint8 coverage = (error * 256) / ((2 * row) + 1);
 
-		// if (Font.Scale != 1)
-		// 	for (uint8 y = 0; y < newHeight; ++y)
-		// 		for (uint8 x = 0; x < newWidth; ++x)
-		// 		{
-		// 			uint8 value = ALPHA_VALUE(x, y);
-		// 			if (value == 255)
-		// 				continue;
+			if (runLength != 0 && (row != runRow || runLength == ANTI_ALIASED_RUN_LENGTH))
+			{
+				WalkCircleQuadrants(runX, runRow, innerAlphas, runLength, Handler);
+				WalkCircleQuadrants(runX, runRow + 1, outerAlphas, runLength, Handler);
 
-		// 			uint16 sum = 0;
-		// 			sum += (x == 0 ? 0 : ALPHA_VALUE(x - 1, y));
-		// 			sum += (x + 1 == newWidth ? 0 : ALPHA_VALUE(x + 1, y));
-		// 			sum += (y == 0 ? 0 : ALPHA_VALUE(x, y - 1));
-		// 			sum += (y + 1 == newWidth ? 0 : ALPHA_VALUE(x, y + 1));
+				runLength = 0;
+			}
 
-		// 			uint8 avg = sum / 4;
+			if (runLength == 0)
+			{
+				runX = x;
+				runRow = row;
+			}
 
-		// 			ALPHA_VALUE(x, y) = avg * 1.5;
-		// 		}
+			innerAlphas[runLength] = 255 - coverage;
+			outerAlphas[runLength] = coverage;
+			++runLength;
 
-		for (uint8 y = 0; y < newHeight; ++y)
-			for (uint8 x = 0; x < newWidth; ++x)
+			if (row == x)
 			{
-				uint8 alpha = ALPHA_VALUE(x, y);
-				if (alpha == 0)
-					continue;
+				WalkCircleQuadrants(x + 1, x, &coverage, 1, Handler);
 
-				DrawPixel(X + x, Y + y, {Color.R, Color.G, Color.B, alpha});
+				break;
 			}
 
-#undef ALPHA_VALUE
-	}
+			const uint8 alphas[] = {static_cast<uint8>(255 - coverage), coverage};
+			WalkCircleQuadrants(row, x, alphas, 2, Handler);
+		}
 
-	void DrawString(uint16 X, uint16 Y, cstr const String, const Font &Font, Color Color)
-	{
-		DrawString(X, Y, String, GetStringLength(String), Font, Color);
+		if (runLength != 0)
+		{
+			WalkCircleQuadrants(runX, runRow, innerAlphas, runLength, Handler);
+			WalkCircleQuadrants(runX, runRow + 1, outerAlphas, runLength, Handler);
+		}
 	}
 
-	void DrawString(uint16 X, uint16 Y, cstr String, uint16 Length, const Font &Font, Color Color)
+	// The run [X, X + Length) on the row Y, X >= 0, mirrored into the four quadrants, the pixels on the axes only once
+	template <typename RunHandler>
+	static void WalkCircleQuadrants(int32 X, int32 Y, const uint8 *Alphas, uint8 Length, RunHandler &Handler)
 	{
-		ASSERT(String != nullptr, "String cannot be null");
+		Handler(X, Y, Alphas, Length);
 
-		if (Length == 0)
+		if (Y != 0)
+			Handler(X, -Y, Alphas, Length);
+
+		uint8 mirroredAlphas[ANTI_ALIASED_RUN_LENGTH];
+		uint8 mirroredLength = 0;
+		for (uint8 i = Length; i > 0; --i)
+			if (X + i - 1 != 0)
+				mirroredAlphas[mirroredLength++] = Alphas[i - 1];
+
+		if (mirroredLength == 0)
 			return;
 
-		uint16 x = X;
+		const int32 mirroredX = -(X + Length - 1);
 
-		for (uint16 i = 0; i < Length; ++i)
-		{
-			char ch = String[i];
+		Handler(mirroredX, Y, mirroredAlphas, mirroredLength);
 
-			if (ch == '\n' || ch == '\r')
+		if (Y != 0)
+			Handler(mirroredX, -Y, mirroredAlphas, mirroredLength);
+	}
+
+	static uint32 IntegerSquareRoot(uint64 Value)
+	{
+		uint64 result = 0;
+		uint64 bit = 1ULL << 62;
+
+		while (bit > Value)
+			bit >>= 2;
+
+		while (bit != 0)
+		{
+			if (Value >= result + bit)
 			{
-				Y += (Font.Height * Font.Scale) + m_LineSpacing;
-				x = X;
-				continue;
+				Value -= result + bit;
+				result = (result >> 1) + bit;
 			}
+			else
+				result >>= 1;
 
-			DrawCharacter(x, Y, ch, Font, Color);
-
-			x += (Font.Width * Font.Scale) + m_CharacterSpacing;
+			bit >>= 2;
 		}
+
+		return static_cast<uint32>(result);
 	}
 
-	Point MeasureCharacterDimension(char Character, const Font &Font)
+	bool IsVisible(int32 X, int32 Y, int32 Width, int32 Height) const
 	{
-		if (Character == '\n' || Character == '\r')
-			return {};
+		const Rect clip = GetClipRect();
 
-		return {TO_UINT16((Font.Width * Font.Scale) + m_CharacterSpacing), TO_UINT16((Font.Height * Font.Scale) + m_LineSpacing)};
+		return (X < clip.Position.X + clip.Dimension.X && X + Width > clip.Position.X &&
+				Y < clip.Position.Y + clip.Dimension.Y && Y + Height > clip.Position.Y);
 	}
 
-	Point MeasureStringDimension(cstr String, const Font &Font)
+	// Cohen-Sutherland out codes accept or reject most of the lines, the rest get narrowed down to the steps
+	// of the walk which land inside the clip rect, so clipping doesn't move the pixels of a line
+	bool ClipLine(int32 X0, int32 Y0, int32 X1, int32 Y1, int32 &FirstStep, int32 &LastStep) const
 	{
-		return MeasureStringDimension(String, GetStringLength(String), Font);
+		const Rect clip = GetClipRect();
+
+		const int32 left = clip.Position.X;
+		const int32 top = clip.Position.Y;
+		const int32 right = clip.Position.X + clip.Dimension.X - 1;
+		const int32 bottom = clip.Position.Y + clip.Dimension.Y - 1;
+
+		const uint8 code0 = GetOutCode(X0, Y0, left, top, right, bottom);
+		const uint8 code1 = GetOutCode(X1, Y1, left, top, right, bottom);
+
+		if ((code0 & code1) != 0 || right < left || bottom < top)
+			return false;
+
+		const int32 deltaX = Math::Absolute(X1 - X0);
+		const int32 deltaY = Math::Absolute(Y1 - Y0);
+		const int32 major = Math::Max(deltaX, deltaY);
+
+		FirstStep = 0;
+		LastStep = major;
+
+		if ((code0 | code1) == 0)
+			return true;
+
+		return ClipLineSteps(X0, Math::Sign(X1 - X0), deltaX, major, left, right, FirstStep, LastStep) &&
+			   ClipLineSteps(Y0, Math::Sign(Y1 - Y0), deltaY, major, top, bottom, FirstStep, LastStep);
 	}
 
-	Point MeasureStringDimension(cstr String, uint16 Length, const Font &Font)
+	// Narrows [FirstStep, LastStep] down to the steps where the axis stays in [Low, High], the offset never decreases
+	static bool ClipLineSteps(int32 Start, int32 Sign, int32 Delta, int32 Major, int32 Low, int32 High, int32 &FirstStep, int32 &LastStep)
 	{
-		ASSERT(String != nullptr, "String cannot be null");
+		if (Sign == 0)
+			return (Low <= Start && Start <= High);
 
-		if (Length == 0)
-			return {};
+		int32 minOffset = (Sign > 0 ? Low - Start : Start - High);
+		int32 maxOffset = (Sign > 0 ? High - Start : Start - Low);
 
-		uint16 maxCharCountPerLine = 0;
-		uint16 charCount = 0;
-		uint16 lineCount = 1;
-		for (uint16 i = 0; i < Length; ++i)
+		int32 low = FirstStep;
+		int32 high = LastStep + 1;
+		while (low < high)
 		{
-			char ch = String[i];
-
-			if (ch == '\n' || ch == '\r')
-			{
-				++lineCount;
-				charCount = 0;
+			int32 middle = (low + high) / 2;
 
-				continue;
-			}
+			if (GetLineStepOffset(middle, Major, Delta) < minOffset)
+				low = middle + 1;
+			else
+				high = middle;
+		}
+		FirstStep = low;
 
-			++charCount;
+		low = FirstStep;
+		high = LastStep + 1;
+		while (low < high)
+		{
+			int32 middle = (low + high) / 2;
 
-			if (maxCharCountPerLine < charCount)
-				maxCharCountPerLine = charCount;
+			if (GetLineStepOffset(middle, Major, Delta) <= maxOffset)
+				low = middle + 1;
+			else
+				high = middle;
 		}
+		LastStep = low - 1;
 
-		return {TO_UINT16(((Font.Width * Font.Scale) + m_CharacterSpacing) * maxCharCountPerLine), TO_UINT16(((Font.Height * Font.Scale) + m_LineSpacing) * lineCount)};
+		return (FirstStep <= LastStep);
 	}
 
-	void DrawPixel(Point Position, Color Color)
+	// Distance the walk of DrawLine has moved along an axis after Step steps, Major is the longer delta
+	static int32 GetLineStepOffset(int32 Step, int32 Major, int32 Delta)
 	{
-		DrawPixel(Position.X, Position.Y, Color);
+		return static_cast<int32>(((2 * static_cast<int64>(Step) * Delta) + Major - 1) / (2 * Major));
 	}
 
-	void DrawLine(Point Position0, Point Position1, Color Color, uint8 Thickness = 1)
+	static uint8 GetOutCode(int32 X, int32 Y, int32 Left, int32 Top, int32 Right, int32 Bottom)
 	{
-		DrawLine(Position0.X, Position0.Y, Position1.X, Position1.Y, Color, Thickness);
-	}
+		uint8 code = 0;
 
-	void DrawRectangle(Rect Rect, Color Color, uint8 Thickness = 1)
-	{
-		DrawRectangle(Rect.Position.X, Rect.Position.Y, Rect.Dimension.X, Rect.Dimension.Y, Color, Thickness);
-	}
+		if (X < Left)
+			code |= OUT_CODE_LEFT;
+		else if (X > Right)
+			code |= OUT_CODE_RIGHT;
 
-	void DrawFilledRectangle(Rect Rect, Color Color)
-	{
-		DrawFilledRectangle(Rect.Position.X, Rect.Position.Y, Rect.Dimension.X, Rect.Dimension.Y, Color);
-	}
+		if (Y < Top)
+			code |= OUT_CODE_TOP;
+		else if (Y > Bottom)
+			code |= OUT_CODE_BOTTOM;
 
-	void DrawParallelogram(Point LeftTop, Point LeftBottom, Point RightTop, Point RightBottom, Color Color, uint8 Thickness = 1)
-	{
-		DrawParallelogram(LeftTop.X, LeftTop.Y, LeftBottom.X, LeftBottom.Y, RightTop.X, RightTop.Y, RightBottom.X, RightBottom.Y, Color, Thickness);
+		return code;
 	}
 
-	void DrawFilledParallelogram(Point LeftTop, Point LeftBottom, Point RightTop, Point RightBottom, Color Color)
+	void BlendRun(const Rect &Clip, int32 X, int32 Y, const uint8 *Alphas, int32 Length, Color Color)
 	{
-		DrawFilledParallelogram(LeftTop.X, LeftTop.Y, LeftBottom.X, LeftBottom.Y, RightTop.X, RightTop.Y, RightBottom.X, RightBottom.Y, Color);
-	}
+		if (Y < Clip.Position.Y || Y >= Clip.Position.Y + Clip.Dimension.Y)
+			return;
 
-	void DrawTriangle(Point Position0, Point Position1, Point Position2, Color Color, uint8 Thickness = 1)
-	{
-		DrawTriangle(Position0.X, Position0.Y, Position1.X, Position1.Y, Position2.X, Position2.Y, Color, Thickness);
-	}
+		if (X < Clip.Position.X)
+		{
+			Alphas += Clip.Position.X - X;
+			Length -= Clip.Position.X - X;
+			X = Clip.Position.X;
+		}
 
-	void DrawFilledTriangle(Point Position0, Point Position1, Point Position2, Color Color)
-	{
-		DrawFilledTriangle(Position0.X, Position0.Y, Position1.X, Position1.Y, Position2.X, Position2.Y, Color);
-	}
+		Length = Math::Min<int32>(Length, Clip.Position.X + Clip.Dimension.X - X);
+		if (Length <= 0)
+			return;
 
-	void DrawCircle(Point Position, uint16 Radius, Color Color, uint8 Thickness = 1)
-	{
-		DrawCircle(Position.X, Position.Y, Radius, Color, Thickness);
+		m_HAL->BlendHorizontalLine({TO_UINT16(X), TO_UINT16(Y)}, Alphas, Length, Color);
 	}
 
-	void DrawFilledCircle(Point Position, uint16 Radius, Color Color)
+	// Runs of a pixel or two are cheaper in the batch than as rows of their own
+	void BlendRun(PixelBatch &Batch, const Rect &Clip, int32 X, int32 Y, const uint8 *Alphas, int32 Length, Color Color)
 	{
-		DrawFilledCircle(Position.X, Position.Y, Radius, Color);
-	}
+		if (Length > 2)
+		{
+			BlendRun(Clip, X, Y, Alphas, Length, Color);
 
-	void DrawCharacter(Point Position, char Char, const Font &Font, Color Color)
-	{
-		DrawCharacter(Position.X, Position.Y, Char, Font, Color);
-	}
+			return;
+		}
 
-	void DrawString(Point Position, cstr String, const Font &Font, Color Color)
-	{
-		DrawString(Position.X, Position.Y, String, Font, Color);
+		for (int32 i = 0; i < Length; ++i)
+			Batch.Add(X + i, Y, Alphas[i]);
 	}
 
-	void DrawString(Point Position, cstr String, uint16 Length, const Font &Font, Color Color)
+	// Opaque pixels are gathered into runs of native pixels, the translucent ones are drawn one by one
+	// Decoder skips the clipped pixels, so only the rows below the clip rect aren't decoded
+	template <typename DecoderType>
+	void BlitImage(int16 X, int16 Y, uint16 Width, uint16 Height, DecoderType &Decoder)
 	{
-		DrawString(Position.X, Position.Y, String, Length, Font, Color);
-	}
+		const Rect clip = GetClipRect();
 
-	void SetStringSpacing(int8 Character, int8 Line)
-	{
-		m_CharacterSpacing = Character;
-		m_LineSpacing = Line;
+		const int32 left = Math::Max<int32>(X, clip.Position.X);
+		const int32 top = Math::Max<int32>(Y, clip.Position.Y);
+		const int32 right = Math::Min<int32>(X + Width, clip.Position.X + clip.Dimension.X);
+		const int32 bottom = Math::Min<int32>(Y + Height, clip.Position.Y + clip.Dimension.Y);
+
+		uint16 run[IMAGE_RUN_LENGTH];
+		uint8 runLength = 0;
+		int32 runX = 0;
+
+		Decoder.Skip((top - Y) * Width);
+
+		for (int32 y = top; y < bottom; ++y)
+		{
+			auto flushRun = [&]()
+			{
+				if (runLength == 0)
+					return;
+
+				m_HAL->DrawRow({TO_UINT16(runX), TO_UINT16(y)}, run, runLength);
+				runLength = 0;
+			};
+
+			Decoder.Skip(left - X);
+
+			for (int32 x = left; x < right; ++x)
+			{
+				uint8 alpha = 0;
+				const uint16 pixel = Decoder.Read(alpha);
+
+				if (alpha == 255)
+				{
+					if (runLength == 0)
+						runX = x;
+
+					run[runLength++] = pixel;
+					if (runLength == IMAGE_RUN_LENGTH)
+						flushRun();
+
+					continue;
+				}
+
+				flushRun();
+
+				if (alpha != 0)
+					m_HAL->DrawPixel({TO_UINT16(x), TO_UINT16(y)}, ToColor(pixel, alpha));
+			}
+
+			flushRun();
+
+			Decoder.Skip((X + Width) - right);
+		}
 	}
 
-	const Point &GetDimension(void) const
+	static Color ToColor(uint16 R5G6B5, uint8 Alpha)
 	{
-		return m_HAL->GetDimension();
+		return {static_cast<uint8>((((R5G6B5 >> 11) & 0x1F) * 255) / 31),
+				static_cast<uint8>((((R5G6B5 >> 5) & 0x3F) * 255) / 63),
+				static_cast<uint8>(((R5G6B5 & 0x1F) * 255) / 31),
+				Alpha};
 	}
 
-private:
-	void DrawVerticalLine(uint16 X, uint16 Y, int16 Height, Color Color, uint8 Thickness = 1)
+	void FillHorizontalSpan(int32 X, int32 Y, int32 Length, Color Color)
 	{
-		int16 x = X - (Thickness / 2);
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
 
-		if (Height < 0)
+		const Rect clip = GetClipRect();
+		if (Y < clip.Position.Y || Y >= clip.Position.Y + clip.Dimension.Y)
+			return;
+
+		if (X < clip.Position.X)
 		{
-			Y = Math::Max(0, Y + Height);
-			Height *= -1;
+			Length -= clip.Position.X - X;
+			X = clip.Position.X;
 		}
 
-		for (uint8 tX = 0; tX < Thickness; ++tX)
-			for (uint16 i = Y; i < Y + Height; ++i)
-				DrawPixel(x + tX, i, Color);
+		Length = Math::Min<int32>(Length, clip.Position.X + clip.Dimension.X - X);
+		if (Length <= 0)
+			return;
+
+		m_HAL->DrawHorizontalLine({TO_UINT16(X), TO_UINT16(Y)}, Length, Color);
 	}
 
-	void DrawHorizontalLine(uint16 X, uint16 Y, int16 Width, Color Color, uint8 Thickness = 1)
+	void FillVerticalSpan(int32 X, int32 Y, int32 Length, Color Color)
 	{
-		int16 y = Y - (Thickness / 2);
+		ASSERT(m_HAL != nullptr, "m_HAL cannot be null");
 
-		if (Width < 0)
+		const Rect clip = GetClipRect();
+		if (X < clip.Position.X || X >= clip.Position.X + clip.Dimension.X)
+			return;
+
+		if (Y < clip.Position.Y)
 		{
-			X = Math::Max(0, X + Width);
-			Width *= -1;
+			Length -= clip.Position.Y - Y;
+			Y = clip.Position.Y;
 		}
 
-		for (uint8 tY = 0; tY < Thickness; ++tY)
-			for (uint16 i = X; i < X + Width; ++i)
-				DrawPixel(i, y + tY, Color);
+		Length = Math::Min<int32>(Length, clip.Position.Y + clip.Dimension.Y - Y);
+		if (Length <= 0)
+			return;
+
+		m_HAL->DrawVerticalLine({TO_UINT16(X), TO_UINT16(Y)}, Length, Color);
 	}
 
 private:
-	I_LCD_HAL *m_HAL;
+	HALType *m_HAL;
+	GlyphCache *m_GlyphCache;
 	int8 m_CharacterSpacing;
 	int8 m_LineSpacing;
+	LineCaps m_LineCap;
+
+	Rect m_ClipRects[MAX_CLIP_DEPTH];
+	uint8 m_ClipDepth;
+
+	RasterizerType m_Rasterizer;
+};
+
+// Binding LCDCanvasT to a concrete (final) HAL type lets the compiler inline the
+// HAL calls into the rasterization loops; LCDCanvas keeps the virtual dispatch
+class LCDCanvas : public LCDCanvasT<I_LCD_HAL>
+{
 };
 
 static constexpr uint16 DUBAI_BOLD_16_DATA[] = {
@@ -703,4 +2212,140 @@ static constexpr uint16 DUBAI_BOLD_16_DATA[] = {
 
 static constexpr Font Font_DUBAI_BOLD_16 = {14, 16, DUBAI_BOLD_16_DATA, 1};
 
+// Font_DUBAI_BOLD_16 in the packed format, same metrics and pixels
+static constexpr uint8 DUBAI_BOLD_16_PACKED_BITMAP[] = {
+	0xF9, 0x99, 0x05, 0x14, 0x10, 0x49, 0x2F, 0xC2, 0x80, 0x10, 0x41, 0x11, 0x83, 0x07, 0x02, 0x04,
+	0x18, 0x4C, 0x80, 0x00, 0x01, 0x20, 0x78, 0x78, 0x78, 0x30, 0x70, 0xF9, 0xFE, 0xFF, 0x20, 0xC0,
+	0x29, 0x2D, 0x32, 0x40, 0x85, 0x54, 0x80, 0x80, 0x10, 0x4F, 0xC4, 0x10, 0xC0, 0xC0, 0x08, 0x84,
+	0x02, 0x10, 0x08, 0x44, 0x20, 0x4A, 0x18, 0x61, 0x86, 0x18, 0x52, 0x20, 0x61, 0x08, 0x42, 0x10,
+	0x84, 0xF8, 0x48, 0x30, 0x42, 0x00, 0x42, 0x10, 0xFC, 0x90, 0x84, 0x41, 0x00, 0x22, 0xE0, 0x21,
+	0x10, 0x90, 0xC4, 0x21, 0x08, 0xF4, 0x21, 0xC1, 0x04, 0x22, 0xE0, 0x21, 0x00, 0x3E, 0x86, 0x18,
+	0x51, 0x10, 0xFC, 0x20, 0x04, 0x00, 0x82, 0x08, 0x40, 0x49, 0x14, 0x0C, 0x0A, 0x18, 0x61, 0x30,
+	0x11, 0x28, 0x61, 0x85, 0x30, 0x40, 0x01, 0x80, 0x8C, 0x8C, 0x1C, 0x83, 0xFC, 0x00, 0x3F, 0x60,
+	0xC2, 0x48, 0x00, 0x24, 0x42, 0x11, 0x10, 0x00, 0x21, 0x00, 0xC0, 0x18, 0x04, 0x24, 0x24, 0x42,
+	0x7E, 0x42, 0x81, 0x81, 0x9A, 0x18, 0x24, 0x8A, 0x18, 0x62, 0xE0, 0x08, 0xD4, 0x30, 0x82, 0x0C,
+	0x10, 0x60, 0xF0, 0xF9, 0x0A, 0x0C, 0x18, 0x30, 0x61, 0x44, 0xC0, 0xFC, 0x21, 0x08, 0x42, 0x10,
+	0xF8, 0xFC, 0x21, 0x0F, 0x42, 0x10, 0x80, 0x08, 0x32, 0x40, 0x40, 0x80, 0x8F, 0xC3, 0x43, 0x63,
+	0x1C, 0x83, 0x06, 0x0C, 0x1F, 0xF0, 0x60, 0xC1, 0x82, 0xFF, 0x80, 0x08, 0x42, 0x10, 0x84, 0x02,
+	0xE0, 0x85, 0x12, 0x45, 0x0A, 0x12, 0x22, 0x42, 0x86, 0x84, 0x21, 0x08, 0x42, 0x10, 0xF8, 0x80,
+	0xE0, 0xE0, 0xB4, 0x58, 0x4C, 0xA6, 0x23, 0x01, 0x80, 0x80, 0xC3, 0x86, 0x8C, 0x99, 0x31, 0x61,
+	0xC3, 0x82, 0x08, 0x1B, 0x10, 0x48, 0x38, 0x0C, 0x07, 0x02, 0x82, 0x22, 0x0C, 0x00, 0xFA, 0x38,
+	0x63, 0xFA, 0x08, 0x20, 0x80, 0x08, 0x1B, 0x10, 0x48, 0x38, 0x0C, 0x06, 0x02, 0x82, 0x22, 0x07,
+	0x00, 0xFA, 0x28, 0x62, 0xF2, 0x48, 0x22, 0x84, 0x11, 0x18, 0x10, 0x70, 0x30, 0x41, 0xC5, 0xE0,
+	0xFE, 0x20, 0x40, 0x81, 0x02, 0x04, 0x08, 0x10, 0xC1, 0xC1, 0xC1, 0xC1, 0xC1, 0x41, 0x41, 0x62,
+	0x18, 0x81, 0x42, 0x42, 0x42, 0x24, 0x24, 0x00, 0x18, 0x18, 0x86, 0x18, 0x01, 0x40, 0x24, 0x92,
+	0x49, 0x24, 0x92, 0x20, 0x03, 0x0C, 0x30, 0xC0, 0x40, 0x48, 0xA0, 0xC1, 0x84, 0x01, 0x21, 0x82,
+	0x86, 0x24, 0x8C, 0x20, 0x82, 0x08, 0x20, 0xFC, 0x08, 0x20, 0x80, 0x04, 0x10, 0x20, 0xFE, 0xF2,
+	0x49, 0x24, 0x92, 0x00, 0x82, 0x10, 0x02, 0x10, 0x02, 0x10, 0x42, 0xE4, 0x92, 0x49, 0x24, 0x80,
+	0x30, 0x42, 0x30, 0xC5, 0x20, 0x82, 0x08, 0x22, 0xC2, 0x18, 0x61, 0x89, 0xC0, 0x14, 0x88, 0x84,
+	0x20, 0x04, 0x10, 0x45, 0x46, 0x18, 0x61, 0x44, 0x90, 0x4C, 0x7F, 0x04, 0x18, 0x72, 0x49, 0x24,
+	0x90, 0x18, 0x60, 0x14, 0x01, 0xE0, 0x82, 0x08, 0x22, 0xC2, 0x18, 0x61, 0x86, 0x10, 0x8F, 0xC0,
+	0x8F, 0xC0, 0x82, 0x08, 0x20, 0x8A, 0x49, 0x24, 0x8A, 0x10, 0xFF, 0xC0, 0x00, 0xB3, 0x08, 0x46,
+	0x11, 0x84, 0x61, 0x18, 0x44, 0x0B, 0x08, 0x61, 0x86, 0x18, 0x40, 0x42, 0x18, 0x61, 0x00, 0xC0,
+	0x0B, 0x08, 0x61, 0x86, 0x2F, 0x00, 0x11, 0x18, 0x61, 0x84, 0x12, 0x40, 0xF8, 0x88, 0x88, 0x84,
+	0x18, 0x00, 0xB8, 0xAA, 0xA9, 0x86, 0x18, 0x61, 0x44, 0x10, 0x88, 0x50, 0xA3, 0x10, 0x88, 0x91,
+	0x05, 0x45, 0x62, 0x22, 0x48, 0x0C, 0x24, 0xC4, 0x8C, 0x52, 0xA3, 0x18, 0x10, 0x08, 0x84, 0x7C,
+	0x55, 0x95, 0x40, 0x95, 0x41, 0x54, 0x80,
+};
+
+static constexpr PackedGlyph DUBAI_BOLD_16_PACKED_GLYPHS[] = {
+	{0, 0, 0, 0, 0, 14}, // [ ]
+	{0, 1, 8, 1, 7, 14}, // [!]
+	{1, 4, 2, 1, 7, 14}, // ["]
+	{2, 6, 9, 1, 7, 14}, // [#]
+	{9, 6, 12, 1, 4, 14}, // [$]
+	{18, 3, 9, 2, 5, 14}, // [%]
+	{22, 8, 9, 1, 7, 14}, // [&]
+	{31, 1, 2, 1, 7, 14}, // [']
+	{32, 3, 9, 1, 6, 14}, // [(]
+	{36, 2, 9, 2, 7, 14}, // [)]
+	{39, 1, 1, 3, 8, 14}, // [*]
+	{40, 6, 5, 1, 10, 14}, // [+]
+	{44, 1, 2, 1, 14, 14}, // [,]
+	{45, 0, 0, 0, 0, 14}, // [-]
+	{45, 1, 2, 1, 14, 14}, // [.]
+	{46, 5, 11, 2, 5, 14}, // [/]
+	{53, 6, 9, 1, 7, 14}, // [0]
+	{60, 5, 9, 2, 7, 14}, // [1]
+	{66, 6, 9, 1, 7, 14}, // [2]
+	{73, 5, 9, 2, 7, 14}, // [3]
+	{79, 5, 9, 1, 7, 14}, // [4]
+	{85, 5, 9, 2, 7, 14}, // [5]
+	{91, 6, 9, 1, 7, 14}, // [6]
+	{98, 6, 9, 1, 7, 14}, // [7]
+	{105, 6, 9, 1, 7, 14}, // [8]
+	{112, 6, 10, 1, 6, 14}, // [9]
+	{120, 1, 6, 1, 10, 14}, // [:]
+	{121, 1, 6, 1, 10, 14}, // [;]
+	{122, 4, 4, 1, 10, 14}, // [<]
+	{124, 6, 4, 1, 10, 14}, // [=]
+	{127, 5, 5, 2, 10, 14}, // [>]
+	{131, 5, 10, 1, 6, 14}, // [?]
+	{138, 1, 2, 6, 7, 14}, // [@]
+	{139, 8, 9, 1, 7, 14}, // [A]
+	{148, 6, 9, 2, 7, 14}, // [B]
+	{155, 6, 10, 1, 6, 14}, // [C]
+	{163, 7, 9, 2, 7, 14}, // [D]
+	{171, 5, 9, 2, 7, 14}, // [E]
+	{177, 5, 9, 2, 7, 14}, // [F]
+	{183, 8, 10, 1, 6, 14}, // [G]
+	{193, 7, 9, 2, 7, 14}, // [H]
+	{201, 1, 9, 2, 7, 14}, // [I]
+	{203, 5, 9, 1, 7, 14}, // [J]
+	{209, 7, 9, 2, 7, 14}, // [K]
+	{217, 5, 9, 2, 7, 14}, // [L]
+	{223, 9, 9, 2, 7, 14}, // [M]
+	{234, 7, 9, 2, 7, 14}, // [N]
+	{242, 9, 10, 1, 6, 14}, // [O]
+	{254, 6, 9, 2, 7, 14}, // [P]
+	{261, 9, 10, 1, 6, 14}, // [Q]
+	{273, 6, 9, 2, 7, 14}, // [R]
+	{280, 6, 10, 1, 6, 14}, // [S]
+	{288, 7, 9, 1, 7, 14}, // [T]
+	{296, 8, 9, 1, 7, 14}, // [U]
+	{305, 8, 9, 1, 7, 14}, // [V]
+	{314, 12, 9, 1, 7, 14}, // [W]
+	{328, 7, 9, 1, 7, 14}, // [X]
+	{336, 6, 9, 2, 7, 14}, // [Y]
+	{343, 7, 9, 1, 7, 14}, // [Z]
+	{351, 3, 11, 2, 5, 14}, // [[]
+	{356, 5, 11, 1, 5, 14}, // [\]
+	{363, 3, 11, 1, 5, 14}, // []]
+	{368, 0, 0, 0, 0, 14}, // [^]
+	{368, 0, 0, 0, 0, 14}, // [_]
+	{368, 0, 0, 0, 0, 14}, // [`]
+	{368, 5, 7, 1, 9, 14}, // [a]
+	{373, 6, 10, 1, 6, 14}, // [b]
+	{381, 4, 7, 1, 9, 14}, // [c]
+	{385, 6, 10, 1, 6, 14}, // [d]
+	{393, 5, 6, 1, 10, 14}, // [e]
+	{397, 3, 10, 2, 6, 14}, // [f]
+	{401, 5, 7, 1, 9, 14}, // [g]
+	{406, 6, 10, 1, 6, 14}, // [h]
+	{414, 1, 10, 1, 6, 14}, // [i]
+	{416, 1, 10, 1, 6, 14}, // [j]
+	{418, 6, 10, 1, 6, 14}, // [k]
+	{426, 1, 10, 1, 6, 14}, // [l]
+	{428, 10, 7, 1, 9, 14}, // [m]
+	{437, 6, 7, 1, 9, 14}, // [n]
+	{443, 6, 6, 1, 10, 14}, // [o]
+	{448, 6, 7, 1, 9, 14}, // [p]
+	{454, 6, 7, 1, 9, 14}, // [q]
+	{460, 4, 6, 1, 10, 14}, // [r]
+	{463, 5, 6, 1, 10, 14}, // [s]
+	{467, 2, 8, 2, 8, 14}, // [t]
+	{469, 6, 6, 1, 10, 14}, // [u]
+	{474, 5, 6, 1, 10, 14}, // [v]
+	{478, 8, 6, 1, 10, 14}, // [w]
+	{484, 5, 6, 1, 10, 14}, // [x]
+	{488, 5, 6, 1, 10, 14}, // [y]
+	{492, 5, 6, 1, 10, 14}, // [z]
+	{496, 2, 9, 1, 7, 14}, // [{]
+	{499, 0, 0, 0, 0, 14}, // [|]
+	{499, 2, 11, 1, 5, 14}, // [}]
+	{502, 1, 1, 3, 11, 14}, // [~]
+};
+
+static constexpr PackedFont Font_DUBAI_BOLD_16_PACKED = {16, ' ', '~', DUBAI_BOLD_16_PACKED_GLYPHS, DUBAI_BOLD_16_PACKED_BITMAP, nullptr, 0, 1};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,203 @@
+#pragma once
+#ifndef PIXEL_FORMATS_H
+#define PIXEL_FORMATS_H
+
+#include "Common.h"
+#include "RGB565Kernels.h"
+
+// Pixel format policies of the frame buffers, every one of them provides
+// PixelType, the native pixel, and the conversions into it, so a color is converted once per primitive
+// GetBufferSize, Read, Write and FillRow, the layout of a Width*Height buffer
+// PAGE_HEIGHT, the rows a dirty page spans, which a page of the panel memory has to be sent as a whole for
+// Conversions of constant colors are done at compile time
+
+// 16 bits, native order, two bytes per pixel
+struct PixelFormatRGB565
+{
+public:
+	typedef uint16 PixelType;
+
+	static constexpr uint8 PAGE_HEIGHT = 8;
+
+public:
+	static constexpr PixelType FromRGB(uint8 R, uint8 G, uint8 B)
+	{
+		return static_cast<PixelType>(((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3));
+	}
+
+	static PixelType FromColor(const Color &Color)
+	{
+		return FromRGB(Color.R, Color.G, Color.B);
+	}
+
+	static constexpr PixelType FromR5G6B5(uint16 R5G6B5)
+	{
+		return R5G6B5;
+	}
+
+	static PixelType Blend(PixelType Foreground, PixelType Background, uint8 Alpha)
+	{
+		return RGB565Kernels::BlendPixel(Foreground, Background, Alpha);
+	}
+
+	static constexpr uint32 GetBufferSize(uint16 Width, uint16 Height)
+	{
+		return Width * Height * sizeof(uint16);
+	}
+
+	static PixelType Read(const uint8 *Buffer, uint16 Width, uint16 X, uint16 Y)
+	{
+		return reinterpret_cast<const uint16 *>(Buffer)[X + (Y * Width)];
+	}
+
+	static void Write(uint8 *Buffer, uint16 Width, uint16 X, uint16 Y, PixelType Pixel)
+	{
+		reinterpret_cast<uint16 *>(Buffer)[X + (Y * Width)] = Pixel;
+	}
+
+	static void FillRow(uint8 *Buffer, uint16 Width, uint16 X, uint16 Y, uint16 Length, PixelType Pixel)
+	{
+		RGB565Kernels::Fill(reinterpret_cast<uint16 *>(Buffer) + X + (Y * Width), Pixel, Length);
+	}
+};
+
+// 24 bits, red first, three bytes per pixel
+struct PixelFormatRGB888
+{
+public:
+	// 0x00RRGGBB
+	typedef uint32 PixelType;
+
+	static constexpr uint8 PAGE_HEIGHT = 8;
+
+public:
+	static constexpr PixelType FromRGB(uint8 R, uint8 G, uint8 B)
+	{
+		return (static_cast<PixelType>(R) << 16) | (static_cast<PixelType>(G) << 8) | B;
+	}
+
+	static PixelType FromColor(const Color &Color)
+	{
+		return FromRGB(Color.R, Color.G, Color.B);
+	}
+
+	// Channels are widened by repeating their high bits, so white stays white
+	static constexpr PixelType FromR5G6B5(uint16 R5G6B5)
+	{
+		return FromRGB(static_cast<uint8>((((R5G6B5 >> 11) & 0x1F) << 3) | ((R5G6B5 >> 13) & 0x07)),
+					   static_cast<uint8>((((R5G6B5 >> 5) & 0x3F) << 2) | ((R5G6B5 >> 9) & 0x03)),
+					   static_cast<uint8>(((R5G6B5 & 0x1F) << 3) | ((R5G6B5 >> 2) & 0x07)));
+	}
+
+	static PixelType Blend(PixelType Foreground, PixelType Background, uint8 Alpha)
+	{
+		PixelType result = 0;
+		for (uint8 shift = 0; shift < 24; shift += 8)
+		{
+			const uint32 foreground = (Foreground >> shift) & 0xFF;
+			const uint32 background = (Background >> shift) & 0xFF;
+
+			result |= (((foreground * Alpha) + (background * (255 - Alpha))) / 255) << shift;
+		}
+
+		return result;
+	}
+
+	static constexpr uint32 GetBufferSize(uint16 Width, uint16 Height)
+	{
+		return Width * Height * 3;
+	}
+
+	static PixelType Read(const uint8 *Buffer, uint16 Width, uint16 X, uint16 Y)
+	{
+		const uint8 *pixel = Buffer + ((X + (Y * Width)) * 3);
+
+		return FromRGB(pixel[0], pixel[1], pixel[2]);
+	}
+
+	static void Write(uint8 *Buffer, uint16 Width, uint16 X, uint16 Y, PixelType Pixel)
+	{
+		uint8 *pixel = Buffer + ((X + (Y * Width)) * 3);
+
+		pixel[0] = static_cast<uint8>(Pixel >> 16);
+		pixel[1] = static_cast<uint8>(Pixel >> 8);
+		pixel[2] = static_cast<uint8>(Pixel);
+	}
+
+	static void FillRow(uint8 *Buffer, uint16 Width, uint16 X, uint16 Y, uint16 Length, PixelType Pixel)
+	{
+		for (uint16 i = 0; i < Length; ++i)
+			Write(Buffer, Width, X + i, Y, Pixel);
+	}
+};
+
+// 1 bit, the page layout of SSD1306 and alike, every byte is a column of 8 rows with the top one in bit 0,
+// a page is Width of those bytes
+struct PixelFormatMonochrome
+{
+public:
+	// 0 or 1
+	typedef uint8 PixelType;
+
+	static constexpr uint8 PAGE_HEIGHT = 8;
+
+public:
+	// Lit when the luminance is at least half
+	static constexpr PixelType FromRGB(uint8 R, uint8 G, uint8 B)
+	{
+		return ((((R * 77) + (G * 150) + (B * 29)) >> 8) >= 128 ? 1 : 0);
+	}
+
+	static PixelType FromColor(const Color &Color)
+	{
+		return FromRGB(Color.R, Color.G, Color.B);
+	}
+
+	static constexpr PixelType FromR5G6B5(uint16 R5G6B5)
+	{
+		return FromRGB(static_cast<uint8>(((R5G6B5 >> 11) & 0x1F) << 3), static_cast<uint8>(((R5G6B5 >> 5) & 0x3F) << 2), static_cast<uint8>((R5G6B5 & 0x1F) << 3));
+	}
+
+	// No levels in between, the more covering one wins
+	static PixelType Blend(PixelType Foreground, PixelType Background, uint8 Alpha)
+	{
+		return (Alpha >= 128 ? Foreground : Background);
+	}
+
+	static constexpr uint32 GetBufferSize(uint16 Width, uint16 Height)
+	{
+		return Width * ((Height + PAGE_HEIGHT - 1) / PAGE_HEIGHT);
+	}
+
+	static PixelType Read(const uint8 *Buffer, uint16 Width, uint16 X, uint16 Y)
+	{
+		return (Buffer[X + ((Y / PAGE_HEIGHT) * Width)] >> (Y % PAGE_HEIGHT)) & 1;
+	}
+
+	static void Write(uint8 *Buffer, uint16 Width, uint16 X, uint16 Y, PixelType Pixel)
+	{
+		uint8 &column = Buffer[X + ((Y / PAGE_HEIGHT) * Width)];
+		const uint8 mask = 1 << (Y % PAGE_HEIGHT);
+
+		column = (Pixel != 0 ? column | mask : column & ~mask);
+	}
+
+	static void FillRow(uint8 *Buffer, uint16 Width, uint16 X, uint16 Y, uint16 Length, PixelType Pixel)
+	{
+		uint8 *column = Buffer + X + ((Y / PAGE_HEIGHT) * Width);
+		const uint8 mask = 1 << (Y % PAGE_HEIGHT);
+
+		if (Pixel != 0)
+		{
+			for (uint16 i = 0; i < Length; ++i)
+				column[i] |= mask;
+		}
+		else
+		{
+			for (uint16 i = 0; i < Length; ++i)
+				column[i] &= ~mask;
+		}
+	}
+};
+
+#endif
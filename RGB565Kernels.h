@@ -0,0 +1,255 @@
+#pragma once
+#ifndef RGB565_KERNELS_H
+#define RGB565_KERNELS_H
+
+#include "Common.h"
+
+// Pixel kernels for R5G6B5 buffers
+// IsSwapped selects buffers which hold byte swapped pixels, the order the panel expects over 8-bit SPI
+// Blending uses 33 alpha levels, (Alpha + 4) >> 3, on every channel:
+// Result = (Foreground * Alpha + Background * (32 - Alpha)) >> 5
+// which allows blending all channels of a pixel with one multiply in a 32-bit word
+class RGB565Kernels
+{
+private:
+	typedef uint32 __attribute__((__may_alias__)) AliasedUInt32;
+	typedef uint64 __attribute__((__may_alias__)) AliasedUInt64;
+
+	static constexpr uint32 SPREAD_MASK = 0x07E0F81F;
+
+public:
+	// Reference implementations, one pixel and one channel at a time, the tests check the kernels against them
+	class Scalar
+	{
+	public:
+		static uint16 Blend(uint16 Foreground, uint16 Background, uint8 Alpha)
+		{
+			uint32 alpha = GetBlendAlpha(Alpha);
+
+			uint32 r = (((Foreground >> 11) & 0x1F) * alpha + ((Background >> 11) & 0x1F) * (32 - alpha)) >> 5;
+			uint32 g = (((Foreground >> 5) & 0x3F) * alpha + ((Background >> 5) & 0x3F) * (32 - alpha)) >> 5;
+			uint32 b = ((Foreground & 0x1F) * alpha + (Background & 0x1F) * (32 - alpha)) >> 5;
+
+			return static_cast<uint16>((r << 11) | (g << 5) | b);
+		}
+
+		static void Fill(uint16 *Destination, uint16 Value, uint32 Count)
+		{
+			for (uint32 i = 0; i < Count; ++i)
+				Destination[i] = Value;
+		}
+
+		template <bool IsSwapped>
+		static void Blend(uint16 *Destination, uint16 R5G6B5, uint8 Alpha, uint32 Count)
+		{
+			for (uint32 i = 0; i < Count; ++i)
+				Destination[i] = Store<IsSwapped>(Blend(R5G6B5, Load<IsSwapped>(Destination[i]), Alpha));
+		}
+
+		template <bool IsSwapped>
+		static void BlendAlphas(uint16 *Destination, const uint8 *Alphas, uint16 R5G6B5, uint8 Alpha, uint32 Count)
+		{
+			for (uint32 i = 0; i < Count; ++i)
+				Destination[i] = Store<IsSwapped>(Blend(R5G6B5, Load<IsSwapped>(Destination[i]), ScaleAlpha(Alphas[i], Alpha)));
+		}
+
+		template <bool IsSwapped>
+		static void Copy(const uint16 *Source, uint16 *Destination, uint32 Count)
+		{
+			for (uint32 i = 0; i < Count; ++i)
+				Destination[i] = Store<IsSwapped>(Source[i]);
+		}
+	};
+
+public:
+	static uint16 BlendPixel(uint16 Foreground, uint16 Background, uint8 Alpha)
+	{
+		uint32 alpha = GetBlendAlpha(Alpha);
+
+		return Pack(((Spread(Foreground) * alpha) + (Spread(Background) * (32 - alpha))) >> 5);
+	}
+
+	template <bool IsSwapped>
+	static void BlendPixel(uint16 *Destination, uint16 R5G6B5, uint8 Alpha)
+	{
+		*Destination = Store<IsSwapped>(BlendPixel(R5G6B5, Load<IsSwapped>(*Destination), Alpha));
+	}
+
+	// Writes Value as it is, so it must already be in the order of the buffer
+	static void Fill(uint16 *Destination, uint16 Value, uint32 Count)
+	{
+		if (Count != 0 && (reinterpret_cast<uintptr_t>(Destination) & 2) != 0)
+		{
+			*Destination++ = Value;
+			--Count;
+		}
+
+		const uint32 pair = Value | (static_cast<uint32>(Value) << 16);
+
+		if (Count >= 2 && (reinterpret_cast<uintptr_t>(Destination) & 4) != 0)
+		{
+			*reinterpret_cast<AliasedUInt32 *>(Destination) = pair;
+			Destination += 2;
+			Count -= 2;
+		}
+
+		const uint64 quad = pair | (static_cast<uint64>(pair) << 32);
+
+		AliasedUInt64 *quads = reinterpret_cast<AliasedUInt64 *>(Destination);
+		for (; Count >= 8; Count -= 8, quads += 2)
+		{
+			quads[0] = quad;
+			quads[1] = quad;
+		}
+
+		Destination = reinterpret_cast<uint16 *>(quads);
+		for (uint32 i = 0; i < Count; ++i)
+			Destination[i] = Value;
+	}
+
+	template <bool IsSwapped>
+	static void Blend(uint16 *Destination, uint16 R5G6B5, uint8 Alpha, uint32 Count)
+	{
+		const uint32 alpha = GetBlendAlpha(Alpha);
+		if (alpha == 0)
+			return;
+
+		if (alpha == 32)
+		{
+			Fill(Destination, Store<IsSwapped>(R5G6B5), Count);
+			return;
+		}
+
+		const uint32 foreground = Spread(R5G6B5) * alpha;
+		const uint32 backgroundAlpha = 32 - alpha;
+
+		for (uint32 i = 0; i < Count; ++i)
+			Destination[i] = Store<IsSwapped>(Pack((foreground + (Spread(Load<IsSwapped>(Destination[i])) * backgroundAlpha)) >> 5));
+	}
+
+	// Alpha scales every value of Alphas, for translucent colors
+	template <bool IsSwapped>
+	static void BlendAlphas(uint16 *Destination, const uint8 *Alphas, uint16 R5G6B5, uint8 Alpha, uint32 Count)
+	{
+		const uint32 foreground = Spread(R5G6B5);
+		const uint16 color = Store<IsSwapped>(R5G6B5);
+
+		for (uint32 i = 0; i < Count; ++i)
+		{
+			const uint32 alpha = GetBlendAlpha(ScaleAlpha(Alphas[i], Alpha));
+			if (alpha == 0)
+				continue;
+
+			if (alpha == 32)
+			{
+				Destination[i] = color;
+				continue;
+			}
+
+			Destination[i] = Store<IsSwapped>(Pack(((foreground * alpha) + (Spread(Load<IsSwapped>(Destination[i])) * (32 - alpha))) >> 5));
+		}
+	}
+
+	// Copies native pixels into a buffer of the given order, two pixels per word when aligned
+	template <bool IsSwapped>
+	static void Copy(const uint16 *Source, uint16 *Destination, uint32 Count)
+	{
+		if (!IsSwapped)
+		{
+			Memory::Copy(reinterpret_cast<const uint8 *>(Source), reinterpret_cast<uint8 *>(Destination), Count * sizeof(uint16));
+			return;
+		}
+
+		if (Count != 0 && (reinterpret_cast<uintptr_t>(Destination) & 2) != 0)
+		{
+			*Destination++ = SWAP_ENDIAN_16BIT(*Source);
+			++Source;
+			--Count;
+		}
+
+		if ((reinterpret_cast<uintptr_t>(Source) & 2) == 0)
+		{
+			const AliasedUInt32 *sourceWords = reinterpret_cast<const AliasedUInt32 *>(Source);
+			AliasedUInt32 *destinationWords = reinterpret_cast<AliasedUInt32 *>(Destination);
+
+			for (; Count >= 2; Count -= 2)
+				*destinationWords++ = SwapHalfWords(*sourceWords++);
+
+			Source = reinterpret_cast<const uint16 *>(sourceWords);
+			Destination = reinterpret_cast<uint16 *>(destinationWords);
+		}
+
+		for (uint32 i = 0; i < Count; ++i)
+			Destination[i] = SWAP_ENDIAN_16BIT(Source[i]);
+	}
+
+	// Copies native pixels row by row, like Copy
+	template <bool IsSwapped>
+	static void CopyRectangle(const uint16 *Source, uint32 SourceStride, uint16 *Destination, uint32 DestinationStride, uint16 Width, uint16 Height)
+	{
+		for (uint16 y = 0; y < Height; ++y, Source += SourceStride, Destination += DestinationStride)
+			Copy<IsSwapped>(Source, Destination, Width);
+	}
+
+	// Looks the indices up in a 256 entry palette, which must already be in the order of the buffer
+	static void Expand(const uint8 *Indices, const uint16 *Palette, uint16 *Destination, uint32 Count)
+	{
+		for (; Count >= 4; Count -= 4, Indices += 4, Destination += 4)
+		{
+			Destination[0] = Palette[Indices[0]];
+			Destination[1] = Palette[Indices[1]];
+			Destination[2] = Palette[Indices[2]];
+			Destination[3] = Palette[Indices[3]];
+		}
+
+		for (uint32 i = 0; i < Count; ++i)
+			Destination[i] = Palette[Indices[i]];
+	}
+
+	static uint8 ScaleAlpha(uint8 Value, uint8 Alpha)
+	{
+		if (Alpha == 255)
+			return Value;
+
+		return (Value * Alpha) / 255;
+	}
+
+private:
+	static uint32 GetBlendAlpha(uint8 Alpha)
+	{
+		return (Alpha + 4) >> 3;
+	}
+
+	// Moves green to the upper half-word, leaving room for the multiplication above every channel
+	static uint32 Spread(uint16 Pixel)
+	{
+		return (Pixel | (static_cast<uint32>(Pixel) << 16)) & SPREAD_MASK;
+	}
+
+	static uint16 Pack(uint32 Value)
+	{
+		Value &= SPREAD_MASK;
+
+		return static_cast<uint16>(Value | (Value >> 16));
+	}
+
+	// Compiles to REV16 on ARM
+	static uint32 SwapHalfWords(uint32 Value)
+	{
+		return ((Value & 0xFF00FF00) >> 8) | ((Value & 0x00FF00FF) << 8);
+	}
+
+	template <bool IsSwapped>
+	static uint16 Load(uint16 Value)
+	{
+		return (IsSwapped ? SWAP_ENDIAN_16BIT(Value) : Value);
+	}
+
+	template <bool IsSwapped>
+	static uint16 Store(uint16 Value)
+	{
+		return (IsSwapped ? SWAP_ENDIAN_16BIT(Value) : Value);
+	}
+};
+
+#endif
@@ -0,0 +1,374 @@
+#pragma once
+#ifndef SPI_BUS_H
+#define SPI_BUS_H
+
+#include "Common.h"
+#include "DaisySeedHAL.h"
+#include "DSP/Debug.h"
+#include <daisy_seed.h>
+#include <atomic>
+
+// Shares one SPI peripheral between several devices, each one with its own chip select and clock settings
+// Transfers are queued by priority and started one at a time, from the main loop or the DMA completion,
+// so a short transfer of a higher priority gets in between two chunks of a long display transmission
+// Buffers are read by the DMA, they have to stay valid and flushed out of the cache until their transfer is completed
+class SPIBus
+{
+public:
+	static constexpr uint8 MAX_DEVICE_COUNT = 4;
+	static constexpr uint8 QUEUE_CAPACITY = 8;
+
+	enum class Priorities
+	{
+		// Control rate transfers, DACs, touch controllers, ...
+		High = 0,
+		Normal,
+		// Bulk transfers, displays, ...
+		Low
+	};
+
+	typedef void (*TransferCompletedCallback)(void *Context, daisy::SpiHandle::Result Result);
+
+	struct DeviceConfig
+	{
+	public:
+		GPIOPins ChipSelect;
+		// Written before every transfer, for the displays selecting between commands and data
+		bool HasDataCommand;
+		GPIOPins DataCommand;
+		daisy::SpiHandle::Config::BaudPrescaler BaudPrescaler;
+		daisy::SpiHandle::Config::ClockPolarity ClockPolarity;
+		daisy::SpiHandle::Config::ClockPhase ClockPhase;
+	};
+
+private:
+	static constexpr uint8 PRIORITY_COUNT = 3;
+	static constexpr uint8 NO_DEVICE = 0xFF;
+
+	struct DeviceState
+	{
+	public:
+		DeviceConfig Config;
+		daisy::GPIO ChipSelect;
+		daisy::GPIO DataCommand;
+		// The CFG1 and CFG2 bits of the clock settings
+		uint32 ClockCFG1;
+		uint32 ClockCFG2;
+	};
+
+	struct Transfer
+	{
+	public:
+		uint8 Device;
+		uint8 *TransmitData;
+		uint8 *ReceiveData;
+		uint16 Size;
+		bool IsData;
+		TransferCompletedCallback Callback;
+		void *Context;
+	};
+
+	struct Queue
+	{
+	public:
+		Transfer Transfers[QUEUE_CAPACITY];
+		uint8 First;
+		uint8 Count;
+	};
+
+public:
+	SPIBus(void)
+		: m_Registers(nullptr),
+		  m_IsInitialized(false),
+		  m_DeviceCount(0),
+		  m_ConfiguredDevice(NO_DEVICE),
+		  m_Queues{},
+		  m_Transfer{},
+		  m_IsBusy(false),
+		  m_IsLockRequested(false)
+	{
+	}
+
+	void Initialize(daisy::SpiHandle::Config::Peripheral Peripheral, GPIOPins SCLK, GPIOPins MOSI)
+	{
+		m_Config.direction = daisy::SpiHandle::Config::Direction::TWO_LINES_TX_ONLY;
+
+		Initialize(Peripheral, SCLK, MOSI, daisy::Pin());
+	}
+
+	// For the devices which also reply, like touch controllers
+	void Initialize(daisy::SpiHandle::Config::Peripheral Peripheral, GPIOPins SCLK, GPIOPins MOSI, GPIOPins MISO)
+	{
+		m_Config.direction = daisy::SpiHandle::Config::Direction::TWO_LINES;
+
+		Initialize(Peripheral, SCLK, MOSI, DaisySeedHALBase::GetPin((uint8)MISO));
+	}
+
+	bool IsInitialized(void) const
+	{
+		return m_IsInitialized;
+	}
+
+	// Returns the ID the transfers of the device are queued with
+	uint8 AddDevice(const DeviceConfig &Config)
+	{
+		ASSERT(m_DeviceCount < MAX_DEVICE_COUNT, "Running out of device capacity");
+
+		DeviceState &device = m_Devices[m_DeviceCount];
+		device.Config = Config;
+
+		device.ClockCFG1 = (static_cast<uint32>(Config.BaudPrescaler) << SPI_CFG1_MBR_Pos) & SPI_CFG1_MBR;
+		device.ClockCFG2 = (Config.ClockPolarity == daisy::SpiHandle::Config::ClockPolarity::HIGH ? SPI_CFG2_CPOL : 0) |
+						   (Config.ClockPhase == daisy::SpiHandle::Config::ClockPhase::TWO_EDGE ? SPI_CFG2_CPHA : 0);
+
+		daisy::GPIO::Config pinConfig;
+		pinConfig.mode = daisy::GPIO::Mode::OUTPUT;
+
+		pinConfig.pin = DaisySeedHALBase::GetPin((uint8)Config.ChipSelect);
+		device.ChipSelect.Init(pinConfig);
+		device.ChipSelect.Write(1);
+
+		if (Config.HasDataCommand)
+		{
+			pinConfig.pin = DaisySeedHALBase::GetPin((uint8)Config.DataCommand);
+			device.DataCommand.Init(pinConfig);
+		}
+
+		return m_DeviceCount++;
+	}
+
+	// Safe to call from interrupts, a completion callback can queue the next chunk of its transmission
+	// Callback is called from the DMA completion interrupt, it can be null
+	// Returns false when the queue of Priority is full, the transfer isn't queued then and has to be retried later
+	bool Enqueue(uint8 Device, uint8 *Data, uint16 Size, bool IsData, Priorities Priority, TransferCompletedCallback Callback, void *Context)
+	{
+		return Enqueue(Device, Data, nullptr, Size, IsData, Priority, Callback, Context);
+	}
+
+	// ReceiveData gets as many bytes as TransmitData sends
+	bool Enqueue(uint8 Device, uint8 *TransmitData, uint8 *ReceiveData, uint16 Size, bool IsData, Priorities Priority, TransferCompletedCallback Callback, void *Context)
+	{
+		ASSERT(Device < m_DeviceCount, "Invalid Device");
+		ASSERT(TransmitData != nullptr, "TransmitData cannot be null");
+		ASSERT(Size != 0, "Size must be greater than zero");
+		ASSERT(ReceiveData == nullptr || m_Config.direction == daisy::SpiHandle::Config::Direction::TWO_LINES, "Bus has no MISO");
+
+		{
+			daisy::ScopedIrqBlocker blocker;
+
+			Queue &queue = m_Queues[(uint8)Priority];
+			if (queue.Count == QUEUE_CAPACITY)
+				return false;
+
+			Transfer &transfer = queue.Transfers[(queue.First + queue.Count++) % QUEUE_CAPACITY];
+			transfer.Device = Device;
+			transfer.TransmitData = TransmitData;
+			transfer.ReceiveData = ReceiveData;
+			transfer.Size = Size;
+			transfer.IsData = IsData;
+			transfer.Callback = Callback;
+			transfer.Context = Context;
+
+			// The waiting BlockingTransmit goes first, its Unlock starts this one
+			if (m_IsBusy || m_IsLockRequested)
+				return true;
+
+			m_IsBusy = true;
+		}
+
+		StartNextTransfer();
+
+		return true;
+	}
+
+	// Takes the bus at the end of the running transfer, then sends without the DMA, queued transfers wait for it
+	// The wait is at most one queued transfer, up to 64 KB for a chunk of a display transmission
+	// Main loop only, for the commands which can't be queued, like the initialization sequences
+	void BlockingTransmit(uint8 Device, uint8 *Data, uint32 Size, bool IsData)
+	{
+		ASSERT(Device < m_DeviceCount, "Invalid Device");
+
+		Lock();
+
+		Select(Device, IsData);
+
+		m_SPI.BlockingTransmit(Data, Size);
+
+		m_Devices[Device].ChipSelect.Write(1);
+
+		Unlock();
+	}
+
+	bool IsBusy(void) const
+	{
+		return m_IsBusy;
+	}
+
+private:
+	void Initialize(daisy::SpiHandle::Config::Peripheral Peripheral, GPIOPins SCLK, GPIOPins MOSI, daisy::Pin MISO)
+	{
+		ASSERT(!m_IsInitialized, "Bus is already initialized");
+
+		m_Config.periph = Peripheral;
+		m_Config.mode = daisy::SpiHandle::Config::Mode::MASTER;
+		m_Config.clock_polarity = daisy::SpiHandle::Config::ClockPolarity::LOW;
+		m_Config.baud_prescaler = daisy::SpiHandle::Config::BaudPrescaler::PS_2;
+		m_Config.clock_phase = daisy::SpiHandle::Config::ClockPhase::ONE_EDGE;
+		// Every device has its own chip select
+		m_Config.nss = daisy::SpiHandle::Config::NSS::SOFT;
+		m_Config.datasize = 8;
+		m_Config.pin_config.sclk = DaisySeedHALBase::GetPin((uint8)SCLK);
+		m_Config.pin_config.mosi = DaisySeedHALBase::GetPin((uint8)MOSI);
+		m_Config.pin_config.miso = MISO;
+
+		m_SPI.Init(m_Config);
+
+		m_Registers = GetRegisters(Peripheral);
+
+		m_IsInitialized = true;
+	}
+
+	// The DMA completion hands the bus over instead of starting the next queued transfer
+	void Lock(void)
+	{
+		m_IsLockRequested = true;
+
+		while (true)
+		{
+			// Without masking the interrupts, the completion has to get through
+			while (m_IsBusy)
+				continue;
+
+			daisy::ScopedIrqBlocker blocker;
+
+			if (m_IsBusy)
+				continue;
+
+			m_IsBusy = true;
+			m_IsLockRequested = false;
+
+			return;
+		}
+	}
+
+	void Unlock(void)
+	{
+		{
+			daisy::ScopedIrqBlocker blocker;
+
+			if (!HasPendingTransfer() || m_IsLockRequested)
+			{
+				m_IsBusy = false;
+
+				return;
+			}
+		}
+
+		StartNextTransfer();
+	}
+
+	bool HasPendingTransfer(void) const
+	{
+		for (uint8 i = 0; i < PRIORITY_COUNT; ++i)
+			if (m_Queues[i].Count != 0)
+				return true;
+
+		return false;
+	}
+
+	// Called from the DMA completion too, so the clock settings are written straight into the registers instead of
+	// reinitializing the SpiHandle, the peripheral is disabled between transfers, which is when they can be written
+	void Select(uint8 Device, bool IsData)
+	{
+		DeviceState &device = m_Devices[Device];
+		const DeviceConfig &config = device.Config;
+
+		if (m_ConfiguredDevice != Device)
+		{
+			m_Registers->CFG1 = (m_Registers->CFG1 & ~SPI_CFG1_MBR) | device.ClockCFG1;
+			m_Registers->CFG2 = (m_Registers->CFG2 & ~(SPI_CFG2_CPOL | SPI_CFG2_CPHA)) | device.ClockCFG2;
+
+			m_ConfiguredDevice = Device;
+		}
+
+		if (config.HasDataCommand)
+			device.DataCommand.Write(IsData);
+
+		device.ChipSelect.Write(0);
+	}
+
+	// Called with the bus taken, from the main loop and the DMA completion
+	void StartNextTransfer(void)
+	{
+		{
+			daisy::ScopedIrqBlocker blocker;
+
+			uint8 priority = 0;
+			while (m_Queues[priority].Count == 0)
+				++priority;
+
+			Queue &queue = m_Queues[priority];
+
+			m_Transfer = queue.Transfers[queue.First];
+
+			queue.First = (queue.First + 1) % QUEUE_CAPACITY;
+			--queue.Count;
+		}
+
+		Select(m_Transfer.Device, m_Transfer.IsData);
+
+		daisy::SpiHandle::Result result;
+		if (m_Transfer.ReceiveData == nullptr)
+			result = m_SPI.DmaTransmit(m_Transfer.TransmitData, m_Transfer.Size, nullptr, &OnDMATransmissionCompleted, this);
+		else
+			result = m_SPI.DmaTransmitAndReceive(m_Transfer.TransmitData, m_Transfer.ReceiveData, m_Transfer.Size, nullptr, &OnDMATransmissionCompleted, this);
+
+		if (result != daisy::SpiHandle::Result::OK)
+			OnTransferCompleted(result);
+	}
+
+	static SPI_TypeDef *GetRegisters(daisy::SpiHandle::Config::Peripheral Peripheral)
+	{
+		static SPI_TypeDef *const REGISTERS[] = {SPI1, SPI2, SPI3, SPI4, SPI5, SPI6};
+
+		return REGISTERS[(uint8)Peripheral];
+	}
+
+	// Interrupt context
+	static void OnDMATransmissionCompleted(void *Context, daisy::SpiHandle::Result Result)
+	{
+		static_cast<SPIBus *>(Context)->OnTransferCompleted(Result);
+	}
+
+	// The callback usually queues the next chunk of its transmission, which then competes with the rest
+	void OnTransferCompleted(daisy::SpiHandle::Result Result)
+	{
+		const Transfer transfer = m_Transfer;
+
+		m_Devices[transfer.Device].ChipSelect.Write(1);
+
+		if (transfer.Callback != nullptr)
+			transfer.Callback(transfer.Context, Result);
+
+		Unlock();
+	}
+
+private:
+	daisy::SpiHandle m_SPI;
+	daisy::SpiHandle::Config m_Config;
+	SPI_TypeDef *m_Registers;
+	bool m_IsInitialized;
+
+	DeviceState m_Devices[MAX_DEVICE_COUNT];
+	uint8 m_DeviceCount;
+	uint8 m_ConfiguredDevice;
+
+	Queue m_Queues[PRIORITY_COUNT];
+	Transfer m_Transfer;
+	// Shared with the DMA completion interrupt, taken while a transfer is running
+	std::atomic<bool> m_IsBusy;
+	// BlockingTransmit is waiting for the bus
+	std::atomic<bool> m_IsLockRequested;
+};
+
+#endif
@@ -0,0 +1,201 @@
+#pragma once
+#ifndef SCANLINE_RASTERIZER_H
+#define SCANLINE_RASTERIZER_H
+
+#include "Common.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+
+// Edge table rasterizer for convex, concave and self-intersecting polygons, using the non-zero winding rule
+// Pixel centers are sampled, so a pixel is either in or out of a polygon, every covered pixel is
+// handed out by exactly one span and polygons sharing an edge don't overlap
+// Edges of several polygons can be added before rasterizing, their overlaps get filled once
+template <uint8 MaxEdgeCount>
+class ScanlineRasterizer
+{
+public:
+	// Vertices are 24.8 fixed point
+	static constexpr uint8 SUBPIXEL_SHIFT = 8;
+	static constexpr int32 SUBPIXEL_ONE = 1 << SUBPIXEL_SHIFT;
+
+private:
+	static constexpr int32 SUBPIXEL_HALF = SUBPIXEL_ONE / 2;
+
+	// X of the active edges is 16.16 fixed point
+	static constexpr uint8 X_SHIFT = 16;
+	static constexpr int64 X_ONE = 1 << X_SHIFT;
+	static constexpr int64 X_HALF = X_ONE / 2;
+
+	struct Edge
+	{
+	public:
+		int64 X;
+		int64 Step;
+		int16 FirstY;
+		int16 EndY;
+		int8 Winding;
+	};
+
+public:
+	ScanlineRasterizer(void)
+		: m_EdgeCount(0),
+		  m_MinX(0),
+		  m_MaxX(0),
+		  m_HasOverflowed(false)
+	{
+	}
+
+	void Reset(void)
+	{
+		m_EdgeCount = 0;
+		m_HasOverflowed = false;
+	}
+
+	void AddEdge(int32 X0, int32 Y0, int32 X1, int32 Y1)
+	{
+		int8 winding = 1;
+		if (Y0 > Y1)
+		{
+			std::swap(X0, X1);
+			std::swap(Y0, Y1);
+			winding = -1;
+		}
+
+		// Scanlines are [FirstY, EndY), the ones whose centers are between the end points
+		const int16 firstY = (Y0 + SUBPIXEL_HALF - 1) >> SUBPIXEL_SHIFT;
+		const int16 endY = (Y1 + SUBPIXEL_HALF - 1) >> SUBPIXEL_SHIFT;
+		if (firstY == endY)
+			return;
+
+		if (m_EdgeCount == MaxEdgeCount)
+		{
+			ASSERT(false, "Running out of edge capacity");
+
+			m_HasOverflowed = true;
+
+			return;
+		}
+
+		const int32 centerY = (firstY * SUBPIXEL_ONE) + SUBPIXEL_HALF;
+
+		if (m_EdgeCount == 0)
+		{
+			m_MinX = Math::Min(X0, X1);
+			m_MaxX = Math::Max(X0, X1);
+		}
+		else
+		{
+			m_MinX = Math::Min(m_MinX, Math::Min(X0, X1));
+			m_MaxX = Math::Max(m_MaxX, Math::Max(X0, X1));
+		}
+
+		Edge &edge = m_Edges[m_EdgeCount++];
+		edge.Step = (static_cast<int64>(X1 - X0) * X_ONE) / (Y1 - Y0);
+		edge.X = (static_cast<int64>(X0) * (X_ONE / SUBPIXEL_ONE)) + (static_cast<int64>(centerY - Y0) * (X1 - X0) * (X_ONE / SUBPIXEL_ONE)) / (Y1 - Y0);
+		edge.FirstY = firstY;
+		edge.EndY = endY;
+		edge.Winding = winding;
+	}
+
+	// Calls Handler(X, Y, Length) for the covered spans of the scanlines [Top, Bottom), top to bottom
+	// Spans aren't clipped horizontally, polygons completely outside [Left, Right) are skipped though
+	template <typename SpanHandler>
+	void Rasterize(int16 Left, int16 Top, int16 Right, int16 Bottom, SpanHandler Handler)
+	{
+		if (m_EdgeCount == 0)
+			return;
+
+		if (m_MaxX < (Left * SUBPIXEL_ONE) || (Right * SUBPIXEL_ONE) <= m_MinX)
+			return;
+
+		// The edge table, sorted by the first scanline
+		for (uint8 i = 1; i < m_EdgeCount; ++i)
+		{
+			Edge edge = m_Edges[i];
+
+			uint8 j = i;
+			for (; j > 0 && m_Edges[j - 1].FirstY > edge.FirstY; --j)
+				m_Edges[j] = m_Edges[j - 1];
+
+			m_Edges[j] = edge;
+		}
+
+		int16 endY = m_Edges[0].EndY;
+		for (uint8 i = 1; i < m_EdgeCount; ++i)
+			endY = Math::Max(endY, m_Edges[i].EndY);
+
+		endY = Math::Min(endY, Bottom);
+
+		uint8 nextEdge = 0;
+		uint8 activeCount = 0;
+
+		for (int16 y = Math::Max(m_Edges[0].FirstY, Top); y < endY; ++y)
+		{
+			// Drop the finished edges
+			uint8 count = 0;
+			for (uint8 i = 0; i < activeCount; ++i)
+				if (m_Edges[m_Active[i]].EndY > y)
+					m_Active[count++] = m_Active[i];
+			activeCount = count;
+
+			// Edges starting above Top start from the scanline they'd have reached
+			for (; nextEdge < m_EdgeCount && m_Edges[nextEdge].FirstY <= y; ++nextEdge)
+			{
+				Edge &edge = m_Edges[nextEdge];
+				if (edge.EndY <= y)
+					continue;
+
+				edge.X += edge.Step * (y - edge.FirstY);
+
+				m_Active[activeCount++] = nextEdge;
+			}
+
+			// Nearly sorted from the previous scanline
+			for (uint8 i = 1; i < activeCount; ++i)
+			{
+				uint8 index = m_Active[i];
+
+				uint8 j = i;
+				for (; j > 0 && m_Edges[m_Active[j - 1]].X > m_Edges[index].X; --j)
+					m_Active[j] = m_Active[j - 1];
+
+				m_Active[j] = index;
+			}
+
+			int32 winding = 0;
+			int32 spanX = 0;
+			for (uint8 i = 0; i < activeCount; ++i)
+			{
+				Edge &edge = m_Edges[m_Active[i]];
+
+				// First pixel whose center is on or after X
+				const int32 x = static_cast<int32>((edge.X + X_HALF - 1) >> X_SHIFT);
+
+				if (winding == 0)
+					spanX = x;
+
+				winding += edge.Winding;
+
+				if (winding == 0 && x > spanX)
+					Handler(spanX, y, x - spanX);
+
+				edge.X += edge.Step;
+			}
+		}
+	}
+
+	bool HasOverflowed(void) const
+	{
+		return m_HasOverflowed;
+	}
+
+private:
+	Edge m_Edges[MaxEdgeCount];
+	uint8 m_EdgeCount;
+	uint8 m_Active[MaxEdgeCount];
+	int32 m_MinX;
+	int32 m_MaxX;
+	bool m_HasOverflowed;
+};
+
+#endif
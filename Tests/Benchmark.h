@@ -0,0 +1,59 @@
+#pragma once
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "Common.h"
+#include <chrono>
+#include <cstdio>
+
+// Host timings, they compare two paths of the same build rather than telling the speed on the device
+class Benchmark
+{
+private:
+	static constexpr double MIN_DURATION = 0.2;
+
+public:
+	// Calls Function until MIN_DURATION has passed, prints the time per call and the throughput of the Units one call processes
+	template <typename FunctionType>
+	static double Run(cstr Name, uint32 UnitsPerCall, cstr UnitName, FunctionType Function)
+	{
+		typedef std::chrono::steady_clock Clock;
+
+		Function();
+
+		uint64 callCount = 0;
+		uint32 batchSize = 1;
+		double duration = 0;
+
+		const Clock::time_point startTime = Clock::now();
+		while (duration < MIN_DURATION)
+		{
+			for (uint32 i = 0; i < batchSize; ++i)
+				Function();
+
+			callCount += batchSize;
+			batchSize *= 2;
+
+			duration = std::chrono::duration<double>(Clock::now() - startTime).count();
+		}
+
+		const double unitsPerSecond = (callCount * UnitsPerCall) / duration;
+
+		printf("%-44s %12.1f ns %12.2f M%s/s\n", Name, (duration * 1e9) / callCount, unitsPerSecond / 1e6, UnitName);
+
+		return unitsPerSecond;
+	}
+
+	static void PrintSpeedup(cstr Name, double UnitsPerSecond, double BaselineUnitsPerSecond)
+	{
+		printf("%-44s %12.2fx\n", Name, UnitsPerSecond / BaselineUnitsPerSecond);
+	}
+
+	// Keeps the compiler from dropping what Data holds as unused
+	static void Use(const void *Data)
+	{
+		asm volatile("" : : "g"(Data) : "memory");
+	}
+};
+
+#endif
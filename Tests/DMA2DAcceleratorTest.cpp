@@ -0,0 +1,221 @@
+#include "Test.h"
+#include "DMA2DAccelerator.h"
+
+// The operations of DMA2DAccelerator on the CPU, the host has no DMA2D, against the references of RGB565Kernels::Scalar,
+// on rectangles inside a larger buffer, below, at and above the hardware threshold, into native and swapped buffers
+
+static constexpr uint16 STRIDE = 48;
+static constexpr uint16 ROW_COUNT = 24;
+static constexpr uint32 BUFFER_LENGTH = STRIDE * ROW_COUNT;
+
+struct Size
+{
+public:
+	uint16 Width;
+	uint16 Height;
+};
+
+// 15, 256 and 800 pixels, the threshold is 256
+static constexpr Size SIZES[] = {{5, 3}, {16, 16}, {40, 20}};
+static constexpr uint8 ALPHAS[] = {0, 1, 100, 128, 254, 255};
+
+static void FillRandom(uint16 *Buffer, uint32 Count)
+{
+	for (uint32 i = 0; i < Count; ++i)
+		Buffer[i] = static_cast<uint16>(rand());
+}
+
+static void FillRandom(uint8 *Buffer, uint32 Count)
+{
+	for (uint32 i = 0; i < Count; ++i)
+		Buffer[i] = static_cast<uint8>(rand());
+}
+
+// Everything around the rectangle must stay untouched
+static void CheckEqual(const uint16 *Expected, const uint16 *Actual)
+{
+	uint32 mismatchCount = 0;
+	for (uint32 i = 0; i < BUFFER_LENGTH; ++i)
+		if (Expected[i] != Actual[i])
+			++mismatchCount;
+
+	CHECK_EQUAL(0, mismatchCount);
+}
+
+static uint16 *GetRectangle(uint16 *Buffer)
+{
+	return Buffer + 3 + (2 * STRIDE);
+}
+
+static void CheckSoftwareOnly(const DMA2DAccelerator &Accelerator, uint32 OperationCount)
+{
+	CHECK_EQUAL(0, Accelerator.GetHardwareOperationCount());
+	CHECK_EQUAL(OperationCount, Accelerator.GetSoftwareOperationCount());
+	CHECK(!Accelerator.IsBusy());
+}
+
+static void TestFill(void)
+{
+	static uint16 expected[BUFFER_LENGTH];
+	static uint16 actual[BUFFER_LENGTH];
+
+	DMA2DAccelerator accelerator;
+	accelerator.Initialize();
+
+	uint32 operationCount = 0;
+
+	for (const Size &size : SIZES)
+	{
+		FillRandom(expected, BUFFER_LENGTH);
+		Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+		for (uint16 y = 0; y < size.Height; ++y)
+			RGB565Kernels::Scalar::Fill(GetRectangle(expected) + (y * STRIDE), 0x1234, size.Width);
+
+		accelerator.Fill(GetRectangle(actual), STRIDE, size.Width, size.Height, 0x1234);
+		++operationCount;
+
+		CheckEqual(expected, actual);
+		CheckSoftwareOnly(accelerator, operationCount);
+	}
+}
+
+template <bool IsSwapped>
+static void TestBlend(void)
+{
+	static uint16 expected[BUFFER_LENGTH];
+	static uint16 actual[BUFFER_LENGTH];
+
+	DMA2DAccelerator accelerator;
+	accelerator.Initialize();
+
+	uint32 operationCount = 0;
+
+	for (const Size &size : SIZES)
+		for (uint8 alpha : ALPHAS)
+		{
+			FillRandom(expected, BUFFER_LENGTH);
+			Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+			const uint16 color = static_cast<uint16>(rand());
+
+			for (uint16 y = 0; y < size.Height; ++y)
+				RGB565Kernels::Scalar::Blend<IsSwapped>(GetRectangle(expected) + (y * STRIDE), color, alpha, size.Width);
+
+			accelerator.Blend<IsSwapped>(GetRectangle(actual), STRIDE, size.Width, size.Height, color, alpha);
+
+			// Transparent ones are skipped
+			if (alpha != 0)
+				++operationCount;
+
+			CheckEqual(expected, actual);
+			CheckSoftwareOnly(accelerator, operationCount);
+		}
+}
+
+template <bool IsSwapped>
+static void TestBlendAlphas(void)
+{
+	static uint16 expected[BUFFER_LENGTH];
+	static uint16 actual[BUFFER_LENGTH];
+	static uint8 alphas[BUFFER_LENGTH];
+
+	DMA2DAccelerator accelerator;
+	accelerator.Initialize();
+
+	uint32 operationCount = 0;
+
+	for (const Size &size : SIZES)
+		for (uint8 alpha : ALPHAS)
+		{
+			FillRandom(expected, BUFFER_LENGTH);
+			Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+			FillRandom(alphas, BUFFER_LENGTH);
+
+			const uint16 color = static_cast<uint16>(rand());
+
+			for (uint16 y = 0; y < size.Height; ++y)
+				RGB565Kernels::Scalar::BlendAlphas<IsSwapped>(GetRectangle(expected) + (y * STRIDE), alphas + (y * STRIDE), color, alpha, size.Width);
+
+			accelerator.BlendAlphas<IsSwapped>(GetRectangle(actual), STRIDE, alphas, STRIDE, size.Width, size.Height, color, alpha);
+			++operationCount;
+
+			CheckEqual(expected, actual);
+			CheckSoftwareOnly(accelerator, operationCount);
+		}
+}
+
+template <bool IsSwapped>
+static void TestCopyRectangle(void)
+{
+	static uint16 source[BUFFER_LENGTH];
+	static uint16 expected[BUFFER_LENGTH];
+	static uint16 actual[BUFFER_LENGTH];
+
+	DMA2DAccelerator accelerator;
+	accelerator.Initialize();
+
+	uint32 operationCount = 0;
+
+	for (const Size &size : SIZES)
+	{
+		FillRandom(source, BUFFER_LENGTH);
+		FillRandom(expected, BUFFER_LENGTH);
+		Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+		// A narrower source stride than the destination's
+		const uint16 sourceStride = size.Width + 1;
+
+		for (uint16 y = 0; y < size.Height; ++y)
+			RGB565Kernels::Scalar::Copy<IsSwapped>(source + (y * sourceStride), GetRectangle(expected) + (y * STRIDE), size.Width);
+
+		accelerator.CopyRectangle<IsSwapped>(source, sourceStride, GetRectangle(actual), STRIDE, size.Width, size.Height);
+		++operationCount;
+
+		CheckEqual(expected, actual);
+		CheckSoftwareOnly(accelerator, operationCount);
+	}
+}
+
+// Lowering the threshold changes nothing without the unit
+static void TestThresholdWithoutHardware(void)
+{
+	static uint16 expected[BUFFER_LENGTH];
+	static uint16 actual[BUFFER_LENGTH];
+
+	DMA2DAccelerator accelerator;
+	accelerator.Initialize();
+
+	CHECK_EQUAL(DMA2DAccelerator::DEFAULT_HARDWARE_THRESHOLD, accelerator.GetHardwareThreshold());
+
+	accelerator.SetHardwareThreshold(1);
+	CHECK_EQUAL(1, accelerator.GetHardwareThreshold());
+
+	FillRandom(expected, BUFFER_LENGTH);
+	Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+	for (uint16 y = 0; y < 4; ++y)
+		RGB565Kernels::Scalar::Blend<false>(GetRectangle(expected) + (y * STRIDE), 0xF800, 100, 4);
+
+	accelerator.Blend<false>(GetRectangle(actual), STRIDE, 4, 4, 0xF800, 100);
+
+	CheckEqual(expected, actual);
+	CheckSoftwareOnly(accelerator, 1);
+}
+
+int main(void)
+{
+	srand(1);
+
+	RUN_TEST(TestFill);
+	RUN_TEST(TestBlend<false>);
+	RUN_TEST(TestBlend<true>);
+	RUN_TEST(TestBlendAlphas<false>);
+	RUN_TEST(TestBlendAlphas<true>);
+	RUN_TEST(TestCopyRectangle<false>);
+	RUN_TEST(TestCopyRectangle<true>);
+	RUN_TEST(TestThresholdWithoutHardware);
+
+	return GetTestResult();
+}
@@ -0,0 +1,180 @@
+#include "Test.h"
+#include "FrameBufferHAL.h"
+
+// Frame buffers of every pixel format against golden buffers, byte for byte, and the dirty pages they report
+
+static const Color BLACK = {0, 0, 0, 255};
+static const Color WHITE = {255, 255, 255, 255};
+static const Color RED = {255, 0, 0, 255};
+static const Color GRAY = {100, 100, 100, 255};
+
+template <typename FrameBufferType, uint32 Size>
+static void CheckBuffer(const FrameBufferType &FrameBuffer, const uint8 (&Expected)[Size])
+{
+	CHECK_EQUAL(Size, FrameBufferType::GetBufferSize());
+
+	const uint8 *buffer = FrameBuffer.GetBuffer();
+	for (uint32 i = 0; i < Size; ++i)
+		CHECK_EQUAL(Expected[i], buffer[i]);
+}
+
+template <typename FrameBufferType>
+static void PopAllDirtyPages(FrameBufferType &FrameBuffer)
+{
+	uint16 page;
+	uint16 firstColumn;
+	uint16 lastColumn;
+	while (FrameBuffer.PopDirtyPage(page, firstColumn, lastColumn))
+		continue;
+}
+
+static void TestRGB565(void)
+{
+	FrameBufferHAL<3, 2, PixelFormatRGB565> frameBuffer;
+	frameBuffer.Initialize();
+
+	frameBuffer.Clear(BLACK);
+	frameBuffer.DrawPixel({1, 0}, RED);
+	frameBuffer.DrawHorizontalLine({1, 1}, 2, {0, 0, 255, 255});
+
+	const uint16 row[] = {0x07E0};
+	frameBuffer.DrawRow({0, 1}, row, 1);
+
+	// Native order
+	const uint16 *buffer = reinterpret_cast<const uint16 *>(frameBuffer.GetBuffer());
+	const uint16 expected[] = {0x0000, 0xF800, 0x0000,
+							   0x07E0, 0x001F, 0x001F};
+
+	CHECK_EQUAL(sizeof(expected), frameBuffer.GetBufferSize());
+
+	for (uint32 i = 0; i < 6; ++i)
+		CHECK_EQUAL(expected[i], buffer[i]);
+}
+
+static void TestRGB888ByteOrder(void)
+{
+	FrameBufferHAL<4, 2, PixelFormatRGB888> frameBuffer;
+	frameBuffer.Initialize();
+
+	frameBuffer.Clear(BLACK);
+	frameBuffer.DrawPixel({1, 0}, {0x12, 0x34, 0x56, 255});
+	frameBuffer.DrawPixel({3, 0}, {255, 255, 255, 128});
+	frameBuffer.DrawFilledRectangle({2, 1, 2, 1}, RED);
+
+	// Widened by repeating the high bits
+	const uint16 row[] = {0x07E0};
+	frameBuffer.DrawRow({0, 1}, row, 1);
+
+	// Red first, three bytes per pixel
+	const uint8 expected[] = {0x00, 0x00, 0x00, 0x12, 0x34, 0x56, 0x00, 0x00, 0x00, 0x80, 0x80, 0x80,
+							  0x00, 0xFF, 0x00, 0x00, 0x00, 0x00, 0xFF, 0x00, 0x00, 0xFF, 0x00, 0x00};
+	CheckBuffer(frameBuffer, expected);
+}
+
+static void TestMonochromePagePacking(void)
+{
+	FrameBufferHAL<6, 16, PixelFormatMonochrome> frameBuffer;
+	frameBuffer.Initialize();
+
+	frameBuffer.Clear(BLACK);
+
+	// Top and bottom rows of the first page
+	frameBuffer.DrawPixel({0, 0}, WHITE);
+	frameBuffer.DrawPixel({1, 7}, WHITE);
+
+	// Below the half luminance
+	frameBuffer.DrawPixel({5, 0}, GRAY);
+
+	// Across both pages
+	frameBuffer.DrawVerticalLine({2, 4}, 8, WHITE);
+
+	frameBuffer.DrawHorizontalLine({3, 9}, 3, WHITE);
+
+	// The more covering one wins
+	const uint8 alphas[] = {255, 127, 128};
+	frameBuffer.BlendHorizontalLine({0, 15}, alphas, 3, WHITE);
+
+	// A byte is a column of 8 rows, the top one in bit 0, a page is a row of those bytes
+	const uint8 expected[] = {0x01, 0x80, 0xF0, 0x00, 0x00, 0x00,
+							  0x80, 0x00, 0x8F, 0x02, 0x02, 0x02};
+	CheckBuffer(frameBuffer, expected);
+
+	// Cleared to black, the other columns keep their bits
+	frameBuffer.DrawFilledRectangle({2, 0, 1, 16}, BLACK);
+	CHECK_EQUAL(0x00, frameBuffer.GetBuffer()[2]);
+	CHECK_EQUAL(0x00, frameBuffer.GetBuffer()[8]);
+	CHECK_EQUAL(0x80, frameBuffer.GetBuffer()[6]);
+}
+
+// Scattered pixels of one color, the same bytes as drawn one by one
+static void TestScatteredPixels(void)
+{
+	FrameBufferHAL<4, 2, PixelFormatRGB888> frameBuffer;
+	frameBuffer.Initialize();
+
+	frameBuffer.Clear(BLACK);
+
+	// The one outside is dropped
+	const Point positions[] = {{0, 0}, {2, 0}, {1, 1}, {4, 1}};
+	frameBuffer.DrawPixels(positions, 4, {0x12, 0x34, 0x56, 255});
+
+	const uint8 alphas[] = {128, 0, 255, 255};
+	frameBuffer.BlendPixels(positions, alphas, 4, WHITE);
+
+	const uint8 expected[] = {0x88, 0x99, 0xAA, 0x00, 0x00, 0x00, 0x12, 0x34, 0x56, 0x00, 0x00, 0x00,
+							  0x00, 0x00, 0x00, 0xFF, 0xFF, 0xFF, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
+	CheckBuffer(frameBuffer, expected);
+}
+
+static void TestDirtyPages(void)
+{
+	FrameBufferHAL<6, 24, PixelFormatMonochrome> frameBuffer;
+	frameBuffer.Initialize();
+
+	// Everything is dirty after Initialize
+	CHECK(frameBuffer.IsDirty());
+	PopAllDirtyPages(frameBuffer);
+	CHECK(!frameBuffer.IsDirty());
+
+	frameBuffer.DrawPixel({4, 12}, WHITE);
+	frameBuffer.DrawPixel({1, 13}, WHITE);
+	frameBuffer.DrawVerticalLine({3, 20}, 4, WHITE);
+
+	uint16 page;
+	uint16 firstColumn;
+	uint16 lastColumn;
+
+	CHECK(frameBuffer.PopDirtyPage(page, firstColumn, lastColumn));
+	CHECK_EQUAL(1, page);
+	CHECK_EQUAL(1, firstColumn);
+	CHECK_EQUAL(4, lastColumn);
+
+	CHECK(frameBuffer.PopDirtyPage(page, firstColumn, lastColumn));
+	CHECK_EQUAL(2, page);
+	CHECK_EQUAL(3, firstColumn);
+	CHECK_EQUAL(3, lastColumn);
+
+	CHECK(!frameBuffer.PopDirtyPage(page, firstColumn, lastColumn));
+
+	// Clipped to the surface
+	frameBuffer.DrawHorizontalLine({4, 0}, 10, WHITE);
+	frameBuffer.DrawPixel({6, 0}, WHITE);
+
+	CHECK(frameBuffer.PopDirtyPage(page, firstColumn, lastColumn));
+	CHECK_EQUAL(0, page);
+	CHECK_EQUAL(4, firstColumn);
+	CHECK_EQUAL(5, lastColumn);
+
+	CHECK(!frameBuffer.IsDirty());
+}
+
+int main(void)
+{
+	RUN_TEST(TestRGB565);
+	RUN_TEST(TestRGB888ByteOrder);
+	RUN_TEST(TestMonochromePagePacking);
+	RUN_TEST(TestScatteredPixels);
+	RUN_TEST(TestDirtyPages);
+
+	return GetTestResult();
+}
@@ -0,0 +1,138 @@
+#include "Test.h"
+#include "ILI9341_HAL.h"
+#include <vector>
+
+// Palette mode transmissions against the SpiHandle stand-in, the line buffers are expanded by Update
+// and the DMA completion only sends them
+
+typedef ILI9341_HAL_320_240 ScreenType;
+typedef daisy::SpiHandle::Result Result;
+
+static constexpr uint32 LINE_BUFFER_SIZE = 4 * 320 * sizeof(uint16);
+static constexpr uint32 FRAME_SIZE = 320 * 240 * sizeof(uint16);
+
+// Exactly in the default palette
+static const Color RED = {255, 0, 0, 255};
+
+// Bytes of the pixel data, the transfers of the address window are 4 bytes at most
+static std::vector<uint8> g_Pixels;
+
+static void OnTransmit(const uint8_t *Data, size_t Size)
+{
+	if (Size <= 4)
+		return;
+
+	g_Pixels.insert(g_Pixels.end(), Data, Data + Size);
+}
+
+struct Scene
+{
+public:
+	Scene(void)
+		: Screen(&HAL, GPIOPins::Pin0, GPIOPins::Pin1, GPIOPins::Pin2, GPIOPins::Pin3, GPIOPins::Pin4, I_LCD_HAL::Orientations::ToRight, ScreenType::FrameBufferModes::Palette),
+		  IsDrawing(false)
+	{
+		daisy::SpiHandle::Reset();
+
+		Screen.Initialize();
+		Screen.SetOnRender({this, &OnRender});
+
+		daisy::SpiHandle::OnTransmit = &OnTransmit;
+
+		g_Pixels.clear();
+	}
+
+	// Draws the next frame only
+	static void OnRender(void *Context)
+	{
+		Scene &scene = *static_cast<Scene *>(Context);
+
+		if (!scene.IsDrawing)
+			return;
+
+		scene.IsDrawing = false;
+
+		scene.Screen.Clear(RED);
+	}
+
+	void Draw(void)
+	{
+		IsDrawing = true;
+
+		while (!daisy::SpiHandle::IsTransferRunning())
+			Screen.Update();
+	}
+
+	// Longer than a frame, the following ones have nothing to send
+	void Run(void)
+	{
+		for (uint16 i = 0; i < 500; ++i)
+		{
+			Screen.Update();
+
+			while (daisy::SpiHandle::Complete())
+				continue;
+		}
+	}
+
+public:
+	IHAL HAL;
+	ScreenType Screen;
+	bool IsDrawing;
+};
+
+static void CheckPixels(uint32 Size)
+{
+	CHECK_EQUAL(Size, g_Pixels.size());
+
+	uint32 mismatchCount = 0;
+	for (uint32 i = 0; i + 1 < g_Pixels.size(); i += 2)
+		if (((g_Pixels[i] << 8) | g_Pixels[i + 1]) != PixelFormatRGB565::FromRGB(RED.R, RED.G, RED.B))
+			++mismatchCount;
+
+	CHECK_EQUAL(0, mismatchCount);
+}
+
+static void TestInterruptOnlySendsExpandedRows(void)
+{
+	static Scene scene;
+
+	scene.Draw();
+
+	// Without Update, nothing more than the two line buffers expanded before the transmission started
+	while (daisy::SpiHandle::Complete())
+		continue;
+
+	CheckPixels(2 * LINE_BUFFER_SIZE);
+
+	scene.Run();
+
+	CheckPixels(FRAME_SIZE);
+	CHECK(scene.Screen.GetTransmitTime() != 0);
+}
+
+static void TestFailedTransferResendsTheFrame(void)
+{
+	static Scene scene;
+
+	scene.Draw();
+	scene.Run();
+
+	g_Pixels.clear();
+
+	// Nothing but the window of the first dirty region makes it, the next frames send everything again
+	scene.Draw();
+	CHECK(daisy::SpiHandle::Complete(Result::ERR));
+
+	scene.Run();
+
+	CheckPixels(FRAME_SIZE);
+}
+
+int main(void)
+{
+	RUN_TEST(TestInterruptOnlySendsExpandedRows);
+	RUN_TEST(TestFailedTransferResendsTheFrame);
+
+	return GetTestResult();
+}
@@ -0,0 +1,237 @@
+#include "Benchmark.h"
+#include "ILI9341_HAL.h"
+#include "LCDCanvas.h"
+#include <vector>
+
+// Decode rates of RLE565 and QOI, on their own and drawn into the frame buffer of ILI9341_HAL, against drawing the raw pixels
+// The image is an icon like one, flat areas, a gradient and a noisy patch, encoded like Tools/ImageToAsset.py does
+
+static constexpr uint16 WIDTH = 128;
+static constexpr uint16 HEIGHT = 128;
+static constexpr uint32 PIXEL_COUNT = WIDTH * HEIGHT;
+
+struct Pixel
+{
+public:
+	uint8 R;
+	uint8 G;
+	uint8 B;
+	uint8 A;
+
+	bool operator==(const Pixel &Other) const
+	{
+		return (R == Other.R && G == Other.G && B == Other.B && A == Other.A);
+	}
+};
+
+static std::vector<Pixel> MakePixels(void)
+{
+	std::vector<Pixel> pixels(PIXEL_COUNT);
+
+	for (int32 y = 0; y < HEIGHT; ++y)
+		for (int32 x = 0; x < WIDTH; ++x)
+		{
+			Pixel &pixel = pixels[x + (y * WIDTH)];
+
+			const int32 centerX = x - 64;
+			const int32 centerY = y - 64;
+
+			if ((centerX * centerX) + (centerY * centerY) < 48 * 48)
+				pixel = {static_cast<uint8>(40 + y), static_cast<uint8>(200 - y), 180, 255};
+			else if (x >= 96 && y >= 96)
+				pixel = {static_cast<uint8>(rand()), static_cast<uint8>(rand()), static_cast<uint8>(rand()), 255};
+			else
+				pixel = {16, 16, 24, 255};
+		}
+
+	return pixels;
+}
+
+static std::vector<uint8> EncodeRLE565(const std::vector<Pixel> &Pixels)
+{
+	std::vector<uint16> values;
+	for (const Pixel &pixel : Pixels)
+		values.push_back(PixelFormatRGB565::FromRGB(pixel.R, pixel.G, pixel.B));
+
+	std::vector<uint8> data;
+
+	uint32 i = 0;
+	while (i < values.size())
+	{
+		uint32 run = 1;
+		while (i + run < values.size() && run < 128 && values[i + run] == values[i])
+			++run;
+
+		if (run > 1)
+		{
+			data.insert(data.end(), {static_cast<uint8>(0x80 | (run - 1)), static_cast<uint8>(values[i]), static_cast<uint8>(values[i] >> 8)});
+			i += run;
+
+			continue;
+		}
+
+		// Literals stop where a run of at least 2 begins
+		uint32 count = 1;
+		while (i + count < values.size() && count < 128 && !(i + count + 1 < values.size() && values[i + count] == values[i + count + 1]))
+			++count;
+
+		data.push_back(static_cast<uint8>(count - 1));
+		for (uint32 j = i; j < i + count; ++j)
+			data.insert(data.end(), {static_cast<uint8>(values[j]), static_cast<uint8>(values[j] >> 8)});
+
+		i += count;
+	}
+
+	return data;
+}
+
+static std::vector<uint8> EncodeQOI(const std::vector<Pixel> &Pixels)
+{
+	std::vector<uint8> data = {'q', 'o', 'i', 'f', 0, 0, 0, WIDTH, 0, 0, 0, HEIGHT, 4, 0};
+
+	Pixel index[64] = {};
+	Pixel previous = {0, 0, 0, 255};
+	uint8 run = 0;
+
+	for (uint32 i = 0; i < Pixels.size(); ++i)
+	{
+		const Pixel &pixel = Pixels[i];
+
+		if (pixel == previous)
+		{
+			if (++run == 62 || i == Pixels.size() - 1)
+			{
+				data.push_back(0xC0 | (run - 1));
+				run = 0;
+			}
+
+			continue;
+		}
+
+		if (run > 0)
+		{
+			data.push_back(0xC0 | (run - 1));
+			run = 0;
+		}
+
+		const uint8 position = ((pixel.R * 3) + (pixel.G * 5) + (pixel.B * 7) + (pixel.A * 11)) % 64;
+
+		const int8 dr = pixel.R - previous.R;
+		const int8 dg = pixel.G - previous.G;
+		const int8 db = pixel.B - previous.B;
+		const int32 drg = dr - dg;
+		const int32 dbg = db - dg;
+
+		if (index[position] == pixel)
+			data.push_back(position);
+		else if (pixel.A != previous.A)
+			data.insert(data.end(), {0xFF, pixel.R, pixel.G, pixel.B, pixel.A});
+		else if (-2 <= dr && dr <= 1 && -2 <= dg && dg <= 1 && -2 <= db && db <= 1)
+			data.push_back(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+		else if (-32 <= dg && dg <= 31 && -8 <= drg && drg <= 7 && -8 <= dbg && dbg <= 7)
+			data.insert(data.end(), {static_cast<uint8>(0x80 | (dg + 32)), static_cast<uint8>(((drg + 8) << 4) | (dbg + 8))});
+		else
+			data.insert(data.end(), {0xFE, pixel.R, pixel.G, pixel.B});
+
+		index[position] = pixel;
+		previous = pixel;
+	}
+
+	data.insert(data.end(), {0, 0, 0, 0, 0, 0, 0, 1});
+
+	return data;
+}
+
+template <typename DecoderType>
+static void DecodeAll(const Image &Image)
+{
+	DecoderType decoder(Image);
+
+	uint32 sum = 0;
+	for (uint32 i = 0; i < PIXEL_COUNT; ++i)
+	{
+		uint8 alpha;
+		sum += decoder.Read(alpha);
+	}
+
+	Benchmark::Use(&sum);
+}
+
+// A mismatch with Tools/ImageToAsset.py would have the rates measured on a cut short decode
+template <typename DecoderType>
+static bool DecodesTo(const Image &Image, const std::vector<uint16> &Pixels)
+{
+	DecoderType decoder(Image);
+
+	for (uint16 pixel : Pixels)
+	{
+		uint8 alpha;
+		if (decoder.Read(alpha) != pixel || alpha != 255)
+			return false;
+	}
+
+	return true;
+}
+
+int main(void)
+{
+	srand(1);
+
+	static IHAL hal;
+
+	static ILI9341_HAL_320_240 screen(&hal, GPIOPins::Pin0, GPIOPins::Pin1, GPIOPins::Pin2, GPIOPins::Pin3, GPIOPins::Pin4, I_LCD_HAL::Orientations::ToRight);
+	screen.Initialize();
+
+	static LCDCanvasT<ILI9341_HAL_320_240> canvas;
+	canvas.Initialize(&screen);
+
+	const std::vector<Pixel> pixels = MakePixels();
+
+	std::vector<uint16> raw;
+	for (const Pixel &pixel : pixels)
+		raw.push_back(PixelFormatRGB565::FromRGB(pixel.R, pixel.G, pixel.B));
+
+	const std::vector<uint8> rle565Data = EncodeRLE565(pixels);
+	const std::vector<uint8> qoiData = EncodeQOI(pixels);
+
+	const Image rle565Image = {ImageFormats::RLE565, WIDTH, HEIGHT, rle565Data.data(), static_cast<uint32>(rle565Data.size())};
+	const Image qoiImage = {ImageFormats::QOI, WIDTH, HEIGHT, qoiData.data(), static_cast<uint32>(qoiData.size())};
+
+	printf("128x128 image, raw %u bytes, RLE565 %u bytes, QOI %u bytes\n", static_cast<uint32>(raw.size() * sizeof(uint16)), static_cast<uint32>(rle565Data.size()), static_cast<uint32>(qoiData.size()));
+
+	if (!DecodesTo<RLE565Decoder>(rle565Image, raw) || !DecodesTo<QOIDecoder>(qoiImage, raw))
+	{
+		printf("The encoded images don't decode to the raw pixels\n");
+
+		return 1;
+	}
+
+	Benchmark::Run("RLE565Decoder::Read", PIXEL_COUNT, "pixel", [&]()
+				   { DecodeAll<RLE565Decoder>(rle565Image); });
+	Benchmark::Run("QOIDecoder::Read", PIXEL_COUNT, "pixel", [&]()
+				   { DecodeAll<QOIDecoder>(qoiImage); });
+
+	// What an image pre-expanded into the RAM costs
+	const double rawRate = Benchmark::Run("DrawRow of the raw pixels", PIXEL_COUNT, "pixel", [&]()
+										  {
+											  for (uint16 y = 0; y < HEIGHT; ++y)
+												  screen.DrawRow({0, y}, raw.data() + (y * WIDTH), WIDTH); });
+
+	const double rle565Rate = Benchmark::Run("DrawImage RLE565", PIXEL_COUNT, "pixel", [&]()
+											 { canvas.DrawImage(0, 0, rle565Image); });
+	Benchmark::PrintSpeedup("RLE565 relative to the raw pixels", rle565Rate, rawRate);
+
+	const double qoiRate = Benchmark::Run("DrawImage QOI", PIXEL_COUNT, "pixel", [&]()
+										  { canvas.DrawImage(0, 0, qoiImage); });
+	Benchmark::PrintSpeedup("QOI relative to the raw pixels", qoiRate, rawRate);
+
+	// Only the rows and columns inside the clip get drawn, the rest is skipped
+	canvas.PushClipRect(32, 32, 64, 64);
+	Benchmark::Run("DrawImage RLE565, quarter clipped in", PIXEL_COUNT / 4, "pixel", [&]()
+				   { canvas.DrawImage(0, 0, rle565Image); });
+	Benchmark::Run("DrawImage QOI, quarter clipped in", PIXEL_COUNT / 4, "pixel", [&]()
+				   { canvas.DrawImage(0, 0, qoiImage); });
+	canvas.PopClipRect();
+
+	return 0;
+}
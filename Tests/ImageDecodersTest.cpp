@@ -0,0 +1,194 @@
+#include "Test.h"
+#include "ImageDecoders.h"
+#include <vector>
+
+// The streaming decoders against hand encoded images, and the same images cut short at every byte
+// Cut images are copied into buffers of their exact size, so the sanitizer catches any read past their end
+
+static constexpr uint16 WIDTH = 4;
+static constexpr uint16 HEIGHT = 2;
+static constexpr uint16 PIXEL_COUNT = WIDTH * HEIGHT;
+
+struct DecodedPixel
+{
+public:
+	uint16 R5G6B5;
+	uint8 Alpha;
+};
+
+// Run of 3, literal of 2, run of 3
+static const uint8 RLE565_DATA[] = {0x82, 0x00, 0xF8,
+									0x01, 0xE0, 0x07, 0x1F, 0x00,
+									0x82, 0xFF, 0xFF};
+
+static const DecodedPixel RLE565_PIXELS[PIXEL_COUNT] = {{0xF800, 255}, {0xF800, 255}, {0xF800, 255}, {0x07E0, 255},
+														{0x001F, 255}, {0xFFFF, 255}, {0xFFFF, 255}, {0xFFFF, 255}};
+
+static const uint8 QOI_HEADER[] = {'q', 'o', 'i', 'f', 0, 0, 0, WIDTH, 0, 0, 0, HEIGHT, 4, 0};
+
+// RGB, run of 2, luma, RGBA, diff, index of the first pixel, diff of zero
+static const uint8 QOI_CHUNKS[] = {0xFE, 0x10, 0x20, 0x30,
+								   0xC1,
+								   0xA2, 0x88,
+								   0xFF, 0x01, 0x02, 0x03, 0x80,
+								   0x79,
+								   0x15,
+								   0x6A};
+
+static const uint8 QOI_END_MARKER[] = {0, 0, 0, 0, 0, 0, 0, 1};
+
+static const DecodedPixel QOI_PIXELS[PIXEL_COUNT] = {{PixelFormatRGB565::FromRGB(0x10, 0x20, 0x30), 255},
+													 {PixelFormatRGB565::FromRGB(0x10, 0x20, 0x30), 255},
+													 {PixelFormatRGB565::FromRGB(0x10, 0x20, 0x30), 255},
+													 {PixelFormatRGB565::FromRGB(0x12, 0x22, 0x32), 255},
+													 {PixelFormatRGB565::FromRGB(0x01, 0x02, 0x03), 128},
+													 {PixelFormatRGB565::FromRGB(0x02, 0x02, 0x02), 128},
+													 {PixelFormatRGB565::FromRGB(0x10, 0x20, 0x30), 255},
+													 {PixelFormatRGB565::FromRGB(0x10, 0x20, 0x30), 255}};
+
+// Skips the first SkipCount pixels, they're reported as transparent
+template <typename DecoderType>
+static void Decode(DecoderType &Decoder, uint16 SkipCount, DecodedPixel *Pixels)
+{
+	Decoder.Skip(SkipCount);
+
+	for (uint16 i = 0; i < PIXEL_COUNT; ++i)
+	{
+		if (i < SkipCount)
+		{
+			Pixels[i] = {0, 0};
+
+			continue;
+		}
+
+		Pixels[i].R5G6B5 = Decoder.Read(Pixels[i].Alpha);
+	}
+}
+
+static void CheckPixels(const DecodedPixel *Expected, const DecodedPixel *Actual, uint16 SkipCount)
+{
+	for (uint16 i = SkipCount; i < PIXEL_COUNT; ++i)
+	{
+		CHECK_EQUAL(Expected[i].R5G6B5, Actual[i].R5G6B5);
+		CHECK_EQUAL(Expected[i].Alpha, Actual[i].Alpha);
+	}
+}
+
+// The pixels before the cut are right, the ones after it are transparent
+static void CheckCutPixels(const DecodedPixel *Expected, const DecodedPixel *Actual, uint16 SkipCount)
+{
+	bool isCut = false;
+
+	for (uint16 i = SkipCount; i < PIXEL_COUNT; ++i)
+	{
+		if (!isCut && (Actual[i].Alpha != Expected[i].Alpha || Actual[i].R5G6B5 != Expected[i].R5G6B5))
+			isCut = true;
+
+		if (isCut)
+			CHECK_EQUAL(0, Actual[i].Alpha);
+	}
+
+	CHECK(isCut);
+}
+
+static void TestRLE565(void)
+{
+	for (uint16 skipCount = 0; skipCount < PIXEL_COUNT; ++skipCount)
+	{
+		const Image image = {ImageFormats::RLE565, WIDTH, HEIGHT, RLE565_DATA, sizeof(RLE565_DATA)};
+		RLE565Decoder decoder(image);
+
+		DecodedPixel pixels[PIXEL_COUNT];
+		Decode(decoder, skipCount, pixels);
+
+		CheckPixels(RLE565_PIXELS, pixels, skipCount);
+	}
+}
+
+static void TestCutRLE565(void)
+{
+	for (uint32 size = 0; size < sizeof(RLE565_DATA); ++size)
+		for (uint16 skipCount = 0; skipCount < PIXEL_COUNT; skipCount += 3)
+		{
+			uint8 *data = new uint8[size];
+			Memory::Copy(RLE565_DATA, data, size);
+
+			const Image image = {ImageFormats::RLE565, WIDTH, HEIGHT, data, size};
+			RLE565Decoder decoder(image);
+
+			const uint32 failedAssertionCount = g_FailedAssertionCount;
+
+			DecodedPixel pixels[PIXEL_COUNT];
+			Decode(decoder, skipCount, pixels);
+
+			CheckCutPixels(RLE565_PIXELS, pixels, skipCount);
+
+			// Once
+			CHECK_EQUAL(failedAssertionCount + 1, g_FailedAssertionCount);
+
+			delete[] data;
+		}
+}
+
+// Header, the first ChunkSize bytes of the chunks and the end marker
+static std::vector<uint8> MakeQOI(uint32 ChunkSize)
+{
+	std::vector<uint8> data(QOI_HEADER, QOI_HEADER + sizeof(QOI_HEADER));
+	data.insert(data.end(), QOI_CHUNKS, QOI_CHUNKS + ChunkSize);
+	data.insert(data.end(), QOI_END_MARKER, QOI_END_MARKER + sizeof(QOI_END_MARKER));
+
+	return data;
+}
+
+static void TestQOI(void)
+{
+	const std::vector<uint8> data = MakeQOI(sizeof(QOI_CHUNKS));
+
+	for (uint16 skipCount = 0; skipCount < PIXEL_COUNT; ++skipCount)
+	{
+		const Image image = {ImageFormats::QOI, WIDTH, HEIGHT, data.data(), static_cast<uint32>(data.size())};
+		QOIDecoder decoder(image);
+
+		DecodedPixel pixels[PIXEL_COUNT];
+		Decode(decoder, skipCount, pixels);
+
+		CheckPixels(QOI_PIXELS, pixels, skipCount);
+	}
+}
+
+static void TestCutQOI(void)
+{
+	for (uint32 chunkSize = 0; chunkSize < sizeof(QOI_CHUNKS); ++chunkSize)
+		for (uint16 skipCount = 0; skipCount < PIXEL_COUNT; skipCount += 3)
+		{
+			const std::vector<uint8> cut = MakeQOI(chunkSize);
+
+			uint8 *data = new uint8[cut.size()];
+			Memory::Copy(cut.data(), data, cut.size());
+
+			const Image image = {ImageFormats::QOI, WIDTH, HEIGHT, data, static_cast<uint32>(cut.size())};
+			QOIDecoder decoder(image);
+
+			const uint32 failedAssertionCount = g_FailedAssertionCount;
+
+			DecodedPixel pixels[PIXEL_COUNT];
+			Decode(decoder, skipCount, pixels);
+
+			// Nothing of the end marker gets decoded as chunks
+			CheckCutPixels(QOI_PIXELS, pixels, skipCount);
+
+			CHECK_EQUAL(failedAssertionCount + 1, g_FailedAssertionCount);
+
+			delete[] data;
+		}
+}
+
+int main(void)
+{
+	RUN_TEST(TestRLE565);
+	RUN_TEST(TestCutRLE565);
+	RUN_TEST(TestQOI);
+	RUN_TEST(TestCutQOI);
+
+	return GetTestResult();
+}
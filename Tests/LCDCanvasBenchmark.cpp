@@ -0,0 +1,176 @@
+#include "Benchmark.h"
+#include "ILI9341_HAL.h"
+#include "LCDCanvas.h"
+
+// Drawing rates of the canvases into the frame buffer of ILI9341_HAL, nothing gets transmitted
+
+typedef ILI9341_HAL_320_240 ScreenType;
+typedef LCDCanvasT<ScreenType> CanvasType;
+
+static const Color WHITE = {255, 255, 255, 255};
+
+// Fits the screen at every scale
+static cstr const TEXT = "Cutoff 1.2k";
+
+// The span and rectangle fills against a virtual DrawPixel for every pixel, which is how every primitive used to end up
+static void BenchmarkFills(LCDCanvas &Canvas, I_LCD_HAL &HAL)
+{
+	const uint16 SIZE = 200;
+
+	double perPixel = Benchmark::Run("DrawPixel per pixel, 200x200", SIZE * SIZE, "pixel", [&]()
+									 {
+										 for (uint16 y = 0; y < SIZE; ++y)
+											 for (uint16 x = 0; x < SIZE; ++x)
+												 HAL.DrawPixel({x, y}, WHITE); });
+	double span = Benchmark::Run("DrawFilledRectangle, 200x200", SIZE * SIZE, "pixel", [&]()
+								 { Canvas.DrawFilledRectangle(0, 0, SIZE, SIZE, WHITE); });
+	Benchmark::PrintSpeedup("Rectangle fill speedup", span, perPixel);
+
+	perPixel = Benchmark::Run("DrawPixel per pixel, 200 long row", SIZE, "pixel", [&]()
+							  {
+								  for (uint16 x = 0; x < SIZE; ++x)
+									  HAL.DrawPixel({x, 10}, WHITE); });
+	span = Benchmark::Run("DrawLine, 200 long row", SIZE, "pixel", [&]()
+						  { Canvas.DrawLine(0, 10, SIZE - 1, 10, WHITE); });
+	Benchmark::PrintSpeedup("Horizontal span speedup", span, perPixel);
+
+	perPixel = Benchmark::Run("DrawPixel per pixel, 200 long column", SIZE, "pixel", [&]()
+							  {
+								  for (uint16 y = 0; y < SIZE; ++y)
+									  HAL.DrawPixel({10, y}, WHITE); });
+	span = Benchmark::Run("DrawLine, 200 long column", SIZE, "pixel", [&]()
+						  { Canvas.DrawLine(10, 0, 10, SIZE - 1, WHITE); });
+	Benchmark::PrintSpeedup("Vertical span speedup", span, perPixel);
+}
+
+// Runs Function on both canvases, the calls of the templated one to the HAL get inlined
+template <typename FunctionType>
+static void CompareDispatch(cstr Name, uint32 PixelsPerCall, CanvasType &Canvas, LCDCanvas &VirtualCanvas, FunctionType Function)
+{
+	char name[64];
+
+	snprintf(name, sizeof(name), "%s, virtual", Name);
+	const double virtualRate = Benchmark::Run(name, PixelsPerCall, "pixel", [&]()
+											  { Function(VirtualCanvas); });
+
+	snprintf(name, sizeof(name), "%s, templated", Name);
+	const double templatedRate = Benchmark::Run(name, PixelsPerCall, "pixel", [&]()
+												{ Function(Canvas); });
+
+	snprintf(name, sizeof(name), "%s speedup", Name);
+	Benchmark::PrintSpeedup(name, templatedRate, virtualRate);
+}
+
+// LCDCanvasT bound to the HAL against LCDCanvas, on the primitives which make a call to the HAL for every pixel
+static void BenchmarkDispatch(CanvasType &Canvas, LCDCanvas &VirtualCanvas)
+{
+	CompareDispatch("DrawPixel 100x100", 100 * 100, Canvas, VirtualCanvas, [](auto &Canvas)
+					{
+						for (int16 y = 0; y < 100; ++y)
+							for (int16 x = 0; x < 100; ++x)
+								Canvas.DrawPixel(x, y, WHITE); });
+
+	CompareDispatch("DrawLine diagonal", 320, Canvas, VirtualCanvas, [](auto &Canvas)
+					{ Canvas.DrawLine(0, 0, 319, 239, WHITE); });
+
+	// About 2 * pi * Radius pixels
+	CompareDispatch("DrawCircle", 628, Canvas, VirtualCanvas, [](auto &Canvas)
+					{ Canvas.DrawCircle(160, 120, 100, WHITE); });
+}
+
+// The anti-aliased primitives against the aliased ones of the same shape, they should stay within about 2x
+template <typename AliasedFunctionType, typename AntiAliasedFunctionType>
+static void CompareAntiAliasing(cstr Name, AliasedFunctionType AliasedFunction, AntiAliasedFunctionType AntiAliasedFunction)
+{
+	char name[64];
+
+	snprintf(name, sizeof(name), "%s, aliased", Name);
+	const double aliasedRate = Benchmark::Run(name, 1, "call", AliasedFunction);
+
+	snprintf(name, sizeof(name), "%s, anti-aliased", Name);
+	const double antiAliasedRate = Benchmark::Run(name, 1, "call", AntiAliasedFunction);
+
+	snprintf(name, sizeof(name), "%s cost of anti-aliasing", Name);
+	Benchmark::PrintSpeedup(name, aliasedRate, antiAliasedRate);
+}
+
+static void BenchmarkAntiAliasing(CanvasType &Canvas)
+{
+	CompareAntiAliasing(
+		"DrawLine shallow", [&]()
+		{ Canvas.DrawLine(0, 20, 319, 140, WHITE); },
+		[&]()
+		{ Canvas.DrawAntiAliasedLine(0, 20, 319, 140, WHITE); });
+
+	CompareAntiAliasing(
+		"DrawLine steep", [&]()
+		{ Canvas.DrawLine(100, 0, 180, 239, WHITE); },
+		[&]()
+		{ Canvas.DrawAntiAliasedLine(100, 0, 180, 239, WHITE); });
+
+	CompareAntiAliasing(
+		"DrawCircle", [&]()
+		{ Canvas.DrawCircle(160, 120, 100, WHITE); },
+		[&]()
+		{ Canvas.DrawAntiAliasedCircle(160, 120, 100, WHITE); });
+
+	const uint16 startAngle = FixedTrigonometry::FromDegrees(135);
+	const uint16 endAngle = FixedTrigonometry::FromDegrees(45);
+
+	CompareAntiAliasing(
+		"DrawArc", [&]()
+		{ Canvas.DrawArc(160, 120, 100, startAngle, endAngle, WHITE); },
+		[&]()
+		{ Canvas.DrawAntiAliasedArc(160, 120, 100, startAngle, endAngle, WHITE); });
+}
+
+static void BenchmarkCharacters(CanvasType &Canvas)
+{
+	const uint16 length = GetStringLength(TEXT);
+
+	GlyphCache cache;
+	cache.Initialize(256, 4096);
+
+	const float scales[] = {1, 0.75F, 2};
+	for (float scale : scales)
+	{
+		const Font font = {Font_DUBAI_BOLD_16.Width, Font_DUBAI_BOLD_16.Height, Font_DUBAI_BOLD_16.Data, scale};
+
+		char name[64];
+
+		Canvas.SetGlyphCache(nullptr);
+		snprintf(name, sizeof(name), "DrawString, scale %.2f", scale);
+		const double uncached = Benchmark::Run(name, length, "char", [&]()
+											   { Canvas.DrawString(0, 100, TEXT, length, font, WHITE); });
+
+		Canvas.SetGlyphCache(&cache);
+		snprintf(name, sizeof(name), "DrawString cached, scale %.2f", scale);
+		const double cached = Benchmark::Run(name, length, "char", [&]()
+											 { Canvas.DrawString(0, 100, TEXT, length, font, WHITE); });
+
+		Benchmark::PrintSpeedup("Glyph cache speedup", cached, uncached);
+	}
+
+	Canvas.SetGlyphCache(nullptr);
+}
+
+int main(void)
+{
+	static IHAL hal;
+
+	static ScreenType screen(&hal, GPIOPins::Pin0, GPIOPins::Pin1, GPIOPins::Pin2, GPIOPins::Pin3, GPIOPins::Pin4, I_LCD_HAL::Orientations::ToRight);
+	screen.Initialize();
+
+	static CanvasType canvas;
+	canvas.Initialize(&screen);
+
+	static LCDCanvas virtualCanvas;
+	virtualCanvas.Initialize(&screen);
+
+	BenchmarkFills(virtualCanvas, screen);
+	BenchmarkDispatch(canvas, virtualCanvas);
+	BenchmarkAntiAliasing(canvas);
+	BenchmarkCharacters(canvas);
+
+	return 0;
+}
@@ -0,0 +1,568 @@
+#include "Test.h"
+#include "RecordingHAL.h"
+#include "LCDCanvas.h"
+
+// Polygon filling of LCDCanvasT on the recording screen, every covered pixel gets written exactly once,
+// against the filled parallelogram and circle routines it replaced, and the nearest placement of the scaled characters
+
+typedef RecordingHAL<160, 120> ScreenType;
+
+static const Color WHITE = {255, 255, 255, 255};
+
+static constexpr uint8 FONT_WIDTH = 8;
+static constexpr uint8 FONT_HEIGHT = 10;
+static constexpr uint8 FONT_CHARACTER_COUNT = '~' - ' ' + 1;
+
+// The routines the rasterizer replaced, as they were, each span is a DrawPixel for every one of its pixels
+static void DrawBaselineHorizontalLine(ScreenType &Screen, uint16 X, uint16 Y, int16 Width)
+{
+	if (Width < 0)
+	{
+		X = Math::Max(0, X + Width);
+		Width *= -1;
+	}
+
+	for (uint16 i = X; i < X + Width; ++i)
+		Screen.DrawPixel({i, Y}, WHITE);
+}
+
+static void DrawBaselineVerticalLine(ScreenType &Screen, uint16 X, uint16 Y, int16 Height)
+{
+	if (Height < 0)
+	{
+		Y = Math::Max(0, Y + Height);
+		Height *= -1;
+	}
+
+	for (uint16 i = Y; i < Y + Height; ++i)
+		Screen.DrawPixel({X, i}, WHITE);
+}
+
+static void DrawBaselineFilledRectangle(ScreenType &Screen, uint16 X, uint16 Y, uint16 Width, uint16 Height)
+{
+	for (uint32 j = 0; j < Height; ++j)
+		for (uint32 i = 0; i < Width; ++i)
+			Screen.DrawPixel({static_cast<uint16>(X + i), static_cast<uint16>(Y + j)}, WHITE);
+}
+
+static void DrawBaselineFilledTriangle(ScreenType &Screen, uint16 X0, uint16 Y0, uint16 X1, uint16 Y1, uint16 X2, uint16 Y2)
+{
+	int16 a, b, y, last;
+
+	if (Y0 > Y1)
+	{
+		std::swap(Y0, Y1);
+		std::swap(X0, X1);
+	}
+	if (Y1 > Y2)
+	{
+		std::swap(Y2, Y1);
+		std::swap(X2, X1);
+	}
+	if (Y0 > Y1)
+	{
+		std::swap(Y0, Y1);
+		std::swap(X0, X1);
+	}
+
+	if (Y0 == Y2)
+	{
+		a = b = X0;
+
+		if (X1 < a)
+			a = X1;
+		else if (X1 > b)
+			b = X1;
+
+		if (X2 < a)
+			a = X2;
+		else if (X2 > b)
+			b = X2;
+
+		DrawBaselineHorizontalLine(Screen, a, Y0, b - a + 1);
+
+		return;
+	}
+
+	int16 dx01 = X1 - X0, dy01 = Y1 - Y0, dx02 = X2 - X0, dy02 = Y2 - Y0,
+		  dx12 = X2 - X1, dy12 = Y2 - Y1;
+	int32 sa = 0, sb = 0;
+
+	last = (Y1 == Y2 ? Y1 : Y1 - 1);
+
+	for (y = Y0; y < last; ++y)
+	{
+		a = X0 + sa / dy01;
+		b = X0 + sb / dy02;
+		sa += dx01;
+		sb += dx02;
+
+		if (a > b)
+			std::swap(a, b);
+
+		DrawBaselineHorizontalLine(Screen, a, y, b - a + 1);
+	}
+
+	sa = (int32)dx12 * (y - Y1);
+	sb = (int32)dx02 * (y - Y0);
+	for (; y < Y2; ++y)
+	{
+		a = X1 + sa / dy12;
+		b = X0 + sb / dy02;
+		sa += dx12;
+		sb += dx02;
+
+		if (a > b)
+			std::swap(a, b);
+
+		DrawBaselineHorizontalLine(Screen, a, y, b - a + 1);
+	}
+}
+
+static void DrawBaselineFilledParallelogram(ScreenType &Screen, uint16 LeftTopX, uint16 LeftTopY, uint16 LeftBottomX, uint16 LeftBottomY, uint16 RightTopX, uint16 RightTopY, uint16 RightBottomX, uint16 RightBottomY)
+{
+	uint16 minX = LeftTopX;
+	uint16 minY = LeftTopY;
+
+	uint16 maxX = RightBottomX;
+	uint16 maxY = RightBottomY;
+
+	if (LeftTopX != LeftBottomX)
+	{
+		minX = Math::Max(LeftTopX, LeftBottomX);
+
+		DrawBaselineFilledTriangle(Screen, LeftTopX, LeftTopY, LeftTopX, LeftBottomY, LeftBottomX, LeftBottomY);
+	}
+
+	if (LeftTopY != RightTopY)
+	{
+		minY = Math::Max(LeftTopY, RightTopY);
+
+		DrawBaselineFilledTriangle(Screen, LeftTopX, LeftTopY, LeftTopX, RightTopY, RightBottomX, RightBottomY);
+	}
+
+	if (RightTopX != RightBottomX)
+	{
+		maxX = Math::Min(RightTopX, RightBottomX);
+
+		uint16 y2 = RightBottomY;
+		if (RightTopX > RightBottomX)
+			y2 = RightTopY;
+
+		DrawBaselineFilledTriangle(Screen, RightTopX, RightTopY, maxX, y2, RightBottomX, RightBottomY);
+	}
+
+	if (LeftBottomY != RightBottomY)
+	{
+		maxY = Math::Min(LeftBottomY, RightBottomY);
+
+		DrawBaselineFilledTriangle(Screen, LeftBottomX, LeftBottomY, LeftBottomX, RightBottomY, RightBottomX, RightBottomY);
+	}
+
+	DrawBaselineFilledRectangle(Screen, minX, minY, maxX - minX, maxY - minY);
+}
+
+static void DrawBaselineFilledCircle(ScreenType &Screen, uint16 X0, uint16 Y0, uint16 Radius)
+{
+	--Radius;
+
+	DrawBaselineVerticalLine(Screen, X0, Y0 - Radius, (2 * Radius) + 2);
+
+	int16 f = 1 - Radius;
+	int16 ddF_x = 1;
+	int16 ddF_y = -2 * Radius;
+	int16 x = 0;
+	int16 y = Radius;
+
+	while (x < y)
+	{
+		if (f >= 0)
+		{
+			y--;
+			ddF_y += 2;
+			f += ddF_y;
+		}
+		x++;
+		ddF_x += 2;
+		f += ddF_x;
+
+		DrawBaselineVerticalLine(Screen, X0 + x, Y0 - y, (2 * y) + 1);
+		DrawBaselineVerticalLine(Screen, X0 + y, Y0 - x, (2 * x) + 1);
+		DrawBaselineVerticalLine(Screen, X0 - x, Y0 - y, (2 * y) + 1);
+		DrawBaselineVerticalLine(Screen, X0 - y, Y0 - x, (2 * x) + 1);
+	}
+}
+
+static void TestTriangleFanHasNoOverdraw(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	// Four triangles around the center of the rectangle, sharing their edges
+	canvas.DrawFilledTriangle(10, 10, 110, 10, 60, 50, WHITE);
+	canvas.DrawFilledTriangle(110, 10, 110, 90, 60, 50, WHITE);
+	canvas.DrawFilledTriangle(110, 90, 10, 90, 60, 50, WHITE);
+	canvas.DrawFilledTriangle(10, 90, 10, 10, 60, 50, WHITE);
+
+	CHECK_EQUAL(100 * 80, screen.GetTotalWriteCount());
+	CHECK_EQUAL(100 * 80, screen.GetWrittenPixelCount());
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+	CHECK_EQUAL(0, screen.GetWriteCount(9, 9));
+	CHECK_EQUAL(1, screen.GetWriteCount(10, 10));
+	CHECK_EQUAL(1, screen.GetWriteCount(109, 89));
+	CHECK_EQUAL(0, screen.GetWriteCount(110, 90));
+}
+
+static void TestThickOutlinesHaveNoOverdraw(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	// The sides overlap on the corners
+	canvas.DrawRectangle(20, 20, 100, 60, WHITE, 6);
+	CHECK(screen.GetWrittenPixelCount() != 0);
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+
+	screen.ResetWriteCounts();
+
+	canvas.SetLineCap(LCDCanvasT<ScreenType>::LineCaps::Round);
+	canvas.DrawTriangle(20, 100, 80, 10, 140, 100, WHITE, 7);
+	CHECK(screen.GetWrittenPixelCount() != 0);
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+	CHECK_EQUAL(0, screen.GetOutsideWriteCount());
+}
+
+static void TestSelfIntersectingPolygonHasNoOverdraw(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	// A five pointed star, its center is wound twice
+	const Point star[] = {{80, 5}, {110, 100}, {30, 40}, {130, 40}, {50, 100}};
+	canvas.DrawFilledPolygon(star, 5, WHITE);
+
+	CHECK(screen.GetWrittenPixelCount() != 0);
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+	CHECK_EQUAL(1, screen.GetWriteCount(80, 60));
+}
+
+static void TestPolygonMatchesRectangle(void)
+{
+	ScreenType polygonScreen;
+	LCDCanvasT<ScreenType> polygonCanvas;
+	polygonCanvas.Initialize(&polygonScreen);
+
+	ScreenType rectangleScreen;
+	LCDCanvasT<ScreenType> rectangleCanvas;
+	rectangleCanvas.Initialize(&rectangleScreen);
+
+	const Point rectangle[] = {{13, 7}, {147, 7}, {147, 101}, {13, 101}};
+	polygonCanvas.DrawFilledPolygon(rectangle, 4, WHITE);
+
+	rectangleCanvas.DrawFilledRectangle(13, 7, 134, 94, WHITE);
+
+	CHECK_EQUAL(134 * 94, polygonScreen.GetWrittenPixelCount());
+
+	for (uint16 y = 0; y < 120; ++y)
+		for (uint16 x = 0; x < 160; ++x)
+			CHECK_EQUAL(rectangleScreen.GetWriteCount(x, y), polygonScreen.GetWriteCount(x, y));
+}
+
+static void TestTriangleCoversPixelCenters(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	canvas.DrawFilledTriangle(0, 0, 100, 0, 0, 50, WHITE);
+
+	// The center of a pixel is in when X + (2 * Y) < 100, none of them is on the hypotenuse
+	uint32 expectedCount = 0;
+	for (uint16 y = 0; y < 120; ++y)
+		for (uint16 x = 0; x < 160; ++x)
+		{
+			const bool isInside = ((2 * x) + 1) + (2 * ((2 * y) + 1)) < 200;
+
+			expectedCount += (isInside ? 1 : 0);
+
+			CHECK_EQUAL((isInside ? 1 : 0), screen.GetWriteCount(x, y));
+		}
+
+	CHECK_EQUAL(expectedCount, screen.GetWrittenPixelCount());
+}
+
+static void TestClippedPolygon(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	canvas.PushClipRect(40, 30, 50, 40);
+	canvas.DrawFilledTriangle(-100, -100, 300, 60, -100, 200, WHITE);
+	canvas.PopClipRect();
+
+	CHECK_EQUAL(50 * 40, screen.GetWrittenPixelCount());
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+	CHECK_EQUAL(0, screen.GetOutsideWriteCount());
+}
+
+static void TestOverflowedPolygonIsSkipped(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	// A zigzag of more edges than the rasterizer holds
+	Point zigzag[80];
+	for (uint8 i = 0; i < 40; ++i)
+	{
+		zigzag[i] = {static_cast<uint16>(10 + (i * 3)), static_cast<uint16>((i % 2) == 0 ? 10 : 20)};
+		zigzag[79 - i] = {static_cast<uint16>(10 + (i * 3)), static_cast<uint16>((i % 2) == 0 ? 60 : 50)};
+	}
+
+	const uint32 failedAssertionCount = g_FailedAssertionCount;
+
+	canvas.DrawFilledPolygon(zigzag, 80, WHITE);
+
+	CHECK(g_FailedAssertionCount != failedAssertionCount);
+	CHECK_EQUAL(0, screen.GetTotalWriteCount());
+
+	// The next one starts over
+	canvas.DrawFilledTriangle(0, 0, 100, 0, 0, 50, WHITE);
+	CHECK(screen.GetWrittenPixelCount() != 0);
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+}
+
+// Every other path which fills spans
+static void TestShapesHaveNoOverdraw(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	auto check = [&](auto Draw)
+	{
+		screen.ResetWriteCounts();
+
+		Draw();
+
+		CHECK(screen.GetWrittenPixelCount() != 0);
+		CHECK_EQUAL(1, screen.GetMaxWriteCount());
+		CHECK_EQUAL(0, screen.GetOutsideWriteCount());
+	};
+
+	check([&]()
+		  { canvas.DrawFilledCircle(80, 60, 45, WHITE); });
+	check([&]()
+		  { canvas.DrawFilledEllipse(80, 60, 70, 30, WHITE); });
+	check([&]()
+		  { canvas.DrawFilledRoundedRectangle(10, 10, 140, 100, 20, WHITE); });
+	check([&]()
+		  { canvas.DrawFilledParallelogram(30, 10, 10, 100, 150, 10, 130, 100, WHITE); });
+	check([&]()
+		  { canvas.DrawArc(80, 60, 40, FixedTrigonometry::FromDegrees(135), FixedTrigonometry::FromDegrees(45), WHITE, 6); });
+	check([&]()
+		  { canvas.DrawLine(10, 100, 150, 20, WHITE, 5); });
+	check([&]()
+		  { canvas.DrawLine(40, 5, 60, 110, WHITE, 4); });
+}
+
+// The primitives drawing pixel by pixel hand them to the screen in batches, so the color gets converted once per batch
+static void TestPixelPrimitivesAreBatched(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	// At least PixelsPerCall pixels per call taking the color
+	auto check = [&](uint32 PixelsPerCall, auto Draw)
+	{
+		screen.ResetWriteCounts();
+
+		Draw();
+
+		const uint32 writeCount = screen.GetTotalWriteCount();
+
+		CHECK(writeCount != 0);
+		CHECK(screen.GetColorCallCount() <= (writeCount + PixelsPerCall - 1) / PixelsPerCall);
+		CHECK_EQUAL(0, screen.GetOutsideWriteCount());
+	};
+
+	check(32, [&]()
+		  { canvas.DrawLine(0, 0, 99, 60, WHITE); });
+	check(32, [&]()
+		  { canvas.DrawLine(150, 5, 20, 110, WHITE); });
+	check(32, [&]()
+		  { canvas.DrawCircle(80, 60, 45, WHITE); });
+	// Partly off the screen
+	check(32, [&]()
+		  { canvas.DrawCircle(140, 100, 50, WHITE); });
+	check(32, [&]()
+		  { canvas.DrawAntiAliasedLine(10, 0, 40, 110, WHITE); });
+	// Runs longer than two pixels are blended as rows of their own
+	check(8, [&]()
+		  { canvas.DrawAntiAliasedLine(5, 10, 150, 90, WHITE); });
+	check(8, [&]()
+		  { canvas.DrawAntiAliasedCircle(80, 60, 45, WHITE); });
+
+	// Each pixel of the line once, the same as drawn one by one
+	screen.ResetWriteCounts();
+	canvas.DrawLine(0, 0, 99, 60, WHITE);
+
+	CHECK_EQUAL(100, screen.GetWrittenPixelCount());
+	CHECK_EQUAL(1, screen.GetMaxWriteCount());
+	CHECK_EQUAL(4, screen.GetColorCallCount());
+}
+
+// Same pixels as the midpoint circle it replaced, bar the stray one its center column drew below the circle,
+// each one written once instead of up to four times
+static void TestFilledCircleMatchesBaseline(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	ScreenType baselineScreen;
+
+	uint32 totalWriteCount = 0;
+	uint32 baselineTotalWriteCount = 0;
+
+	for (uint16 radius = 1; radius < 50; ++radius)
+	{
+		screen.ResetWriteCounts();
+		baselineScreen.ResetWriteCounts();
+
+		canvas.DrawFilledCircle(80, 60, radius, WHITE);
+		DrawBaselineFilledCircle(baselineScreen, 80, 60, radius);
+
+		for (uint16 y = 0; y < 120; ++y)
+			for (uint16 x = 0; x < 160; ++x)
+			{
+				if (x == 80 && y == 60 + radius)
+					continue;
+
+				CHECK_EQUAL((baselineScreen.GetWriteCount(x, y) != 0 ? 1 : 0), screen.GetWriteCount(x, y));
+			}
+
+		CHECK_EQUAL(0, screen.GetWriteCount(80, 60 + radius));
+		CHECK_EQUAL(screen.GetWrittenPixelCount(), screen.GetTotalWriteCount());
+
+		totalWriteCount += screen.GetTotalWriteCount();
+		baselineTotalWriteCount += baselineScreen.GetTotalWriteCount();
+	}
+
+	// 122829 writes against 144134
+	CHECK(totalWriteCount < baselineTotalWriteCount);
+}
+
+// A single polygon covers exactly its area, the baseline assembled it from triangles and a rectangle which overlap
+// and miss some of its edges
+static void TestFilledParallelogramAgainstBaseline(void)
+{
+	ScreenType screen;
+	LCDCanvasT<ScreenType> canvas;
+	canvas.Initialize(&screen);
+
+	ScreenType baselineScreen;
+
+	canvas.DrawFilledParallelogram(30, 10, 10, 100, 150, 10, 130, 100, WHITE);
+	DrawBaselineFilledParallelogram(baselineScreen, 30, 10, 10, 100, 150, 10, 130, 100);
+
+	CHECK_EQUAL(120 * 90, screen.GetWrittenPixelCount());
+	CHECK_EQUAL(120 * 90, screen.GetTotalWriteCount());
+
+	// 10890 pixels in 10980 writes
+	CHECK(baselineScreen.GetWrittenPixelCount() != 120 * 90);
+	CHECK(baselineScreen.GetMaxWriteCount() > 1);
+}
+
+// The placement of the baseline, every source pixel writes its bit into a map of the scaled glyph, so the last one landing on a scaled pixel wins
+static void FillExpectedGlyph(const Font &Font, char Char, bool *Map, uint8 Width)
+{
+	const uint16 *dataPtr = Font.Data + ((Char - ' ') * Font.Height);
+
+	for (uint8 y = 0; y < Font.Height; ++y)
+		for (uint8 x = 0; x < Font.Width; ++x)
+			Map[(uint8)(x * Font.Scale) + ((uint8)(y * Font.Scale) * Width)] = (((1 << x) & dataPtr[y]) != 0);
+}
+
+static void TestScaledCharacters(void)
+{
+	static uint16 data[FONT_CHARACTER_COUNT * FONT_HEIGHT];
+	for (uint16 &row : data)
+		row = static_cast<uint16>(rand()) & ((1 << FONT_WIDTH) - 1);
+
+	// Every pixel set, scaled up each one is a run of its own
+	for (uint8 y = 0; y < FONT_HEIGHT; ++y)
+	{
+		data[(('g' - ' ') * FONT_HEIGHT) + y] = (1 << FONT_WIDTH) - 1;
+		data[(('~' - ' ') * FONT_HEIGHT) + y] = (1 << FONT_WIDTH) - 1;
+	}
+
+	// Not enough for both of those, so the cache starts over between them
+	GlyphCache cache;
+	cache.Initialize(64, 120);
+
+	const uint32 failedAssertionCount = g_FailedAssertionCount;
+
+	const float scales[] = {0.5F, 0.75F, 1, 1.5F, 2, 3};
+	const char characters[] = {'!', 'A', 'g', '~'};
+
+	for (float scale : scales)
+		for (char character : characters)
+			for (GlyphCache *glyphCache : {static_cast<GlyphCache *>(nullptr), &cache})
+			{
+				const Font font = {FONT_WIDTH, FONT_HEIGHT, data, scale};
+
+				ScreenType screen;
+				LCDCanvasT<ScreenType> canvas;
+				canvas.Initialize(&screen);
+				canvas.SetGlyphCache(glyphCache);
+
+				canvas.DrawCharacter(20, 30, character, font, WHITE);
+
+				const uint8 width = FONT_WIDTH * scale;
+				const uint8 height = FONT_HEIGHT * scale;
+
+				bool expected[FONT_WIDTH * 3 * FONT_HEIGHT * 3] = {};
+				FillExpectedGlyph(font, character, expected, width);
+
+				uint32 expectedCount = 0;
+				for (uint8 y = 0; y < height; ++y)
+					for (uint8 x = 0; x < width; ++x)
+					{
+						const bool isLit = expected[x + (y * width)];
+
+						expectedCount += (isLit ? 1 : 0);
+
+						CHECK_EQUAL((isLit ? 1 : 0), screen.GetWriteCount(20 + x, 30 + y));
+					}
+
+				CHECK_EQUAL(expectedCount, screen.GetTotalWriteCount());
+			}
+
+	CHECK_EQUAL(failedAssertionCount, g_FailedAssertionCount);
+}
+
+int main(void)
+{
+	srand(1);
+
+	RUN_TEST(TestTriangleFanHasNoOverdraw);
+	RUN_TEST(TestThickOutlinesHaveNoOverdraw);
+	RUN_TEST(TestSelfIntersectingPolygonHasNoOverdraw);
+	RUN_TEST(TestPolygonMatchesRectangle);
+	RUN_TEST(TestTriangleCoversPixelCenters);
+	RUN_TEST(TestClippedPolygon);
+	RUN_TEST(TestOverflowedPolygonIsSkipped);
+	RUN_TEST(TestShapesHaveNoOverdraw);
+	RUN_TEST(TestPixelPrimitivesAreBatched);
+	RUN_TEST(TestFilledCircleMatchesBaseline);
+	RUN_TEST(TestFilledParallelogramAgainstBaseline);
+	RUN_TEST(TestScaledCharacters);
+
+	return GetTestResult();
+}
@@ -0,0 +1,45 @@
+#include "Benchmark.h"
+#include "RGB565Kernels.h"
+
+// Pixels per second of the word-wide kernels and their RGB565Kernels::Scalar references, on a 320 pixel row
+
+static constexpr uint32 ROW_LENGTH = 320;
+
+int main(void)
+{
+	alignas(8) static uint16 source[ROW_LENGTH];
+	alignas(8) static uint16 destination[ROW_LENGTH];
+	static uint8 alphas[ROW_LENGTH];
+
+	for (uint32 i = 0; i < ROW_LENGTH; ++i)
+	{
+		source[i] = static_cast<uint16>(i * 0x0841);
+		alphas[i] = static_cast<uint8>(i * 7);
+	}
+
+	double scalar = Benchmark::Run("Scalar::Fill", ROW_LENGTH, "pixel", [&]()
+								   { RGB565Kernels::Scalar::Fill(destination, 0x1234, ROW_LENGTH); Benchmark::Use(destination); });
+	double kernel = Benchmark::Run("Fill", ROW_LENGTH, "pixel", [&]()
+								   { RGB565Kernels::Fill(destination, 0x1234, ROW_LENGTH); Benchmark::Use(destination); });
+	Benchmark::PrintSpeedup("Fill speedup", kernel, scalar);
+
+	scalar = Benchmark::Run("Scalar::Blend<true>", ROW_LENGTH, "pixel", [&]()
+							{ RGB565Kernels::Scalar::Blend<true>(destination, 0xF81F, 100, ROW_LENGTH); Benchmark::Use(destination); });
+	kernel = Benchmark::Run("Blend<true>", ROW_LENGTH, "pixel", [&]()
+							{ RGB565Kernels::Blend<true>(destination, 0xF81F, 100, ROW_LENGTH); Benchmark::Use(destination); });
+	Benchmark::PrintSpeedup("Blend speedup", kernel, scalar);
+
+	scalar = Benchmark::Run("Scalar::BlendAlphas<true>", ROW_LENGTH, "pixel", [&]()
+							{ RGB565Kernels::Scalar::BlendAlphas<true>(destination, alphas, 0xF81F, 255, ROW_LENGTH); Benchmark::Use(destination); });
+	kernel = Benchmark::Run("BlendAlphas<true>", ROW_LENGTH, "pixel", [&]()
+							{ RGB565Kernels::BlendAlphas<true>(destination, alphas, 0xF81F, 255, ROW_LENGTH); Benchmark::Use(destination); });
+	Benchmark::PrintSpeedup("BlendAlphas speedup", kernel, scalar);
+
+	scalar = Benchmark::Run("Scalar::Copy<true>", ROW_LENGTH, "pixel", [&]()
+							{ RGB565Kernels::Scalar::Copy<true>(source, destination, ROW_LENGTH); Benchmark::Use(destination); });
+	kernel = Benchmark::Run("Copy<true>", ROW_LENGTH, "pixel", [&]()
+							{ RGB565Kernels::Copy<true>(source, destination, ROW_LENGTH); Benchmark::Use(destination); });
+	Benchmark::PrintSpeedup("Copy speedup", kernel, scalar);
+
+	return 0;
+}
@@ -0,0 +1,180 @@
+#include "Test.h"
+#include "RGB565Kernels.h"
+
+// The word-wide kernels against the one pixel at a time references of RGB565Kernels::Scalar,
+// at every alignment, with counts around the widths of the word loops
+
+static constexpr uint32 BUFFER_LENGTH = 64;
+static constexpr uint32 MAX_OFFSET = 4;
+static constexpr uint32 MAX_COUNT = 40;
+static constexpr uint8 ALPHAS[] = {0, 1, 3, 4, 5, 100, 127, 128, 200, 251, 252, 254, 255};
+
+static void FillRandom(uint16 *Buffer, uint32 Count)
+{
+	for (uint32 i = 0; i < Count; ++i)
+		Buffer[i] = static_cast<uint16>(rand());
+}
+
+static void FillRandom(uint8 *Buffer, uint32 Count)
+{
+	for (uint32 i = 0; i < Count; ++i)
+		Buffer[i] = static_cast<uint8>(rand());
+}
+
+// Everything around the kernel's range must stay untouched
+static void CheckEqual(const uint16 *Expected, const uint16 *Actual)
+{
+	for (uint32 i = 0; i < BUFFER_LENGTH; ++i)
+		CHECK_EQUAL(Expected[i], Actual[i]);
+}
+
+static void TestBlendPixel(void)
+{
+	for (uint32 alpha = 0; alpha < 256; ++alpha)
+		for (uint32 i = 0; i < 256; ++i)
+		{
+			const uint16 foreground = static_cast<uint16>(rand());
+			const uint16 background = static_cast<uint16>(rand());
+
+			CHECK_EQUAL(RGB565Kernels::Scalar::Blend(foreground, background, alpha), RGB565Kernels::BlendPixel(foreground, background, alpha));
+		}
+
+	// Opaque and transparent ends
+	CHECK_EQUAL(0xF81F, RGB565Kernels::BlendPixel(0xF81F, 0x07E0, 255));
+	CHECK_EQUAL(0x07E0, RGB565Kernels::BlendPixel(0xF81F, 0x07E0, 0));
+}
+
+static void TestFill(void)
+{
+	alignas(8) uint16 expected[BUFFER_LENGTH];
+	alignas(8) uint16 actual[BUFFER_LENGTH];
+
+	for (uint32 offset = 0; offset < MAX_OFFSET; ++offset)
+		for (uint32 count = 0; count <= MAX_COUNT; ++count)
+		{
+			FillRandom(expected, BUFFER_LENGTH);
+			Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+			RGB565Kernels::Scalar::Fill(expected + offset, 0x1234, count);
+			RGB565Kernels::Fill(actual + offset, 0x1234, count);
+
+			CheckEqual(expected, actual);
+		}
+}
+
+template <bool IsSwapped>
+static void TestBlend(void)
+{
+	alignas(8) uint16 expected[BUFFER_LENGTH];
+	alignas(8) uint16 actual[BUFFER_LENGTH];
+
+	for (uint8 alpha : ALPHAS)
+		for (uint32 offset = 0; offset < MAX_OFFSET; ++offset)
+			for (uint32 count = 0; count <= MAX_COUNT; count += 3)
+			{
+				FillRandom(expected, BUFFER_LENGTH);
+				Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+				const uint16 color = static_cast<uint16>(rand());
+
+				RGB565Kernels::Scalar::Blend<IsSwapped>(expected + offset, color, alpha, count);
+				RGB565Kernels::Blend<IsSwapped>(actual + offset, color, alpha, count);
+
+				CheckEqual(expected, actual);
+			}
+}
+
+template <bool IsSwapped>
+static void TestBlendAlphas(void)
+{
+	alignas(8) uint16 expected[BUFFER_LENGTH];
+	alignas(8) uint16 actual[BUFFER_LENGTH];
+	uint8 alphas[BUFFER_LENGTH];
+
+	for (uint8 alpha : ALPHAS)
+		for (uint32 offset = 0; offset < MAX_OFFSET; ++offset)
+		{
+			FillRandom(expected, BUFFER_LENGTH);
+			Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+			FillRandom(alphas, BUFFER_LENGTH);
+
+			// Both ends, which the kernel skips or writes directly
+			alphas[0] = 0;
+			alphas[1] = 255;
+
+			const uint16 color = static_cast<uint16>(rand());
+
+			RGB565Kernels::Scalar::BlendAlphas<IsSwapped>(expected + offset, alphas, color, alpha, MAX_COUNT);
+			RGB565Kernels::BlendAlphas<IsSwapped>(actual + offset, alphas, color, alpha, MAX_COUNT);
+
+			CheckEqual(expected, actual);
+		}
+}
+
+template <bool IsSwapped>
+static void TestCopy(void)
+{
+	alignas(8) uint16 source[BUFFER_LENGTH];
+	alignas(8) uint16 expected[BUFFER_LENGTH];
+	alignas(8) uint16 actual[BUFFER_LENGTH];
+
+	for (uint32 sourceOffset = 0; sourceOffset < MAX_OFFSET; ++sourceOffset)
+		for (uint32 offset = 0; offset < MAX_OFFSET; ++offset)
+			for (uint32 count = 0; count <= MAX_COUNT; ++count)
+			{
+				FillRandom(source, BUFFER_LENGTH);
+				FillRandom(expected, BUFFER_LENGTH);
+				Memory::Copy(expected, actual, BUFFER_LENGTH);
+
+				RGB565Kernels::Scalar::Copy<IsSwapped>(source + sourceOffset, expected + offset, count);
+				RGB565Kernels::Copy<IsSwapped>(source + sourceOffset, actual + offset, count);
+
+				CheckEqual(expected, actual);
+			}
+}
+
+static void TestExpand(void)
+{
+	uint16 palette[256];
+	FillRandom(palette, 256);
+
+	uint8 indices[BUFFER_LENGTH];
+	FillRandom(indices, BUFFER_LENGTH);
+
+	for (uint32 count = 0; count <= MAX_COUNT; ++count)
+	{
+		uint16 actual[BUFFER_LENGTH] = {};
+
+		RGB565Kernels::Expand(indices, palette, actual, count);
+
+		for (uint32 i = 0; i < BUFFER_LENGTH; ++i)
+			CHECK_EQUAL((i < count ? palette[indices[i]] : 0), actual[i]);
+	}
+}
+
+static void TestScaleAlpha(void)
+{
+	CHECK_EQUAL(200, RGB565Kernels::ScaleAlpha(200, 255));
+	CHECK_EQUAL(0, RGB565Kernels::ScaleAlpha(200, 0));
+	CHECK_EQUAL(100, RGB565Kernels::ScaleAlpha(255, 100));
+	CHECK_EQUAL(127, RGB565Kernels::ScaleAlpha(255, 127));
+}
+
+int main(void)
+{
+	srand(1);
+
+	RUN_TEST(TestBlendPixel);
+	RUN_TEST(TestFill);
+	RUN_TEST(TestBlend<false>);
+	RUN_TEST(TestBlend<true>);
+	RUN_TEST(TestBlendAlphas<false>);
+	RUN_TEST(TestBlendAlphas<true>);
+	RUN_TEST(TestCopy<false>);
+	RUN_TEST(TestCopy<true>);
+	RUN_TEST(TestExpand);
+	RUN_TEST(TestScaleAlpha);
+
+	return GetTestResult();
+}
@@ -0,0 +1,199 @@
+#pragma once
+#ifndef RECORDING_HAL_H
+#define RECORDING_HAL_H
+
+#include "I_LCD_HAL.h"
+#include "RGB565Kernels.h"
+#include "DSP/Math.h"
+#include <algorithm>
+#include <vector>
+
+// An in-memory screen which counts the writes of every pixel, for the overdraw and repaint checks
+// Pixels are native R5G6B5, translucent colors get blended like the frame buffer HALs do
+template <uint16 Width, uint16 Height>
+class RecordingHAL final : public I_LCD_HAL
+{
+public:
+	RecordingHAL(void)
+		: m_Dimension({Width, Height}),
+		  m_Pixels(Width * Height, 0),
+		  m_WriteCounts(Width * Height, 0),
+		  m_OutsideWriteCount(0),
+		  m_ColorCallCount(0),
+		  m_TargetFrameRate(60)
+	{
+	}
+
+	void Update(void) override
+	{
+	}
+
+	void SetTargetFrameRate(uint8 Value) override
+	{
+		m_TargetFrameRate = Value;
+	}
+
+	uint8 GetTargetFrameRate(void) const override
+	{
+		return m_TargetFrameRate;
+	}
+
+	void Clear(Color Color) override
+	{
+		DrawFilledRectangle({0, 0, Width, Height}, Color);
+	}
+
+	void DrawPixel(Point Position, Color Color) override
+	{
+		++m_ColorCallCount;
+
+		Write(Position.X, Position.Y, Color.R5G6B5(), Color.A);
+	}
+
+	void DrawHorizontalLine(Point Position, uint16 Length, Color Color) override
+	{
+		DrawFilledRectangle({Position.X, Position.Y, Length, 1}, Color);
+	}
+
+	void DrawVerticalLine(Point Position, uint16 Length, Color Color) override
+	{
+		DrawFilledRectangle({Position.X, Position.Y, 1, Length}, Color);
+	}
+
+	void DrawFilledRectangle(Rect Rect, Color Color) override
+	{
+		++m_ColorCallCount;
+
+		for (uint32 y = Rect.Position.Y; y < Rect.Position.Y + Rect.Dimension.Y; ++y)
+			for (uint32 x = Rect.Position.X; x < Rect.Position.X + Rect.Dimension.X; ++x)
+				Write(x, y, Color.R5G6B5(), Color.A);
+	}
+
+	// Pixels of a zero alpha aren't written
+	void BlendHorizontalLine(Point Position, const uint8 *Alphas, uint16 Length, Color Color) override
+	{
+		++m_ColorCallCount;
+
+		for (uint16 i = 0; i < Length; ++i)
+		{
+			const uint8 alpha = RGB565Kernels::ScaleAlpha(Alphas[i], Color.A);
+			if (alpha != 0)
+				Write(Position.X + i, Position.Y, Color.R5G6B5(), alpha);
+		}
+	}
+
+	void DrawPixels(const Point *Positions, uint16 Count, Color Color) override
+	{
+		++m_ColorCallCount;
+
+		for (uint16 i = 0; i < Count; ++i)
+			Write(Positions[i].X, Positions[i].Y, Color.R5G6B5(), Color.A);
+	}
+
+	void BlendPixels(const Point *Positions, const uint8 *Alphas, uint16 Count, Color Color) override
+	{
+		++m_ColorCallCount;
+
+		for (uint16 i = 0; i < Count; ++i)
+		{
+			const uint8 alpha = RGB565Kernels::ScaleAlpha(Alphas[i], Color.A);
+			if (alpha != 0)
+				Write(Positions[i].X, Positions[i].Y, Color.R5G6B5(), alpha);
+		}
+	}
+
+	void DrawRow(Point Position, const uint16 *R5G6B5, uint16 Length) override
+	{
+		for (uint16 i = 0; i < Length; ++i)
+			Write(Position.X + i, Position.Y, R5G6B5[i], 255);
+	}
+
+	const Point &GetDimension(void) const override
+	{
+		return m_Dimension;
+	}
+
+	uint16 GetPixel(uint16 X, uint16 Y) const
+	{
+		return m_Pixels[X + (Y * Width)];
+	}
+
+	uint32 GetWriteCount(uint16 X, uint16 Y) const
+	{
+		return m_WriteCounts[X + (Y * Width)];
+	}
+
+	// Pixels written at least once
+	uint32 GetWrittenPixelCount(void) const
+	{
+		uint32 count = 0;
+		for (uint32 value : m_WriteCounts)
+			count += (value != 0 ? 1 : 0);
+
+		return count;
+	}
+
+	uint32 GetTotalWriteCount(void) const
+	{
+		uint32 count = 0;
+		for (uint32 value : m_WriteCounts)
+			count += value;
+
+		return count;
+	}
+
+	uint32 GetMaxWriteCount(void) const
+	{
+		uint32 count = 0;
+		for (uint32 value : m_WriteCounts)
+			count = Math::Max(count, value);
+
+		return count;
+	}
+
+	// Writes which would have been outside of the screen, the canvas clips them all
+	uint32 GetOutsideWriteCount(void) const
+	{
+		return m_OutsideWriteCount;
+	}
+
+	// Calls taking a Color, every one of them converts it
+	uint32 GetColorCallCount(void) const
+	{
+		return m_ColorCallCount;
+	}
+
+	// Keeps the pixels, so the repaints of the next frame can be counted
+	void ResetWriteCounts(void)
+	{
+		std::fill(m_WriteCounts.begin(), m_WriteCounts.end(), 0);
+		m_OutsideWriteCount = 0;
+		m_ColorCallCount = 0;
+	}
+
+private:
+	void Write(uint32 X, uint32 Y, uint16 R5G6B5, uint8 Alpha)
+	{
+		if (X >= Width || Y >= Height)
+		{
+			++m_OutsideWriteCount;
+
+			return;
+		}
+
+		const uint32 index = X + (Y * Width);
+
+		m_Pixels[index] = (Alpha == 255 ? R5G6B5 : RGB565Kernels::BlendPixel(R5G6B5, m_Pixels[index], Alpha));
+		++m_WriteCounts[index];
+	}
+
+private:
+	Point m_Dimension;
+	std::vector<uint16> m_Pixels;
+	std::vector<uint32> m_WriteCounts;
+	uint32 m_OutsideWriteCount;
+	uint32 m_ColorCallCount;
+	uint8 m_TargetFrameRate;
+};
+
+#endif
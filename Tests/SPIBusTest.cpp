@@ -0,0 +1,301 @@
+#include "Test.h"
+#include "SPIBus.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+// Scheduling of SPIBus against the SpiHandle stand-in, every transfer sends one byte which tells it apart
+
+typedef daisy::SpiHandle::Result Result;
+typedef daisy::SpiHandle::Config::BaudPrescaler BaudPrescaler;
+typedef daisy::SpiHandle::Config::ClockPolarity ClockPolarity;
+typedef daisy::SpiHandle::Config::ClockPhase ClockPhase;
+
+static constexpr uint8 CHUNK_COUNT = 4;
+
+// A display like transmission, the completion of every chunk queues the next one
+struct Chain
+{
+public:
+	SPIBus *Bus;
+	uint8 Device;
+	uint8 Chunks[CHUNK_COUNT];
+	uint8 SentCount;
+	uint8 CompletedCount;
+	Result LastResult;
+};
+
+// A control rate transfer
+struct Single
+{
+public:
+	uint8 Data;
+	uint8 CompletedCount;
+};
+
+static std::vector<uint8> g_Transmitted;
+
+static void OnTransmit(const uint8_t *Data, size_t Size)
+{
+	g_Transmitted.push_back(Data[0]);
+}
+
+static void OnChunkCompleted(void *Context, Result Result)
+{
+	Chain &chain = *static_cast<Chain *>(Context);
+
+	++chain.CompletedCount;
+	chain.LastResult = Result;
+
+	if (chain.SentCount == CHUNK_COUNT)
+		return;
+
+	chain.Bus->Enqueue(chain.Device, &chain.Chunks[chain.SentCount++], 1, true, SPIBus::Priorities::Low, &OnChunkCompleted, &chain);
+}
+
+static void OnSingleCompleted(void *Context, Result Result)
+{
+	++static_cast<Single *>(Context)->CompletedCount;
+}
+
+static void StartChain(Chain &Chain, SPIBus &Bus, uint8 Device, uint8 FirstValue)
+{
+	Chain = {};
+	Chain.Bus = &Bus;
+	Chain.Device = Device;
+
+	for (uint8 i = 0; i < CHUNK_COUNT; ++i)
+		Chain.Chunks[i] = FirstValue + i;
+
+	Chain.SentCount = 1;
+	Bus.Enqueue(Device, &Chain.Chunks[0], 1, true, SPIBus::Priorities::Low, &OnChunkCompleted, &Chain);
+}
+
+static uint8 AddDevice(SPIBus &Bus, GPIOPins ChipSelect, BaudPrescaler BaudPrescaler, ClockPolarity ClockPolarity, ClockPhase ClockPhase)
+{
+	SPIBus::DeviceConfig config;
+	config.ChipSelect = ChipSelect;
+	config.HasDataCommand = false;
+	config.DataCommand = GPIOPins::Pin0;
+	config.BaudPrescaler = BaudPrescaler;
+	config.ClockPolarity = ClockPolarity;
+	config.ClockPhase = ClockPhase;
+
+	return Bus.AddDevice(config);
+}
+
+static void Setup(SPIBus &Bus)
+{
+	daisy::SpiHandle::Reset();
+	daisy::SpiHandle::OnTransmit = &OnTransmit;
+
+	g_Transmitted.clear();
+
+	Bus.Initialize(daisy::SpiHandle::Config::Peripheral::SPI_1, GPIOPins::Pin0, GPIOPins::Pin1, GPIOPins::Pin2);
+}
+
+static void CompleteAll(void)
+{
+	while (daisy::SpiHandle::Complete())
+		continue;
+}
+
+static void CheckTransmitted(const std::vector<uint8> &Expected)
+{
+	CHECK_EQUAL(Expected.size(), g_Transmitted.size());
+
+	for (uint32 i = 0; i < Expected.size() && i < g_Transmitted.size(); ++i)
+		CHECK_EQUAL(Expected[i], g_Transmitted[i]);
+}
+
+static void TestCompletionChaining(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 display = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_2, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+
+	Chain chain;
+	StartChain(chain, bus, display, 10);
+
+	CHECK(bus.IsBusy());
+
+	CompleteAll();
+
+	CheckTransmitted({10, 11, 12, 13});
+	CHECK_EQUAL(CHUNK_COUNT, chain.CompletedCount);
+	CHECK(chain.LastResult == Result::OK);
+	CHECK(!bus.IsBusy());
+}
+
+static void TestPriorityPreemption(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 display = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_2, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+	const uint8 dac = AddDevice(bus, GPIOPins::Pin4, BaudPrescaler::PS_16, ClockPolarity::HIGH, ClockPhase::TWO_EDGE);
+	const uint8 sensor = AddDevice(bus, GPIOPins::Pin5, BaudPrescaler::PS_8, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+
+	Chain chain;
+	StartChain(chain, bus, display, 10);
+
+	// Queued while the first chunk is running, in the reverse order of their priorities
+	Single normal = {30, 0};
+	Single high = {20, 0};
+	CHECK(bus.Enqueue(sensor, &normal.Data, 1, false, SPIBus::Priorities::Normal, &OnSingleCompleted, &normal));
+	CHECK(bus.Enqueue(dac, &high.Data, 1, false, SPIBus::Priorities::High, &OnSingleCompleted, &high));
+
+	// The next chunk gets queued by the completion of the first one, it waits for the others
+	CHECK(daisy::SpiHandle::Complete());
+	CheckTransmitted({10, 20});
+
+	// Queued while the second chunk is running, it gets in before the third one
+	Single late = {40, 0};
+	CHECK(daisy::SpiHandle::Complete());
+	CHECK(daisy::SpiHandle::Complete());
+	CheckTransmitted({10, 20, 30, 11});
+	CHECK(bus.Enqueue(dac, &late.Data, 1, false, SPIBus::Priorities::High, &OnSingleCompleted, &late));
+
+	CompleteAll();
+
+	CheckTransmitted({10, 20, 30, 11, 40, 12, 13});
+	CHECK_EQUAL(1, high.CompletedCount);
+	CHECK_EQUAL(1, normal.CompletedCount);
+	CHECK_EQUAL(1, late.CompletedCount);
+	CHECK_EQUAL(CHUNK_COUNT, chain.CompletedCount);
+	CHECK(!bus.IsBusy());
+}
+
+static void TestFullQueue(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 display = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_2, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+
+	uint8 data[SPIBus::QUEUE_CAPACITY + 2] = {};
+
+	// The first one starts right away and leaves the queue
+	for (uint8 i = 0; i < SPIBus::QUEUE_CAPACITY + 1; ++i)
+		CHECK(bus.Enqueue(display, &data[i], 1, true, SPIBus::Priorities::Low, nullptr, nullptr));
+
+	CHECK(!bus.Enqueue(display, &data[SPIBus::QUEUE_CAPACITY + 1], 1, true, SPIBus::Priorities::Low, nullptr, nullptr));
+
+	// Other priorities have their own queues
+	CHECK(bus.Enqueue(display, &data[0], 1, true, SPIBus::Priorities::High, nullptr, nullptr));
+
+	CompleteAll();
+
+	CHECK_EQUAL(SPIBus::QUEUE_CAPACITY + 2, g_Transmitted.size());
+	CHECK(!bus.IsBusy());
+}
+
+static void TestClockSettings(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 display = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_2, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+	const uint8 dac = AddDevice(bus, GPIOPins::Pin4, BaudPrescaler::PS_16, ClockPolarity::HIGH, ClockPhase::TWO_EDGE);
+
+	uint8 data = 0;
+
+	bus.Enqueue(dac, &data, 1, false, SPIBus::Priorities::High, nullptr, nullptr);
+
+	CHECK_EQUAL(static_cast<uint32>(BaudPrescaler::PS_16), (SPI1->CFG1 & SPI_CFG1_MBR) >> SPI_CFG1_MBR_Pos);
+	CHECK_EQUAL(SPI_CFG2_CPOL | SPI_CFG2_CPHA, SPI1->CFG2 & (SPI_CFG2_CPOL | SPI_CFG2_CPHA));
+
+	// Switched from the completion interrupt
+	bus.Enqueue(display, &data, 1, true, SPIBus::Priorities::Low, nullptr, nullptr);
+	CompleteAll();
+
+	CHECK_EQUAL(static_cast<uint32>(BaudPrescaler::PS_2), (SPI1->CFG1 & SPI_CFG1_MBR) >> SPI_CFG1_MBR_Pos);
+	CHECK_EQUAL(0, SPI1->CFG2 & (SPI_CFG2_CPOL | SPI_CFG2_CPHA));
+
+	// Only by Initialize
+	CHECK_EQUAL(1, daisy::SpiHandle::InitCount);
+}
+
+static void TestFailedTransfer(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 display = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_2, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+
+	Chain chain;
+	StartChain(chain, bus, display, 10);
+
+	CHECK(daisy::SpiHandle::Complete(Result::ERR));
+	CHECK(chain.LastResult == Result::ERR);
+
+	// The bus goes on with the next transfer
+	CompleteAll();
+
+	CheckTransmitted({10, 11, 12, 13});
+	CHECK(chain.LastResult == Result::OK);
+	CHECK(!bus.IsBusy());
+}
+
+static void TestReceive(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 touch = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_32, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+
+	uint8 command[2] = {0x90, 0x00};
+	uint8 reply[2] = {};
+
+	CHECK(bus.Enqueue(touch, command, reply, 2, false, SPIBus::Priorities::Normal, nullptr, nullptr));
+	CompleteAll();
+
+	CHECK_EQUAL(0x6F, reply[0]);
+	CHECK_EQUAL(0xFF, reply[1]);
+}
+
+// The main loop waits on a thread of its own, while this one completes the transfers like the DMA interrupt would
+static void TestBlockingTransmitAtTransferBoundary(void)
+{
+	SPIBus bus;
+	Setup(bus);
+
+	const uint8 display = AddDevice(bus, GPIOPins::Pin3, BaudPrescaler::PS_2, ClockPolarity::LOW, ClockPhase::ONE_EDGE);
+	const uint8 dac = AddDevice(bus, GPIOPins::Pin4, BaudPrescaler::PS_16, ClockPolarity::HIGH, ClockPhase::TWO_EDGE);
+
+	Chain chain;
+	StartChain(chain, bus, display, 10);
+
+	uint8 command = 50;
+	std::thread mainLoop([&]()
+						 { bus.BlockingTransmit(dac, &command, 1, false); });
+
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+	// The bus is handed over instead of going on with the queued chunk
+	CHECK(daisy::SpiHandle::Complete());
+
+	mainLoop.join();
+
+	CheckTransmitted({10, 50, 11});
+
+	CompleteAll();
+
+	CheckTransmitted({10, 50, 11, 12, 13});
+	CHECK_EQUAL(CHUNK_COUNT, chain.CompletedCount);
+	CHECK(!bus.IsBusy());
+}
+
+int main(void)
+{
+	RUN_TEST(TestCompletionChaining);
+	RUN_TEST(TestPriorityPreemption);
+	RUN_TEST(TestFullQueue);
+	RUN_TEST(TestClockSettings);
+	RUN_TEST(TestFailedTransfer);
+	RUN_TEST(TestReceive);
+	RUN_TEST(TestBlockingTransmitAtTransferBoundary);
+
+	return GetTestResult();
+}
@@ -0,0 +1,76 @@
+#pragma once
+#ifndef DSP_COMMON_H
+#define DSP_COMMON_H
+
+// Host stand-in of the DSP submodule, only what the framework uses
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+typedef int8_t int8;
+typedef uint8_t uint8;
+typedef int16_t int16;
+typedef uint16_t uint16;
+typedef int32_t int32;
+typedef uint32_t uint32;
+typedef int64_t int64;
+typedef uint64_t uint64;
+typedef const char *cstr;
+
+#define SWAP_ENDIAN_16BIT(Value) static_cast<uint16>((static_cast<uint16>(Value) >> 8) | (static_cast<uint16>(Value) << 8))
+
+inline uint16 GetStringLength(cstr Value)
+{
+	return static_cast<uint16>(strlen(Value));
+}
+
+struct Color
+{
+public:
+	Color(void)
+		: R(0),
+		  G(0),
+		  B(0),
+		  A(255)
+	{
+	}
+
+	Color(uint8 R, uint8 G, uint8 B, uint8 A = 255)
+		: R(R),
+		  G(G),
+		  B(B),
+		  A(A)
+	{
+	}
+
+	uint16 R5G6B5(void) const
+	{
+		return ((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3);
+	}
+
+public:
+	uint8 R;
+	uint8 G;
+	uint8 B;
+	uint8 A;
+};
+
+// Never freed, like the allocations of the firmware
+class Memory
+{
+public:
+	template <typename T>
+	static T *Allocate(uint32 Count, bool OnSDRAM = false)
+	{
+		return static_cast<T *>(malloc(sizeof(T) * Count));
+	}
+
+	template <typename T>
+	static void Copy(const T *Source, T *Destination, uint32 Count)
+	{
+		memcpy(Destination, Source, sizeof(T) * Count);
+	}
+};
+
+#endif
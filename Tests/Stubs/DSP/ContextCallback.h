@@ -0,0 +1,34 @@
+#pragma once
+#ifndef DSP_CONTEXT_CALLBACK_H
+#define DSP_CONTEXT_CALLBACK_H
+
+template <typename ReturnType, typename... ParametersType>
+class ContextCallback
+{
+public:
+	typedef ReturnType (*FunctionType)(void *Context, ParametersType...);
+
+public:
+	ContextCallback(void)
+		: m_Context(nullptr),
+		  m_Function(nullptr)
+	{
+	}
+
+	ContextCallback(void *Context, FunctionType Function)
+		: m_Context(Context),
+		  m_Function(Function)
+	{
+	}
+
+	ReturnType operator()(ParametersType... Parameters) const
+	{
+		return m_Function(m_Context, Parameters...);
+	}
+
+private:
+	void *m_Context;
+	FunctionType m_Function;
+};
+
+#endif
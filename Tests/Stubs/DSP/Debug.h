@@ -0,0 +1,17 @@
+#pragma once
+#ifndef DSP_DEBUG_H
+#define DSP_DEBUG_H
+
+#include "Common.h"
+
+// Failed assertions are counted instead of halting, so the tests can check for them
+inline uint32 g_FailedAssertionCount = 0;
+
+#define ASSERT(Condition, ...)          \
+	do                                  \
+	{                                   \
+		if (!(Condition))               \
+			++g_FailedAssertionCount;   \
+	} while (false)
+
+#endif
@@ -0,0 +1,18 @@
+#pragma once
+#ifndef DSP_IHAL_H
+#define DSP_IHAL_H
+
+#include "Common.h"
+
+// Delays return immediately, the tests drive the time through daisy::System
+class IHAL
+{
+public:
+	virtual ~IHAL(void) = default;
+
+	virtual void Delay(uint16 Milliseconds)
+	{
+	}
+};
+
+#endif
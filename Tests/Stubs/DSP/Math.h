@@ -0,0 +1,35 @@
+#pragma once
+#ifndef DSP_MATH_H
+#define DSP_MATH_H
+
+#include "Common.h"
+
+class Math
+{
+public:
+	template <typename T>
+	static T Min(T A, T B)
+	{
+		return (A < B ? A : B);
+	}
+
+	template <typename T>
+	static T Max(T A, T B)
+	{
+		return (A > B ? A : B);
+	}
+
+	template <typename T>
+	static T Absolute(T Value)
+	{
+		return (Value < 0 ? -Value : Value);
+	}
+
+	template <typename T>
+	static T Sign(T Value)
+	{
+		return (Value < 0 ? -1 : (Value > 0 ? 1 : 0));
+	}
+};
+
+#endif
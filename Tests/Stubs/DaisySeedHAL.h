@@ -0,0 +1,22 @@
+#pragma once
+#ifndef DAISY_SEED_HAL_H
+#define DAISY_SEED_HAL_H
+
+// Host stand-in of DaisySeedHAL.h, which needs the whole of libDaisy
+
+#include "Common.h"
+#include "DSP/IHAL.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+#include <daisy_seed.h>
+
+class DaisySeedHALBase
+{
+public:
+	static daisy::Pin GetPin(uint8 Pin)
+	{
+		return {0, Pin};
+	}
+};
+
+#endif
@@ -0,0 +1,353 @@
+#pragma once
+#ifndef DAISY_SEED_H
+#define DAISY_SEED_H
+
+// Host stand-in of the parts of libDaisy the framework uses
+// The DMA transfers of SpiHandle are recorded and left running, SpiHandle::Complete finishes them the way the DMA interrupt would
+
+#include <cstdint>
+#include <cstddef>
+#include <cstdlib>
+// Like libDaisy does, the framework takes std::swap from it
+#include <utility>
+
+namespace daisy
+{
+	struct Pin
+	{
+	public:
+		uint8_t port;
+		uint8_t pin;
+	};
+
+	class GPIO
+	{
+	public:
+		enum class Mode
+		{
+			INPUT = 0,
+			OUTPUT,
+			OPEN_DRAIN,
+			ANALOG
+		};
+
+		enum class Pull
+		{
+			NOPULL = 0,
+			PULLUP,
+			PULLDOWN
+		};
+
+		enum class Speed
+		{
+			LOW = 0,
+			MEDIUM,
+			HIGH,
+			VERY_HIGH
+		};
+
+		struct Config
+		{
+		public:
+			Pin pin;
+			Mode mode;
+			Pull pull;
+			Speed speed;
+		};
+
+	public:
+		GPIO(void)
+			: m_State(false)
+		{
+		}
+
+		void Init(const Config &Config)
+		{
+			m_State = false;
+		}
+
+		// Inputs read what was written last, so the tests drive them with Write
+		bool Read(void)
+		{
+			return m_State;
+		}
+
+		void Write(bool State)
+		{
+			m_State = State;
+		}
+
+	private:
+		bool m_State;
+	};
+
+	class SpiHandle
+	{
+	public:
+		enum class Result
+		{
+			OK = 0,
+			ERR
+		};
+
+		struct Config
+		{
+		public:
+			enum class Peripheral
+			{
+				SPI_1 = 0,
+				SPI_2,
+				SPI_3,
+				SPI_4,
+				SPI_5,
+				SPI_6
+			};
+
+			enum class Mode
+			{
+				MASTER = 0,
+				SLAVE
+			};
+
+			enum class Direction
+			{
+				TWO_LINES = 0,
+				TWO_LINES_TX_ONLY,
+				TWO_LINES_RX_ONLY,
+				ONE_LINE
+			};
+
+			enum class ClockPolarity
+			{
+				LOW = 0,
+				HIGH
+			};
+
+			enum class ClockPhase
+			{
+				ONE_EDGE = 0,
+				TWO_EDGE
+			};
+
+			enum class NSS
+			{
+				SOFT = 0,
+				HARD_INPUT,
+				HARD_OUTPUT
+			};
+
+			enum class BaudPrescaler
+			{
+				PS_2 = 0,
+				PS_4,
+				PS_8,
+				PS_16,
+				PS_32,
+				PS_64,
+				PS_128,
+				PS_256
+			};
+
+			struct PinConfig
+			{
+			public:
+				Pin sclk;
+				Pin miso;
+				Pin mosi;
+				Pin nss;
+			};
+
+		public:
+			PinConfig pin_config;
+			Peripheral periph;
+			Mode mode;
+			Direction direction;
+			unsigned long datasize;
+			ClockPolarity clock_polarity;
+			ClockPhase clock_phase;
+			NSS nss;
+			BaudPrescaler baud_prescaler;
+		};
+
+		typedef void (*StartCallbackFunctionPtr)(void *Context);
+		typedef void (*EndCallbackFunctionPtr)(void *Context, Result Result);
+
+		// Sees every byte sent, blocking or by the DMA
+		typedef void (*TransmitListener)(const uint8_t *Data, size_t Size);
+
+	public:
+		Result Init(const Config &Config)
+		{
+			++InitCount;
+
+			return Result::OK;
+		}
+
+		Result BlockingTransmit(uint8_t *Data, size_t Size, uint32_t Timeout = 100)
+		{
+			if (IsInInterrupt)
+				++InterruptBlockingCount;
+
+			Transmit(Data, Size);
+
+			return Result::OK;
+		}
+
+		Result DmaTransmit(uint8_t *Data, size_t Size, StartCallbackFunctionPtr StartCallback, EndCallbackFunctionPtr EndCallback, void *Context)
+		{
+			// The peripheral runs one transfer at a time
+			if (s_EndCallback != nullptr)
+				abort();
+
+			Transmit(Data, Size);
+
+			s_EndCallback = EndCallback;
+			s_Context = Context;
+
+			++DmaTransferCount;
+
+			return Result::OK;
+		}
+
+		// The received bytes are the transmitted ones inverted
+		Result DmaTransmitAndReceive(uint8_t *TransmitData, uint8_t *ReceiveData, size_t Size, StartCallbackFunctionPtr StartCallback, EndCallbackFunctionPtr EndCallback, void *Context)
+		{
+			for (size_t i = 0; i < Size; ++i)
+				ReceiveData[i] = ~TransmitData[i];
+
+			return DmaTransmit(TransmitData, Size, StartCallback, EndCallback, Context);
+		}
+
+		// Finishes the running DMA transfer in the interrupt context, false when none is running
+		static bool Complete(Result Result = Result::OK)
+		{
+			if (s_EndCallback == nullptr)
+				return false;
+
+			EndCallbackFunctionPtr callback = s_EndCallback;
+			s_EndCallback = nullptr;
+
+			IsInInterrupt = true;
+			callback(s_Context, Result);
+			IsInInterrupt = false;
+
+			return true;
+		}
+
+		static bool IsTransferRunning(void)
+		{
+			return (s_EndCallback != nullptr);
+		}
+
+		static void Reset(void)
+		{
+			s_EndCallback = nullptr;
+			s_Context = nullptr;
+
+			OnTransmit = nullptr;
+			InitCount = 0;
+			DmaTransferCount = 0;
+			InterruptBlockingCount = 0;
+		}
+
+	private:
+		static void Transmit(const uint8_t *Data, size_t Size)
+		{
+			if (OnTransmit != nullptr)
+				OnTransmit(Data, Size);
+		}
+
+	public:
+		static inline TransmitListener OnTransmit = nullptr;
+		static inline uint32_t InitCount = 0;
+		static inline uint32_t DmaTransferCount = 0;
+		static inline bool IsInInterrupt = false;
+		// Blocking transfers have no place in the DMA completion
+		static inline uint32_t InterruptBlockingCount = 0;
+
+	private:
+		static inline EndCallbackFunctionPtr s_EndCallback = nullptr;
+		static inline void *s_Context = nullptr;
+	};
+
+	class ScopedIrqBlocker
+	{
+	public:
+		ScopedIrqBlocker(void)
+		{
+			++Depth;
+		}
+
+		~ScopedIrqBlocker(void)
+		{
+			--Depth;
+		}
+
+	public:
+		static inline uint32_t Depth = 0;
+	};
+
+	class System
+	{
+	public:
+		// Every read moves the time TimeStep microseconds on, so frames get due without waiting
+		static uint32_t GetUs(void)
+		{
+			return (Time += TimeStep);
+		}
+
+		static uint32_t GetNow(void)
+		{
+			return GetUs() / 1000;
+		}
+
+		static uint32_t GetTick(void)
+		{
+			return Time * (GetTickFreq() / 1000000);
+		}
+
+		static uint32_t GetTickFreq(void)
+		{
+			return 200000000;
+		}
+
+		static void Delay(uint32_t Milliseconds)
+		{
+			Time += Milliseconds * 1000;
+		}
+
+	public:
+		static inline uint32_t Time = 0;
+		static inline uint32_t TimeStep = 1000;
+	};
+}
+
+inline void dsy_dma_clear_cache_for_buffer(uint8_t *Buffer, size_t Size)
+{
+}
+
+// The clock settings of the SPI peripherals, SPIBus writes them directly
+struct SPI_TypeDef
+{
+public:
+	volatile uint32_t CR1;
+	volatile uint32_t CR2;
+	volatile uint32_t CFG1;
+	volatile uint32_t CFG2;
+};
+
+inline SPI_TypeDef g_SPIRegisters[6] = {};
+
+#define SPI1 (&g_SPIRegisters[0])
+#define SPI2 (&g_SPIRegisters[1])
+#define SPI3 (&g_SPIRegisters[2])
+#define SPI4 (&g_SPIRegisters[3])
+#define SPI5 (&g_SPIRegisters[4])
+#define SPI6 (&g_SPIRegisters[5])
+
+#define SPI_CFG1_MBR_Pos (28U)
+#define SPI_CFG1_MBR (0x7UL << SPI_CFG1_MBR_Pos)
+#define SPI_CFG2_CPHA (0x1UL << 24U)
+#define SPI_CFG2_CPOL (0x1UL << 25U)
+
+#endif
@@ -0,0 +1,56 @@
+#pragma once
+#ifndef TEST_H
+#define TEST_H
+
+#include "Common.h"
+#include <cstdio>
+
+// Minimal checks of the host tests, a failed check gets printed and fails the test executable
+
+inline uint32 g_FailedCheckCount = 0;
+
+#define CHECK(Condition)                                                         \
+	do                                                                           \
+	{                                                                            \
+		if (!(Condition))                                                        \
+		{                                                                        \
+			++g_FailedCheckCount;                                                \
+			printf("%s:%i: CHECK(%s) failed\n", __FILE__, __LINE__, #Condition); \
+		}                                                                        \
+	} while (false)
+
+#define CHECK_EQUAL(Expected, Actual)                                                                                                                              \
+	do                                                                                                                                                             \
+	{                                                                                                                                                              \
+		const int64 checkExpected = static_cast<int64>(Expected);                                                                                                  \
+		const int64 checkActual = static_cast<int64>(Actual);                                                                                                      \
+		if (checkExpected != checkActual)                                                                                                                          \
+		{                                                                                                                                                          \
+			++g_FailedCheckCount;                                                                                                                                  \
+			printf("%s:%i: %s is %lli, expected %lli\n", __FILE__, __LINE__, #Actual, static_cast<long long>(checkActual), static_cast<long long>(checkExpected)); \
+		}                                                                                                                                                          \
+	} while (false)
+
+#define RUN_TEST(Function)         \
+	do                             \
+	{                              \
+		printf("%s\n", #Function); \
+		Function();                \
+	} while (false)
+
+// The exit code of the test executable
+inline int GetTestResult(void)
+{
+	if (g_FailedCheckCount != 0)
+	{
+		printf("%u checks failed\n", g_FailedCheckCount);
+
+		return 1;
+	}
+
+	printf("Passed\n");
+
+	return 0;
+}
+
+#endif
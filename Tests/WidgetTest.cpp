@@ -0,0 +1,222 @@
+#include "Test.h"
+#include "RecordingHAL.h"
+#include "Widget.h"
+
+// Repaints of the widgets on the recording screen, only the invalidated bounds get written
+
+typedef RecordingHAL<160, 120> ScreenType;
+typedef LCDCanvasT<ScreenType> CanvasType;
+typedef WidgetContainerT<ScreenType, 4> ContainerType;
+typedef MeterT<ScreenType> MeterType;
+typedef KnobT<ScreenType> KnobType;
+
+static const Color BLACK = {0, 0, 0, 255};
+static const Color GRAY = {64, 64, 64, 255};
+static const Color GREEN = {0, 255, 0, 255};
+
+static const Rect SCREEN_BOUNDS = {0, 0, 160, 120};
+static const Rect LEFT_METER_BOUNDS = {10, 10, 20, 100};
+static const Rect RIGHT_METER_BOUNDS = {40, 10, 20, 100};
+static const Rect KNOB_BOUNDS = {80, 20, 60, 60};
+// On top of the knob
+static const Rect OVERLAY_BOUNDS = {120, 60, 30, 40};
+
+// Every written pixel has to be inside of Bounds
+static uint32 CountWritesOutside(const ScreenType &Screen, const Rect &Bounds)
+{
+	uint32 count = 0;
+
+	for (uint16 y = 0; y < 120; ++y)
+		for (uint16 x = 0; x < 160; ++x)
+		{
+			const bool isInside = (x >= Bounds.Position.X && x < Bounds.Position.X + Bounds.Dimension.X &&
+								   y >= Bounds.Position.Y && y < Bounds.Position.Y + Bounds.Dimension.Y);
+
+			if (!isInside)
+				count += Screen.GetWriteCount(x, y);
+		}
+
+	return count;
+}
+
+static void CheckRegion(const Rect &Expected, const Rect &Actual)
+{
+	CHECK_EQUAL(Expected.Position.X, Actual.Position.X);
+	CHECK_EQUAL(Expected.Position.Y, Actual.Position.Y);
+	CHECK_EQUAL(Expected.Dimension.X, Actual.Dimension.X);
+	CHECK_EQUAL(Expected.Dimension.Y, Actual.Dimension.Y);
+}
+
+struct Scene
+{
+public:
+	Scene(void)
+		: Container(SCREEN_BOUNDS, BLACK),
+		  LeftMeter(LEFT_METER_BOUNDS, GREEN, GRAY),
+		  RightMeter(RIGHT_METER_BOUNDS, GREEN, GRAY),
+		  Knob(KNOB_BOUNDS, GREEN, GRAY, BLACK),
+		  Overlay(OVERLAY_BOUNDS, GREEN, GRAY, false)
+	{
+		Canvas.Initialize(&Screen);
+
+		Container.AddChild(&LeftMeter);
+		Container.AddChild(&RightMeter);
+		Container.AddChild(&Knob);
+		Container.AddChild(&Overlay);
+	}
+
+	// Returns the count of the repainted widgets, the write counts are of this frame only
+	uint16 Render(Rect &Region)
+	{
+		Screen.ResetWriteCounts();
+
+		Region = {};
+
+		return Container.Render(Canvas, Region);
+	}
+
+public:
+	ScreenType Screen;
+	CanvasType Canvas;
+	ContainerType Container;
+	MeterType LeftMeter;
+	MeterType RightMeter;
+	KnobType Knob;
+	MeterType Overlay;
+};
+
+static void TestFirstFramePaintsEverything(void)
+{
+	Scene scene;
+
+	Rect region;
+	CHECK_EQUAL(5, scene.Render(region));
+
+	CHECK_EQUAL(160 * 120, scene.Screen.GetWrittenPixelCount());
+	CHECK_EQUAL(0, scene.Screen.GetOutsideWriteCount());
+	CheckRegion(SCREEN_BOUNDS, region);
+}
+
+static void TestCleanFrameWritesNothing(void)
+{
+	Scene scene;
+
+	Rect region;
+	scene.Render(region);
+
+	CHECK_EQUAL(0, scene.Render(region));
+	CHECK_EQUAL(0, scene.Screen.GetTotalWriteCount());
+	CHECK_EQUAL(0, region.Dimension.X);
+
+	// The same value doesn't invalidate
+	scene.LeftMeter.SetValue(0);
+	CHECK_EQUAL(0, scene.Render(region));
+	CHECK_EQUAL(0, scene.Screen.GetTotalWriteCount());
+}
+
+static void TestMeterRepaintsItsBoundsOnce(void)
+{
+	Scene scene;
+
+	Rect region;
+	scene.Render(region);
+
+	scene.LeftMeter.SetValue(0.5F);
+
+	CHECK_EQUAL(1, scene.Render(region));
+
+	// Every pixel of the bounds, once
+	CHECK_EQUAL(20 * 100, scene.Screen.GetWrittenPixelCount());
+	CHECK_EQUAL(20 * 100, scene.Screen.GetTotalWriteCount());
+	CHECK_EQUAL(0, CountWritesOutside(scene.Screen, LEFT_METER_BOUNDS));
+	CheckRegion(LEFT_METER_BOUNDS, region);
+
+	// The lower half is filled
+	CHECK_EQUAL(GRAY.R5G6B5(), scene.Screen.GetPixel(15, 20));
+	CHECK_EQUAL(GREEN.R5G6B5(), scene.Screen.GetPixel(15, 100));
+
+	// Both meters, the region spans them
+	scene.LeftMeter.SetValue(1);
+	scene.RightMeter.SetValue(1);
+
+	CHECK_EQUAL(2, scene.Render(region));
+	CHECK_EQUAL(2 * 20 * 100, scene.Screen.GetTotalWriteCount());
+	CheckRegion({10, 10, 50, 100}, region);
+}
+
+static void TestKnobRepaintCoversTheOverlappingWidget(void)
+{
+	Scene scene;
+
+	Rect region;
+	scene.Render(region);
+
+	scene.Knob.SetValue(0.75F);
+
+	// The overlay is on top of the knob, it gets repainted over it
+	CHECK_EQUAL(2, scene.Render(region));
+
+	Rect bounds = {};
+	ContainerType::AddToRegion(bounds, KNOB_BOUNDS);
+	ContainerType::AddToRegion(bounds, OVERLAY_BOUNDS);
+
+	CHECK_EQUAL(0, CountWritesOutside(scene.Screen, bounds));
+	CHECK_EQUAL(0, scene.Screen.GetOutsideWriteCount());
+	CheckRegion(bounds, region);
+
+	// The overlay is the last one written
+	CHECK_EQUAL(GRAY.R5G6B5(), scene.Screen.GetPixel(125, 65));
+
+	// The overlay alone leaves the knob
+	scene.Overlay.SetValue(0.5F);
+
+	CHECK_EQUAL(1, scene.Render(region));
+	CHECK_EQUAL(30 * 40, scene.Screen.GetTotalWriteCount());
+	CHECK_EQUAL(0, CountWritesOutside(scene.Screen, OVERLAY_BOUNDS));
+}
+
+static void TestInvalidatedContainerRepaintsEverything(void)
+{
+	Scene scene;
+
+	Rect region;
+	scene.Render(region);
+
+	scene.Container.Invalidate();
+
+	CHECK_EQUAL(5, scene.Render(region));
+	CHECK_EQUAL(160 * 120, scene.Screen.GetWrittenPixelCount());
+	CheckRegion(SCREEN_BOUNDS, region);
+}
+
+// Like the passes of a band mode frame, with nothing invalidated in between
+static void TestRenderAllRepaintsEveryTime(void)
+{
+	Scene scene;
+
+	for (uint8 i = 0; i < 3; ++i)
+	{
+		scene.Screen.ResetWriteCounts();
+
+		Rect region = {};
+		CHECK_EQUAL(5, scene.Container.RenderAll(scene.Canvas, region));
+		CHECK_EQUAL(160 * 120, scene.Screen.GetWrittenPixelCount());
+		CheckRegion(SCREEN_BOUNDS, region);
+	}
+
+	// Left clean
+	Rect region;
+	CHECK_EQUAL(0, scene.Render(region));
+}
+
+int main(void)
+{
+	RUN_TEST(TestFirstFramePaintsEverything);
+	RUN_TEST(TestCleanFrameWritesNothing);
+	RUN_TEST(TestMeterRepaintsItsBoundsOnce);
+	RUN_TEST(TestKnobRepaintCoversTheOverlappingWidget);
+	RUN_TEST(TestInvalidatedContainerRepaintsEverything);
+	RUN_TEST(TestRenderAllRepaintsEveryTime);
+
+	return GetTestResult();
+}
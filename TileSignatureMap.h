@@ -0,0 +1,116 @@
+#pragma once
+#ifndef TILE_SIGNATURE_MAP_H
+#define TILE_SIGNATURE_MAP_H
+
+#include "Common.h"
+#include "CRC32.h"
+#include "DSP/Math.h"
+#include "DSP/Debug.h"
+
+// Remembers a CRC of every TileSize*TileSize tile of a Width*Height surface, as it was last transmitted,
+// so the tiles which got redrawn with the same pixels can be told apart from the changed ones
+// Tiles are unknown until their first update, so they always count as changed once
+template <uint32 Width, uint32 Height, uint8 TileSize>
+class TileSignatureMap
+{
+	static_assert(TileSize != 0, "TileSize must be greater than zero");
+
+	// Orientation may swap the axes, the product stays the same
+	static constexpr uint32 MAX_TILE_COUNT = ((Width + TileSize - 1) / TileSize) * ((Height + TileSize - 1) / TileSize);
+	static constexpr uint32 WORD_COUNT = (MAX_TILE_COUNT + 31) / 32;
+
+public:
+	TileSignatureMap(void)
+		: m_ColumnCount(0),
+		  m_Signatures{},
+		  m_KnownBits{}
+	{
+	}
+
+	void Initialize(Point Dimension)
+	{
+		ASSERT(Dimension.X * Dimension.Y == Width * Height, "Dimension doesn't match the surface");
+
+		m_Dimension = Dimension;
+		m_ColumnCount = (Dimension.X + TileSize - 1) / TileSize;
+
+		CRC32::Initialize();
+
+		Invalidate();
+	}
+
+	// For when the content of the panel isn't known anymore, like after a failed transmission
+	void Invalidate(void)
+	{
+		for (uint32 &word : m_KnownBits)
+			word = 0;
+	}
+
+	// Buffer is the whole surface, of 16-bit pixels or 8-bit palette indices
+	// Returns false if the tile holds the same pixels as the last time
+	template <typename PixelType>
+	bool Update(const PixelType *Buffer, uint16 Column, uint16 Row)
+	{
+		const uint32 signature = Compute(Buffer, Column, Row);
+
+		const uint32 index = Column + (Row * m_ColumnCount);
+		const uint32 mask = 1U << (index % 32);
+		uint32 &word = m_KnownBits[index / 32];
+
+		if ((word & mask) != 0 && m_Signatures[index] == signature)
+			return false;
+
+		m_Signatures[index] = signature;
+		word |= mask;
+
+		return true;
+	}
+
+private:
+	// Pixels go in packed into words, the last word of a row is padded
+	template <typename PixelType>
+	uint32 Compute(const PixelType *Buffer, uint16 Column, uint16 Row)
+	{
+		const uint16 x = Column * TileSize;
+		const uint16 y = Row * TileSize;
+		const uint16 width = Math::Min<uint32>(x + TileSize, m_Dimension.X) - x;
+		const uint16 height = Math::Min<uint32>(y + TileSize, m_Dimension.Y) - y;
+
+		m_CRC.Reset();
+
+		for (uint16 i = 0; i < height; ++i)
+		{
+			const PixelType *pixel = Buffer + x + ((y + i) * m_Dimension.X);
+
+			uint32 word = 0;
+			uint8 shift = 0;
+			for (uint16 j = 0; j < width; ++j)
+			{
+				word |= static_cast<uint32>(pixel[j]) << shift;
+
+				shift += sizeof(PixelType) * 8;
+				if (shift != 32)
+					continue;
+
+				m_CRC.Add(word);
+
+				word = 0;
+				shift = 0;
+			}
+
+			if (shift != 0)
+				m_CRC.Add(word);
+		}
+
+		return m_CRC.Get();
+	}
+
+private:
+	Point m_Dimension;
+	uint16 m_ColumnCount;
+	CRC32 m_CRC;
+	uint32 m_Signatures[MAX_TILE_COUNT];
+	uint32 m_KnownBits[WORD_COUNT];
+};
+
+#endif
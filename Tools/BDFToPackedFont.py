@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""Converts a BDF font into the PackedFont format of Common.h as constexpr data.
+
+Usage:
+    BDFToPackedFont.py Input.bdf NAME [--first 32] [--last 126] [--kerning Pairs.txt] [--output NAME.h]
+
+The kerning file is optional and holds one pair per line: "<Left> <Right> <Offset>", e.g. "A V -1".
+"""
+
+import argparse
+import sys
+
+
+class Glyph:
+    def __init__(self, Code, Advance, Rows, Width, OffsetX, OffsetY):
+        self.Code = Code
+        self.Advance = Advance
+        # Each row is a list of 0/1 of Width length, top row first
+        self.Rows = Rows
+        self.Width = Width
+        self.OffsetX = OffsetX
+        self.OffsetY = OffsetY
+
+
+def ParseBDF(Path):
+    ascent = None
+    descent = None
+    glyphs = {}
+
+    with open(Path, "r", encoding="latin-1") as file:
+        lines = iter(file.read().splitlines())
+
+    for line in lines:
+        parts = line.split()
+        if not parts:
+            continue
+
+        if parts[0] == "FONT_ASCENT":
+            ascent = int(parts[1])
+        elif parts[0] == "FONT_DESCENT":
+            descent = int(parts[1])
+        elif parts[0] == "STARTCHAR":
+            code = None
+            advance = 0
+            width = height = offsetX = offsetY = 0
+            rows = []
+
+            for line in lines:
+                parts = line.split()
+                if not parts:
+                    continue
+
+                if parts[0] == "ENCODING":
+                    code = int(parts[1])
+                elif parts[0] == "DWIDTH":
+                    advance = int(parts[1])
+                elif parts[0] == "BBX":
+                    width, height, offsetX, offsetY = (int(value) for value in parts[1:5])
+                elif parts[0] == "BITMAP":
+                    for _ in range(height):
+                        value = next(lines).strip()
+                        bits = int(value, 16) if value else 0
+                        bitCount = len(value) * 4
+                        rows.append([(bits >> (bitCount - 1 - x)) & 1 for x in range(width)])
+                elif parts[0] == "ENDCHAR":
+                    break
+
+            if code is not None and code >= 0:
+                glyphs[code] = (advance, rows, width, height, offsetX, offsetY)
+
+    if ascent is None or descent is None:
+        sys.exit("FONT_ASCENT/FONT_DESCENT are missing")
+
+    result = {}
+    for code, (advance, rows, width, height, offsetX, offsetY) in glyphs.items():
+        # BDF offsets the box bottom from the baseline, PackedFont offsets the box top from the line top
+        top = ascent - (height + offsetY)
+        result[code] = Trim(Glyph(code, advance, rows, width, offsetX, top))
+
+    return ascent + descent, result
+
+
+def Trim(Glyph):
+    rows = Glyph.Rows
+    filled = [y for y, row in enumerate(rows) if any(row)]
+
+    if not filled:
+        Glyph.Rows = []
+        Glyph.Width = 0
+        return Glyph
+
+    columns = [x for x in range(Glyph.Width) if any(row[x] for row in rows)]
+
+    first, last = filled[0], filled[-1]
+    left, right = columns[0], columns[-1]
+
+    Glyph.Rows = [row[left:right + 1] for row in rows[first:last + 1]]
+    Glyph.Width = right - left + 1
+    Glyph.OffsetX += left
+    Glyph.OffsetY += first
+
+    return Glyph
+
+
+def Pack(Glyphs, First, Last):
+    bitmap = []
+    entries = []
+
+    for code in range(First, Last + 1):
+        glyph = Glyphs.get(code)
+        if glyph is None:
+            entries.append((len(bitmap), 0, 0, 0, 0, 0, code))
+            continue
+
+        offset = len(bitmap)
+
+        bits = [bit for row in glyph.Rows for bit in row]
+        for i in range(0, len(bits), 8):
+            chunk = bits[i:i + 8] + [0] * (8 - len(bits[i:i + 8]))
+            bitmap.append(sum(bit << (7 - index) for index, bit in enumerate(chunk)))
+
+        entries.append((offset, glyph.Width, len(glyph.Rows), glyph.OffsetX, glyph.OffsetY, glyph.Advance, code))
+
+    if len(bitmap) > 0xFFFF:
+        sys.exit("Bitmap doesn't fit in uint16 offsets")
+
+    return bitmap, entries
+
+
+def ParseKerning(Path):
+    pairs = []
+
+    with open(Path, "r", encoding="utf-8") as file:
+        for line in file:
+            parts = line.split()
+            if len(parts) != 3:
+                continue
+
+            pairs.append((parts[0], parts[1], int(parts[2])))
+
+    return sorted(pairs, key=lambda pair: (ord(pair[0]), ord(pair[1])))
+
+
+def CharLiteral(Value):
+    if Value in ("'", "\\"):
+        return "'\\" + Value + "'"
+
+    return "'" + Value + "'"
+
+
+def Generate(Name, Height, First, Last, Bitmap, Entries, Kerning):
+    guard = Name.upper() + "_H"
+    output = []
+
+    output.append("#pragma once")
+    output.append("#ifndef " + guard)
+    output.append("#define " + guard)
+    output.append("")
+    output.append('#include "Common.h"')
+    output.append("")
+
+    output.append("static constexpr uint8 " + Name + "_BITMAP[] = {")
+    for i in range(0, len(Bitmap), 16):
+        output.append("\t" + ", ".join("0x%02X" % value for value in Bitmap[i:i + 16]) + ",")
+    output.append("};")
+    output.append("")
+
+    output.append("static constexpr PackedGlyph " + Name + "_GLYPHS[] = {")
+    for offset, width, height, offsetX, offsetY, advance, code in Entries:
+        output.append("\t{%d, %d, %d, %d, %d, %d}, // [%s]" % (offset, width, height, offsetX, offsetY, advance, chr(code)))
+    output.append("};")
+    output.append("")
+
+    kerning = "nullptr"
+    if Kerning:
+        kerning = Name + "_KERNING"
+
+        output.append("static constexpr KerningPair " + kerning + "[] = {")
+        for left, right, offset in Kerning:
+            output.append("\t{%s, %s, %d}," % (CharLiteral(left), CharLiteral(right), offset))
+        output.append("};")
+        output.append("")
+
+    output.append("static constexpr PackedFont Font_%s = {%d, %s, %s, %s_GLYPHS, %s_BITMAP, %s, %d, 1};" % (
+        Name, Height, CharLiteral(chr(First)), CharLiteral(chr(Last)), Name, Name, kerning, len(Kerning)))
+    output.append("")
+    output.append("#endif")
+
+    return "\n".join(output) + "\n"
+
+
+def Main():
+    parser = argparse.ArgumentParser(description="Converts a BDF font into PackedFont constexpr data")
+    parser.add_argument("Input")
+    parser.add_argument("Name")
+    parser.add_argument("--first", type=int, default=32)
+    parser.add_argument("--last", type=int, default=126)
+    parser.add_argument("--kerning")
+    parser.add_argument("--output")
+    arguments = parser.parse_args()
+
+    height, glyphs = ParseBDF(arguments.Input)
+    bitmap, entries = Pack(glyphs, arguments.first, arguments.last)
+    kerning = ParseKerning(arguments.kerning) if arguments.kerning else []
+
+    source = Generate(arguments.Name, height, arguments.first, arguments.last, bitmap, entries, kerning)
+
+    if arguments.output:
+        with open(arguments.output, "w", encoding="utf-8") as file:
+            file.write(source)
+    else:
+        sys.stdout.write(source)
+
+    sys.stderr.write("%s: %d bitmap bytes, %d glyphs, %d kerning pairs\n" % (arguments.Name, len(bitmap), len(entries), len(kerning)))
+
+
+if __name__ == "__main__":
+    Main()
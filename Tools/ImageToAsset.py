@@ -0,0 +1,218 @@
+#!/usr/bin/env python3
+"""Converts an image into the Image or Sprite format of Common.h as constexpr data.
+
+Usage:
+    ImageToAsset.py Input.png NAME [--format rle565|qoi|sprite] [--bpp 4] [--section .qspiflash_text] [--output NAME.h]
+
+Sprites get a palette of up to 1 << bpp colors, pixels with an alpha below 128 become the transparent index.
+The section is optional and places the data in that linker section, e.g. the memory-mapped QSPI flash.
+Requires Pillow.
+"""
+
+import argparse
+import sys
+
+from PIL import Image
+
+
+def ToR5G6B5(R, G, B):
+    return ((R >> 3) << 11) | ((G >> 2) << 5) | (B >> 3)
+
+
+def EncodeRLE565(Pixels):
+    values = [ToR5G6B5(r, g, b) for r, g, b, _ in Pixels]
+    data = []
+
+    i = 0
+    while i < len(values):
+        run = 1
+        while i + run < len(values) and run < 128 and values[i + run] == values[i]:
+            run += 1
+
+        if run > 1:
+            data.append(0x80 | (run - 1))
+            data += [values[i] & 0xFF, values[i] >> 8]
+            i += run
+            continue
+
+        # Literals stop where a run of at least 2 begins
+        count = 1
+        while i + count < len(values) and count < 128 and not (i + count + 1 < len(values) and values[i + count] == values[i + count + 1]):
+            count += 1
+
+        data.append(count - 1)
+        for value in values[i:i + count]:
+            data += [value & 0xFF, value >> 8]
+        i += count
+
+    return data
+
+
+def EncodeQOI(Width, Height, Pixels):
+    data = list(b"qoif") + list(Width.to_bytes(4, "big")) + list(Height.to_bytes(4, "big")) + [4, 0]
+
+    index = [(0, 0, 0, 0)] * 64
+    previous = (0, 0, 0, 255)
+    run = 0
+
+    for i, pixel in enumerate(Pixels):
+        if pixel == previous:
+            run += 1
+            if run == 62 or i == len(Pixels) - 1:
+                data.append(0xC0 | (run - 1))
+                run = 0
+            continue
+
+        if run > 0:
+            data.append(0xC0 | (run - 1))
+            run = 0
+
+        r, g, b, a = pixel
+        position = (r * 3 + g * 5 + b * 7 + a * 11) % 64
+
+        if index[position] == pixel:
+            data.append(position)
+        elif a == previous[3]:
+            dr = ((r - previous[0] + 128) & 0xFF) - 128
+            dg = ((g - previous[1] + 128) & 0xFF) - 128
+            db = ((b - previous[2] + 128) & 0xFF) - 128
+            drg = dr - dg
+            dbg = db - dg
+
+            if -2 <= dr <= 1 and -2 <= dg <= 1 and -2 <= db <= 1:
+                data.append(0x40 | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))
+            elif -32 <= dg <= 31 and -8 <= drg <= 7 and -8 <= dbg <= 7:
+                data += [0x80 | (dg + 32), ((drg + 8) << 4) | (dbg + 8)]
+            else:
+                data += [0xFE, r, g, b]
+        else:
+            data += [0xFF, r, g, b, a]
+
+        index[position] = pixel
+        previous = pixel
+
+    return data + [0] * 7 + [1]
+
+
+def EncodeSprite(Source, BitsPerPixel):
+    colorCount = 1 << BitsPerPixel
+    pixels = list(Source.getdata())
+
+    isTransparent = [a < 128 for _, _, _, a in pixels]
+    hasTransparency = any(isTransparent)
+
+    # The last index is kept for the transparency
+    quantized = Source.convert("RGB").quantize(colors=colorCount - (1 if hasTransparency else 0))
+    indices = list(quantized.getdata())
+
+    # Pillow may leave out the unused entries, the missing ones are black
+    palette = quantized.getpalette()
+    palette = palette + [0] * (colorCount * 3 - len(palette))
+
+    colors = [ToR5G6B5(*palette[i * 3:i * 3 + 3]) for i in range(colorCount)]
+
+    transparentIndex = 0xFFFF
+    if hasTransparency:
+        transparentIndex = colorCount - 1
+        indices = [transparentIndex if transparent else value for value, transparent in zip(indices, isTransparent)]
+
+    data = []
+    width = Source.width
+    for y in range(Source.height):
+        row = indices[y * width:(y + 1) * width]
+        bits = []
+        for value in row:
+            bits += [(value >> (BitsPerPixel - 1 - i)) & 1 for i in range(BitsPerPixel)]
+
+        for i in range(0, len(bits), 8):
+            chunk = bits[i:i + 8] + [0] * (8 - len(bits[i:i + 8]))
+            data.append(sum(bit << (7 - index) for index, bit in enumerate(chunk)))
+
+    return data, colors, transparentIndex
+
+
+def Attribute(Section):
+    if not Section:
+        return ""
+
+    return ' __attribute__((section("%s")))' % Section
+
+
+def Generate(Name, Lines):
+    guard = Name.upper() + "_H"
+    output = []
+
+    output.append("#pragma once")
+    output.append("#ifndef " + guard)
+    output.append("#define " + guard)
+    output.append("")
+    output.append('#include "Common.h"')
+    output.append("")
+    output += Lines
+    output.append("#endif")
+
+    return "\n".join(output) + "\n"
+
+
+def Array(Type, Name, Values, Format, Section):
+    output = ["static constexpr %s %s[]%s = {" % (Type, Name, Attribute(Section))]
+    for i in range(0, len(Values), 16):
+        output.append("\t" + ", ".join(Format % value for value in Values[i:i + 16]) + ",")
+    output.append("};")
+    output.append("")
+
+    return output
+
+
+def Main():
+    parser = argparse.ArgumentParser(description="Converts an image into Image or Sprite constexpr data")
+    parser.add_argument("Input")
+    parser.add_argument("Name")
+    parser.add_argument("--format", choices=["rle565", "qoi", "sprite"], default="rle565")
+    parser.add_argument("--bpp", type=int, choices=[1, 2, 4], default=4)
+    parser.add_argument("--section")
+    parser.add_argument("--output")
+    arguments = parser.parse_args()
+
+    source = Image.open(arguments.Input).convert("RGBA")
+    name = arguments.Name
+    width, height = source.size
+
+    if width > 0xFFFF or height > 0xFFFF:
+        sys.exit("Image doesn't fit in uint16 dimensions")
+
+    if arguments.format == "sprite":
+        data, colors, transparentIndex = EncodeSprite(source, arguments.bpp)
+
+        lines = Array("uint8", name + "_DATA", data, "0x%02X", arguments.section)
+        lines += Array("uint16", name + "_PALETTE", colors, "0x%04X", None)
+        lines.append("static constexpr Sprite Sprite_%s = {%d, %d, %d, %s_PALETTE, 0x%04X, %s_DATA};" % (
+            name, arguments.bpp, width, height, name, transparentIndex, name))
+    else:
+        pixels = list(source.getdata())
+
+        if arguments.format == "rle565":
+            data = EncodeRLE565(pixels)
+            formatName = "ImageFormats::RLE565"
+        else:
+            data = EncodeQOI(width, height, [tuple(pixel) for pixel in pixels])
+            formatName = "ImageFormats::QOI"
+
+        lines = Array("uint8", name + "_DATA", data, "0x%02X", arguments.section)
+        lines.append("static constexpr Image Image_%s = {%s, %d, %d, %s_DATA, %d};" % (name, formatName, width, height, name, len(data)))
+
+    lines.append("")
+
+    output = Generate(name, lines)
+
+    if arguments.output:
+        with open(arguments.output, "w", encoding="utf-8") as file:
+            file.write(output)
+    else:
+        sys.stdout.write(output)
+
+    sys.stderr.write("%s: %dx%d, %d bytes (%d raw R5G6B5)\n" % (name, width, height, len(data), width * height * 2))
+
+
+if __name__ == "__main__":
+    Main()
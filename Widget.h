@@ -0,0 +1,392 @@
+#pragma once
+#ifndef WIDGET_H
+#define WIDGET_H
+
+#include "LCDCanvas.h"
+
+// Retained mode widgets on top of LCDCanvasT, statically allocated
+// A widget paints every pixel of its bounds, so nothing has to be cleared under it, and it's only painted again after
+// being invalidated, clipped to its bounds; the HAL sees just those writes, so only them get transmitted
+template <typename HALType>
+class WidgetT
+{
+public:
+	typedef LCDCanvasT<HALType> CanvasType;
+
+public:
+	WidgetT(Rect Bounds)
+		: m_Bounds(Bounds),
+		  m_Value(0),
+		  m_IsDirty(true)
+	{
+	}
+
+	void Invalidate(void)
+	{
+		m_IsDirty = true;
+	}
+
+	bool IsDirty(void) const
+	{
+		return m_IsDirty;
+	}
+
+	const Rect &GetBounds(void) const
+	{
+		return m_Bounds;
+	}
+
+	void SetValue(float Value)
+	{
+		if (Value == m_Value)
+			return;
+
+		m_Value = Value;
+
+		Invalidate();
+	}
+
+	float GetValue(void) const
+	{
+		return m_Value;
+	}
+
+	// Paints the widget if it's dirty, adds the repainted bounds to Region and returns the count of the repainted widgets
+	virtual uint16 Render(CanvasType &Canvas, Rect &Region)
+	{
+		if (!m_IsDirty)
+			return 0;
+
+		Canvas.PushClipRect(m_Bounds);
+
+		Draw(Canvas);
+
+		Canvas.PopClipRect();
+
+		m_IsDirty = false;
+
+		AddToRegion(Region, m_Bounds);
+
+		return 1;
+	}
+
+	static bool DoesOverlap(const Rect &A, const Rect &B)
+	{
+		return (A.Position.X < B.Position.X + B.Dimension.X && B.Position.X < A.Position.X + A.Dimension.X &&
+				A.Position.Y < B.Position.Y + B.Dimension.Y && B.Position.Y < A.Position.Y + A.Dimension.Y);
+	}
+
+	// Region of zero dimension is empty
+	static void AddToRegion(Rect &Region, const Rect &Bounds)
+	{
+		if (Bounds.Dimension.X == 0 || Bounds.Dimension.Y == 0)
+			return;
+
+		if (Region.Dimension.X == 0 || Region.Dimension.Y == 0)
+		{
+			Region = Bounds;
+
+			return;
+		}
+
+		const int32 left = Math::Min(Region.Position.X, Bounds.Position.X);
+		const int32 top = Math::Min(Region.Position.Y, Bounds.Position.Y);
+		const int32 right = Math::Max(Region.Position.X + Region.Dimension.X, Bounds.Position.X + Bounds.Dimension.X);
+		const int32 bottom = Math::Max(Region.Position.Y + Region.Dimension.Y, Bounds.Position.Y + Bounds.Dimension.Y);
+
+		Region = {TO_UINT16(left), TO_UINT16(top), TO_UINT16(right - left), TO_UINT16(bottom - top)};
+	}
+
+protected:
+	virtual void Draw(CanvasType &Canvas) = 0;
+
+private:
+	Rect m_Bounds;
+	float m_Value;
+	bool m_IsDirty;
+};
+
+// Children are painted in the order they're added, so the later ones are on top
+template <typename HALType, uint8 MaxChildCount>
+class WidgetContainerT : public WidgetT<HALType>
+{
+public:
+	typedef WidgetT<HALType> WidgetType;
+	typedef typename WidgetType::CanvasType CanvasType;
+
+public:
+	WidgetContainerT(Rect Bounds, Color BackgroundColor)
+		: WidgetType(Bounds),
+		  m_BackgroundColor(BackgroundColor),
+		  m_ChildCount(0)
+	{
+	}
+
+	void AddChild(WidgetType *Child)
+	{
+		ASSERT(Child != nullptr, "Child cannot be null");
+		ASSERT(m_ChildCount < MaxChildCount, "Running out of child capacity");
+
+		m_Children[m_ChildCount++] = Child;
+
+		WidgetType::Invalidate();
+	}
+
+	// Call it once per frame, from the render event of the HAL
+	// Only for the modes keeping a frame buffer, FrameBufferModes::Band needs RenderAll
+	uint16 Render(CanvasType &Canvas, Rect &Region) override
+	{
+		uint16 count = 0;
+
+		// The background covers every child
+		if (WidgetType::IsDirty())
+		{
+			count += WidgetType::Render(Canvas, Region);
+
+			for (uint8 i = 0; i < m_ChildCount; ++i)
+				m_Children[i]->Invalidate();
+		}
+
+		// Repainting a child covers the ones on top of it
+		for (uint8 i = 0; i < m_ChildCount; ++i)
+		{
+			if (!m_Children[i]->IsDirty())
+				continue;
+
+			for (uint8 j = i + 1; j < m_ChildCount; ++j)
+				if (WidgetType::DoesOverlap(m_Children[i]->GetBounds(), m_Children[j]->GetBounds()))
+					m_Children[j]->Invalidate();
+		}
+
+		Canvas.PushClipRect(WidgetType::GetBounds());
+
+		for (uint8 i = 0; i < m_ChildCount; ++i)
+			count += m_Children[i]->Render(Canvas, Region);
+
+		Canvas.PopClipRect();
+
+		return count;
+	}
+
+	// Paints every widget, dirty or not, call it from the render event of the HAL in FrameBufferModes::Band
+	// Band mode records each frame from scratch, a band with only the dirty widgets would show the clear color around them,
+	// and a frame overflowing the display list raises the render event again for each of its passes
+	uint16 RenderAll(CanvasType &Canvas, Rect &Region)
+	{
+		WidgetType::Invalidate();
+
+		return Render(Canvas, Region);
+	}
+
+protected:
+	void Draw(CanvasType &Canvas) override
+	{
+		Canvas.DrawFilledRectangle(WidgetType::GetBounds(), m_BackgroundColor);
+	}
+
+private:
+	Color m_BackgroundColor;
+	WidgetType *m_Children[MaxChildCount];
+	uint8 m_ChildCount;
+};
+
+// A bar showing a value of [0, 1], filling from the left or from the bottom
+template <typename HALType>
+class MeterT : public WidgetT<HALType>
+{
+public:
+	typedef WidgetT<HALType> WidgetType;
+	typedef typename WidgetType::CanvasType CanvasType;
+
+public:
+	MeterT(Rect Bounds, Color ForegroundColor, Color BackgroundColor, bool IsVertical = true)
+		: WidgetType(Bounds),
+		  m_ForegroundColor(ForegroundColor),
+		  m_BackgroundColor(BackgroundColor),
+		  m_IsVertical(IsVertical)
+	{
+	}
+
+protected:
+	void Draw(CanvasType &Canvas) override
+	{
+		const Rect &bounds = WidgetType::GetBounds();
+		const float value = Math::Max(0.0F, Math::Min(WidgetType::GetValue(), 1.0F));
+
+		if (m_IsVertical)
+		{
+			const uint16 height = bounds.Dimension.Y * value;
+			const uint16 emptyHeight = bounds.Dimension.Y - height;
+
+			Canvas.DrawFilledRectangle(bounds.Position.X, bounds.Position.Y, bounds.Dimension.X, emptyHeight, m_BackgroundColor);
+			Canvas.DrawFilledRectangle(bounds.Position.X, bounds.Position.Y + emptyHeight, bounds.Dimension.X, height, m_ForegroundColor);
+		}
+		else
+		{
+			const uint16 width = bounds.Dimension.X * value;
+
+			Canvas.DrawFilledRectangle(bounds.Position.X, bounds.Position.Y, width, bounds.Dimension.Y, m_ForegroundColor);
+			Canvas.DrawFilledRectangle(bounds.Position.X + width, bounds.Position.Y, bounds.Dimension.X - width, bounds.Dimension.Y, m_BackgroundColor);
+		}
+	}
+
+private:
+	Color m_ForegroundColor;
+	Color m_BackgroundColor;
+	bool m_IsVertical;
+};
+
+// A rotary knob showing a value of [0, 1] as an arc and a needle, 270 degrees from the bottom left to the bottom right
+template <typename HALType>
+class KnobT : public WidgetT<HALType>
+{
+public:
+	typedef WidgetT<HALType> WidgetType;
+	typedef typename WidgetType::CanvasType CanvasType;
+
+private:
+	static constexpr uint16 START_ANGLE = FixedTrigonometry::FromDegrees(135);
+	static constexpr uint16 SWEEP = FixedTrigonometry::FromDegrees(270);
+
+public:
+	KnobT(Rect Bounds, Color ForegroundColor, Color TrackColor, Color BackgroundColor, uint8 Thickness = 3)
+		: WidgetType(Bounds),
+		  m_ForegroundColor(ForegroundColor),
+		  m_TrackColor(TrackColor),
+		  m_BackgroundColor(BackgroundColor),
+		  m_Thickness(Thickness)
+	{
+	}
+
+protected:
+	void Draw(CanvasType &Canvas) override
+	{
+		const Rect &bounds = WidgetType::GetBounds();
+
+		Canvas.DrawFilledRectangle(bounds, m_BackgroundColor);
+
+		const int16 centerX = bounds.Position.X + (bounds.Dimension.X / 2);
+		const int16 centerY = bounds.Position.Y + (bounds.Dimension.Y / 2);
+		const int16 radius = (Math::Min(bounds.Dimension.X, bounds.Dimension.Y) / 2) - (m_Thickness / 2);
+		if (radius <= m_Thickness)
+			return;
+
+		const float value = Math::Max(0.0F, Math::Min(WidgetType::GetValue(), 1.0F));
+		const uint16 angle = START_ANGLE + static_cast<uint16>(SWEEP * value);
+
+		Canvas.DrawArc(centerX, centerY, radius, START_ANGLE, static_cast<uint16>(START_ANGLE + SWEEP), m_TrackColor, m_Thickness);
+		Canvas.DrawArc(centerX, centerY, radius, START_ANGLE, angle, m_ForegroundColor, m_Thickness);
+		Canvas.DrawNeedle(centerX, centerY, angle, 0, radius - m_Thickness, m_ForegroundColor, 2);
+	}
+
+private:
+	Color m_ForegroundColor;
+	Color m_TrackColor;
+	Color m_BackgroundColor;
+	uint8 m_Thickness;
+};
+
+// Text isn't copied, after changing the content of the same buffer, the label has to be invalidated
+template <typename HALType>
+class LabelT : public WidgetT<HALType>
+{
+public:
+	typedef WidgetT<HALType> WidgetType;
+	typedef typename WidgetType::CanvasType CanvasType;
+
+public:
+	LabelT(Rect Bounds, const Font &Font, Color ForegroundColor, Color BackgroundColor)
+		: WidgetType(Bounds),
+		  m_Font(Font),
+		  m_ForegroundColor(ForegroundColor),
+		  m_BackgroundColor(BackgroundColor),
+		  m_Text(nullptr)
+	{
+	}
+
+	void SetText(cstr Text)
+	{
+		m_Text = Text;
+
+		WidgetType::Invalidate();
+	}
+
+protected:
+	void Draw(CanvasType &Canvas) override
+	{
+		const Rect &bounds = WidgetType::GetBounds();
+
+		Canvas.DrawFilledRectangle(bounds, m_BackgroundColor);
+
+		if (m_Text != nullptr)
+			Canvas.DrawString(bounds.Position.X, bounds.Position.Y, m_Text, m_Font, m_ForegroundColor);
+	}
+
+private:
+	const Font &m_Font;
+	Color m_ForegroundColor;
+	Color m_BackgroundColor;
+	cstr m_Text;
+};
+
+// The latest SampleCount samples of [-1, 1] across the width, oldest on the left
+template <typename HALType, uint16 SampleCount>
+class ScopeT : public WidgetT<HALType>
+{
+	static_assert(SampleCount > 1, "A scope needs two samples at least");
+
+public:
+	typedef WidgetT<HALType> WidgetType;
+	typedef typename WidgetType::CanvasType CanvasType;
+
+public:
+	ScopeT(Rect Bounds, Color ForegroundColor, Color BackgroundColor)
+		: WidgetType(Bounds),
+		  m_ForegroundColor(ForegroundColor),
+		  m_BackgroundColor(BackgroundColor),
+		  m_Samples(),
+		  m_NextSample(0)
+	{
+	}
+
+	void AddSample(float Value)
+	{
+		m_Samples[m_NextSample] = Value;
+		m_NextSample = (m_NextSample + 1) % SampleCount;
+
+		WidgetType::Invalidate();
+	}
+
+protected:
+	void Draw(CanvasType &Canvas) override
+	{
+		const Rect &bounds = WidgetType::GetBounds();
+
+		Canvas.DrawFilledRectangle(bounds, m_BackgroundColor);
+
+		int16 previousX = 0;
+		int16 previousY = 0;
+
+		for (uint16 i = 0; i < SampleCount; ++i)
+		{
+			const float value = Math::Max(-1.0F, Math::Min(m_Samples[(m_NextSample + i) % SampleCount], 1.0F));
+
+			const int16 x = bounds.Position.X + ((i * (bounds.Dimension.X - 1)) / (SampleCount - 1));
+			const int16 y = bounds.Position.Y + ((bounds.Dimension.Y - 1) * (1 - value) * 0.5F);
+
+			if (i != 0)
+				Canvas.DrawLine(previousX, previousY, x, y, m_ForegroundColor);
+
+			previousX = x;
+			previousY = y;
+		}
+	}
+
+private:
+	Color m_ForegroundColor;
+	Color m_BackgroundColor;
+	float m_Samples[SampleCount];
+	uint16 m_NextSample;
+};
+
+#endif